@@ -0,0 +1,430 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//Ӧϸ
+#define COARSE_BLOCK              (16)     //ֵһÿôزһ,WIDTHHEIGHTı
+#define LUMINANCE_THRESHOLD       (0.1f)   //ĸ(ص[0,1])ֵϸ
+#define GRID_WIDTH                (WIDTH + 1)  //ضһһ,ұߺĿҲн
+#define GRID_HEIGHT               (HEIGHT + 1)
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+byte image[WIDTH * HEIGHT * RGB];
+
+//(x, y)(x, y)λ,computedЩ׷ٹ,
+//leafûϸֵĿĴС,ӵ[x0, x0 + s) * [y0, y0 + s)ĵ,ֵʱĸ
+Color samples[GRID_WIDTH * GRID_HEIGHT];
+byte computed[GRID_WIDTH * GRID_HEIGHT];
+byte needed[GRID_WIDTH * GRID_HEIGHT];
+byte leaf[GRID_WIDTH * GRID_HEIGHT];
+
+int activeBlocks[2][WIDTH * HEIGHT * 2];  //ÿҪжϵĿϽ,
+Color reference[WIDTH * HEIGHT];
+
+TraceResult Scene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+int RenderAdaptive(float threshold);
+
+void RenderFull(Color* out, unsigned int seedOffset);
+
+void ToImage(const Color* colors, int stride);
+
+double Rmse(const Color* a, int strideA, const Color* b, int strideB);
+
+int main(int argc, char* argv[])
+{
+	//AdaptiveMain [-threshold Ȳ] [-compare] : -compareȾһ,Ƚʱ
+	float threshold = LUMINANCE_THRESHOLD;
+	int compare = 0;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-threshold") == 0 && i + 1 < argc)
+		{
+			threshold = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-compare") == 0)
+		{
+			compare = 1;
+		}
+	}
+
+	double start = Now();
+	int traced = RenderAdaptive(threshold);
+	double adaptive = Now() - start;
+	printf("adaptive: traced %d of %d pixels (%.1f%%) in %.2fs\n", traced, WIDTH * HEIGHT, 100.0 * traced / (WIDTH * HEIGHT), adaptive);
+
+	if (compare)
+	{
+		//һȾһ,Ⱦ֮ĲĴС
+		static Color other[WIDTH * HEIGHT];
+		start = Now();
+		RenderFull(reference, 0u);
+		double full = Now() - start;
+		RenderFull(other, 0x9e3779b9u);
+		printf("full: %.2fs, speedup %.2fx\n", full, full / adaptive);
+		printf("rmse adaptive vs full %.4f, full vs full with other seeds %.4f\n",
+			Rmse(samples, GRID_WIDTH, reference, WIDTH), Rmse(other, WIDTH, reference, WIDTH));
+	}
+
+	//׷ٹĵðɫ
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			byte v = computed[y * GRID_WIDTH + x] ? 255 : 0;
+			memset(&image[(y * WIDTH + x) * RGB], v, RGB);
+		}
+	}
+	FILE* fp = fopen("..//..//png//adaptive_samples.png", "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+
+	ToImage(samples, GRID_WIDTH);
+	fp = fopen("..//..//png//adaptive.png", "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+	printf("Svnpng Success\n");
+	return 0;
+}
+
+float Saturate(float v)
+{
+	return fminf(fmaxf(v, 0.0f), 1.0f);
+}
+
+float Luminance(Color c)
+{
+	//дͼƬֵ,ص[0,1]
+	return 0.2126f * Saturate(c.r) + 0.7152f * Saturate(c.g) + 0.0722f * Saturate(c.b);
+}
+
+int NeedRefine(int x0, int y0, int s, float threshold)
+{
+	//ĸǵȲ̫,Ӱ߽硢ɢ֮ı仯
+	float l[4] =
+	{
+		Luminance(samples[y0 * GRID_WIDTH + x0]), Luminance(samples[y0 * GRID_WIDTH + x0 + s]),
+		Luminance(samples[(y0 + s) * GRID_WIDTH + x0]), Luminance(samples[(y0 + s) * GRID_WIDTH + x0 + s])
+	};
+	float lo = fminf(fminf(l[0], l[1]), fminf(l[2], l[3])), hi = fmaxf(fmaxf(l[0], l[1]), fmaxf(l[2], l[3]));
+	if (hi - lo > threshold)
+	{
+		return 1;
+	}
+
+	//ĵı治Խ,״ı߾,ĸǿһû;
+	//sdfȷʱԼsdfݶȵĳ
+	float cx = (x0 + s * 0.5f) / WIDTH, cy = (y0 + s * 0.5f) / HEIGHT;
+	float nx, ny;
+	Gradient(cx, cy, &nx, &ny);
+	float halfDiagonal = s * 0.70710678f / WIDTH;
+	return fabsf(Scene(cx, cy).sdf) < halfDiagonal * fmaxf(sqrtf(nx * nx + ny * ny), 1.0f);
+}
+
+void SetLeaf(int x0, int y0, int s)
+{
+	for (int y = y0; y < y0 + s; ++y)
+	{
+		memset(&leaf[y * GRID_WIDTH + x0], s, s);
+	}
+}
+
+void TraceNeeded(int step)
+{
+	//ֻstepĵ,ֻû׷ٹĲ׷;в,һֻᱻһ߳д
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < GRID_HEIGHT; y += step)
+	{
+		for (int x = 0; x < GRID_WIDTH; x += step)
+		{
+			int i = y * GRID_WIDTH + x;
+			if (needed[i] && !computed[i])
+			{
+				unsigned int s = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+				samples[i] = Sample((float)x / WIDTH, (float)y / HEIGHT, &s);
+				computed[i] = 1;
+			}
+		}
+	}
+}
+
+int RenderAdaptive(float threshold)
+{
+	memset(computed, 0, sizeof(computed));
+	memset(needed, 0, sizeof(needed));
+	memset(leaf, 0, sizeof(leaf));
+
+	//ֵһ:ÿCOARSE_BLOCKһ
+	for (int y = 0; y < GRID_HEIGHT; y += COARSE_BLOCK)
+	{
+		for (int x = 0; x < GRID_WIDTH; x += COARSE_BLOCK)
+		{
+			needed[y * GRID_WIDTH + x] = 1;
+		}
+	}
+	TraceNeeded(COARSE_BLOCK);
+
+	int count = 0;
+	int* active = activeBlocks[0];
+	for (int y = 0; y < HEIGHT; y += COARSE_BLOCK)
+	{
+		for (int x = 0; x < WIDTH; x += COARSE_BLOCK)
+		{
+			active[2 * count] = x;
+			active[2 * count + 1] = y;
+			++count;
+		}
+	}
+
+	//ÿһ:жЩҪϸ,ϸֵĿ´СŲֵ;ҪϸֵĿǱߵе,ͳһ׷
+	for (int s = COARSE_BLOCK, level = 0; s > 1; s /= 2, ++level)
+	{
+		int h = s / 2, next = 0;
+		int* refine = activeBlocks[(level + 1) & 1];
+		static byte decision[(WIDTH / 2) * (HEIGHT / 2)];
+#pragma omp parallel for schedule(dynamic)
+		for (int k = 0; k < count; ++k)
+		{
+			decision[k] = (byte)NeedRefine(active[2 * k], active[2 * k + 1], s, threshold);
+		}
+		for (int k = 0; k < count; ++k)
+		{
+			int x0 = active[2 * k], y0 = active[2 * k + 1];
+			if (!decision[k])
+			{
+				SetLeaf(x0, y0, s);
+				continue;
+			}
+			needed[y0 * GRID_WIDTH + x0 + h] = 1;
+			needed[(y0 + h) * GRID_WIDTH + x0] = 1;
+			needed[(y0 + h) * GRID_WIDTH + x0 + h] = 1;
+			needed[(y0 + h) * GRID_WIDTH + x0 + s] = 1;
+			needed[(y0 + s) * GRID_WIDTH + x0 + h] = 1;
+			for (int c = 0; c < 4; ++c)
+			{
+				refine[2 * next] = x0 + (c & 1) * h;
+				refine[2 * next + 1] = y0 + (c >> 1) * h;
+				++next;
+			}
+		}
+		TraceNeeded(h);
+		active = refine;
+		count = next;
+	}
+
+	//ʣµĿС1,е㶼׷ٹ;û׷ٵĵĿ˫Բֵ
+	int traced = 0;
+#pragma omp parallel for reduction(+ : traced)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			int i = y * GRID_WIDTH + x;
+			if (computed[i])
+			{
+				++traced;
+				continue;
+			}
+			int s = leaf[i];
+			int x0 = x - x % s, y0 = y - y % s;
+			float u = (float)(x - x0) / s, v = (float)(y - y0) / s;
+			const Color* c = &samples[y0 * GRID_WIDTH + x0];
+			Color top = ColorAdd(ColorScale(c[0], 1.0f - u), ColorScale(c[s], u));
+			Color bottom = ColorAdd(ColorScale(c[s * GRID_WIDTH], 1.0f - u), ColorScale(c[s * GRID_WIDTH + s], u));
+			samples[i] = ColorAdd(ColorScale(top, 1.0f - v), ColorScale(bottom, v));
+		}
+	}
+	return traced;
+}
+
+void RenderFull(Color* out, unsigned int seedOffset)
+{
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			unsigned int s = ((unsigned int)(y * WIDTH + x) * 9781u + 1u) ^ seedOffset;
+			out[y * WIDTH + x] = Sample((float)x / WIDTH, (float)y / HEIGHT, &s);
+		}
+	}
+}
+
+void ToImage(const Color* colors, int stride)
+{
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			Color c = colors[y * stride + x];
+			byte* p = &image[(y * WIDTH + x) * RGB];
+			p[0] = (int)(fminf(c.r * 255.0f, 255.0f));
+			p[1] = (int)(fminf(c.g * 255.0f, 255.0f));
+			p[2] = (int)(fminf(c.b * 255.0f, 255.0f));
+		}
+	}
+}
+
+double Rmse(const Color* a, int strideA, const Color* b, int strideB)
+{
+	//ص[0,1]ٱ
+	double sum = 0.0;
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			Color p = a[y * strideA + x], q = b[y * strideB + x];
+			double dr = Saturate(p.r) - Saturate(q.r);
+			double dg = Saturate(p.g) - Saturate(q.g);
+			double db = Saturate(p.b) - Saturate(q.b);
+			sum += dr * dr + dg * dg + db * db;
+		}
+	}
+	return sqrt(sum / (3.0 * WIDTH * HEIGHT));
+}
+
+TraceResult Scene(float x, float y)
+{
+	TraceResult light = { CircleSDF(x, y, 0.2f, 0.2f, 0.08f), 0.0f, 0.0f, { 6.0f, 5.0f, 4.0f }, COLOR_BLACK };
+	TraceResult prism = { NgonSDF(x, y, 0.62f, 0.62f, 0.12f, 3.0f), 0.0f, 1.5f, COLOR_BLACK, { 1.0f, 3.0f, 4.0f } };
+	TraceResult pillar = { CapsuleSDF(x, y, 0.12f, 0.6f, 0.3f, 0.72f, 0.02f), 0.0f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+	TraceResult mirror = { BoxSDF(x, y, 0.85f, 0.3f, 0.5f, 0.1f, 0.01f), 0.9f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+	return Union(Union(light, prism), Union(pillar, mirror));
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / LIGHT_COUNT);
+}
+
+#include "sdf.inc"
+#include "trace.inc"
+//
+//
+////DOC:
+////Ӧϸ
+//ڲƽĽռͼĴ󲿷,Щطÿض׷LIGHT_COUNTߺ˷
+//1.ÿCOARSE_BLOCK׷һ,õֵһ;ضһһ,ұߺĿҲн
+//2.ÿһжÿҪҪϸ:ĸǵȲֵ(Ӱ߽硢ɢ),߿ĵľ
+//  (sdfGradientĳ)СڰԽ,˵״ı߾,ĸǿܶû
+//3.ҪϸֵĿǱߵе,ͳһ׷,ڵĿ鹲õĵֻ׷һ;ֵ1Ϊֹ
+//4.ϸֵĿ´С,û׷ٹĿĸ˫Բֵ
+//5.׷ٵغȾͬ,ȫһ;-compareȾ(),
+//  ӡٱȡȾ,ԼȾ֮(ĴС)
+//adaptive_samples.pngɫ׷ٹ
@@ -0,0 +1,566 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//
+#define FRAME_COUNT               (60)
+#define FRAME_TIME                (1.0f / 30.0f)
+
+//ʱò
+#define TILE_SIZE                 (32)
+#define TILE_X                    (WIDTH / TILE_SIZE)
+#define TILE_Y                    (HEIGHT / TILE_SIZE)
+#define TEMPORAL_SAMPLE           (16)     //ʷÿֻ֡ô
+#define TEMPORAL_ALPHA            (0.25f)  //ڶʱĻȨ,ԽСԽƽ,ӰҲԽ
+#define HISTORY_REJECT            (1.0f)   //¾Ͷʷ
+
+//̬ͼԪSDF񻺴
+#define SDF_GRID_SIZE             (256)
+#define SDF_GRID_MIN              (-0.5f)
+#define SDF_GRID_MAX              (1.5f)
+#define SDF_GRID_CELL             ((SDF_GRID_MAX - SDF_GRID_MIN) / (SDF_GRID_SIZE - 1))
+#define SDF_GRID_ERROR            (SDF_GRID_CELL * 1.41421356f) //˫Բֵ
+#define SDF_GRID_TRUST            (SDF_GRID_CELL * 2.0f)        //Զʹû
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+	float vx, vy; //ͼԪ˶ٶ,ͶӰ
+}  TraceResult;
+//cʾɫ;sumnǳϴα仯Ժ׷ٵ֮,ֻ
+typedef struct { Color c, sum; float n; } Accum;
+
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+Color ColorLerp(Color a, Color b, float t)
+{
+	Color c = { a.r + (b.r - a.r) * t, a.g + (b.g - a.g) * t, a.b + (b.b - a.b) * t };
+	return c;
+}
+
+float Luminance(Color c)
+{
+	return 0.2126f * c.r + 0.7152f * c.g + 0.0722f * c.b;
+}
+
+byte image[WIDTH * HEIGHT * RGB];
+
+Accum accum[2][WIDTH * HEIGHT];  //˫,һһ֡ʷ,һǵǰ֡
+
+float sdfGrid[SDF_GRID_SIZE * SDF_GRID_SIZE];
+byte  sdfGridMaterial[SDF_GRID_SIZE * SDF_GRID_SIZE];
+
+float tileSamples[TILE_X * TILE_Y];  //tileٵۻ,ﵽLIGHT_COUNT
+
+TraceResult Scene(float x, float y, float time);
+
+TraceResult StaticScene(float x, float y, int* material);
+
+TraceResult StaticMaterial(int material, float sdf);
+
+TraceResult CachedStaticScene(float x, float y);
+
+TraceResult DynamicScene(float x, float y, float time);
+
+void EmitterMotion(float time, float* cx, float* cy, float* vx, float* vy);
+
+int DynamicChanged(float prevTime, float time);
+
+void BuildSDFGrid();
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, float time, int count, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth, float time);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float time, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+Accum FetchHistory(const Accum* history, float x, float y);
+
+int RenderTile(int tx, int ty, int frame, float time, int reuse, int moved, const Accum* history, Accum* current);
+
+void WriteFrame(const Accum* current, int frame, FILE* stream);
+
+int main(int argc, char* argv[])
+{
+	//-raw : rgb24ԭʼ֡дstdout, AnimationMain -raw | ffmpeg -f rawvideo -pix_fmt rgb24 -s 512x512 -r 30 -i - anim.mp4
+	//֡д anim_000.png, anim_001.png ...
+	FILE* stream = NULL;
+	if (argc > 1 && strcmp(argv[1], "-raw") == 0)
+	{
+#ifdef _WIN32
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+		stream = stdout;
+	}
+
+	BuildSDFGrid();
+
+	long long totalRays = 0;
+	int prev = 0;
+	for (int frame = 0; frame < FRAME_COUNT; ++frame)
+	{
+		float time = frame * FRAME_TIME;
+		int cur = frame & 1;
+
+		//̬ͼԪһ֡ûж,һ֡ȫһ,ѾtileֱӸ
+		int moved = frame == 0 || DynamicChanged(time - FRAME_TIME, time);
+
+		long long rays = 0;
+		int skipped = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+:rays, skipped)
+		for (int i = 0; i < TILE_X * TILE_Y; ++i)
+		{
+			int tx = i % TILE_X, ty = i / TILE_X;
+			if (!moved && tileSamples[i] >= LIGHT_COUNT)
+			{
+				for (int y = ty * TILE_SIZE; y < (ty + 1) * TILE_SIZE; ++y)
+				{
+					memcpy(&accum[cur][y * WIDTH + tx * TILE_SIZE], &accum[prev][y * WIDTH + tx * TILE_SIZE], sizeof(Accum) * TILE_SIZE);
+				}
+				++skipped;
+				continue;
+			}
+
+			rays += RenderTile(tx, ty, frame, time, frame > 0, moved, accum[prev], accum[cur]);
+		}
+
+		WriteFrame(accum[cur], frame, stream);
+		totalRays += rays;
+		prev = cur;
+		fprintf(stderr, "frame %3d: %4d/%d tiles reused, %lld rays\n", frame, skipped, TILE_X * TILE_Y, rays);
+	}
+
+	long long fullRays = (long long)FRAME_COUNT * WIDTH * HEIGHT * LIGHT_COUNT;
+	fprintf(stderr, "total %lld rays, %.1f%% of rendering every frame from scratch\n", totalRays, 100.0 * totalRays / fullRays);
+	return 0;
+}
+
+int RenderTile(int tx, int ty, int frame, float time, int reuse, int moved, const Accum* history, Accum* current)
+{
+	int rays = 0;
+	float samples = 1e30f;
+
+	for (int y = ty * TILE_SIZE; y < (ty + 1) * TILE_SIZE; ++y)
+	{
+		for (int x = tx * TILE_SIZE; x < (tx + 1) * TILE_SIZE; ++x)
+		{
+			float u = (float)x / WIDTH, v = (float)y / HEIGHT;
+			unsigned int seed = (unsigned int)(y * WIDTH + x) * 9781u + (unsigned int)frame * 6271u + 1u;
+			Accum* out = &current[y * WIDTH + x];
+
+			Accum h = { COLOR_BLACK, COLOR_BLACK, 0.0f };
+			if (reuse)
+			{
+				//ͶӰ:ڶ˶ͼԪڲʱ,ͼԪٶȻصһ֡λȥȡʷ
+				TraceResult r = Scene(u, v, time);
+				if (moved && r.sdf < 0.0f)
+				{
+					h = FetchHistory(history, u - r.vx * FRAME_TIME, v - r.vy * FRAME_TIME);
+				}
+				else
+				{
+					h = history[y * WIDTH + x];
+				}
+			}
+
+			if (h.n > 0.0f)
+			{
+				Color c = Sample(u, v, time, TEMPORAL_SAMPLE, &seed);
+				rays += TEMPORAL_SAMPLE;
+
+				float lh = Luminance(h.c), lc = Luminance(c);
+				if (fabsf(lh - lc) <= HISTORY_REJECT * fmaxf(lh, 0.25f))
+				{
+					if (moved)
+					{
+						//,ʷֻƽʾ,һ֡
+						out->c = ColorLerp(h.c, c, TEMPORAL_ALPHA);
+						out->sum = ColorScale(c, (float)TEMPORAL_SAMPLE);
+						out->n = (float)TEMPORAL_SAMPLE;
+					}
+					else
+					{
+						//û,һֱۼ;ʾɫ𽥹ɵۼӵƽֵ,
+						//ܹLIGHT_COUNTԺȫǵǰĽ,˶ʱµӰᱻ
+						out->sum = ColorAdd(h.sum, ColorScale(c, (float)TEMPORAL_SAMPLE));
+						out->n = h.n + TEMPORAL_SAMPLE;
+						out->c = ColorLerp(h.c, ColorScale(out->sum, 1.0f / out->n), fminf(out->n / LIGHT_COUNT, 1.0f));
+					}
+					samples = fminf(samples, out->n);
+					continue;
+				}
+
+				//ʷʧЧ,ʣµĹ,൱شͷȾ
+				Color rest = Sample(u, v, time, LIGHT_COUNT - TEMPORAL_SAMPLE, &seed);
+				rays += LIGHT_COUNT - TEMPORAL_SAMPLE;
+				out->c = ColorAdd(ColorScale(c, (float)TEMPORAL_SAMPLE / LIGHT_COUNT), ColorScale(rest, (float)(LIGHT_COUNT - TEMPORAL_SAMPLE) / LIGHT_COUNT));
+			}
+			else
+			{
+				out->c = Sample(u, v, time, LIGHT_COUNT, &seed);
+				rays += LIGHT_COUNT;
+			}
+			out->sum = ColorScale(out->c, (float)LIGHT_COUNT);
+			out->n = (float)LIGHT_COUNT;
+			samples = fminf(samples, out->n);
+		}
+	}
+
+	tileSamples[ty * TILE_X + tx] = samples;
+	return rays;
+}
+
+Accum FetchHistory(const Accum* history, float x, float y)
+{
+	//˫ȡʷ,͵ûʷ
+	float fx = x * WIDTH, fy = y * HEIGHT;
+	int x0 = (int)floorf(fx), y0 = (int)floorf(fy);
+	Accum h = { COLOR_BLACK, COLOR_BLACK, 0.0f };
+	if (x0 < 0 || y0 < 0 || x0 + 1 >= WIDTH || y0 + 1 >= HEIGHT)
+	{
+		return h;
+	}
+
+	float sx = fx - x0, sy = fy - y0;
+	const Accum* p = &history[y0 * WIDTH + x0];
+	Color top = ColorLerp(p[0].c, p[1].c, sx);
+	Color bottom = ColorLerp(p[WIDTH].c, p[WIDTH + 1].c, sx);
+	h.c = ColorLerp(top, bottom, sy);
+	h.n = fminf(fminf(p[0].n, p[1].n), fminf(p[WIDTH].n, p[WIDTH + 1].n));
+	return h;
+}
+
+void WriteFrame(const Accum* current, int frame, FILE* stream)
+{
+	byte* p = image;
+	for (int i = 0; i < WIDTH * HEIGHT; ++i)
+	{
+		Color c = current[i].c;
+		p[0] = (int)(fminf(c.r * 255.0f, 255.0f));
+		p[1] = (int)(fminf(c.g * 255.0f, 255.0f));
+		p[2] = (int)(fminf(c.b * 255.0f, 255.0f));
+		p += RGB;
+	}
+
+	if (stream)
+	{
+		fwrite(image, 1, sizeof(image), stream);
+		fflush(stream);
+		return;
+	}
+
+	char path[64];
+	sprintf(path, "..//..//png//anim_%03d.png", frame);
+	FILE* fp = fopen(path, "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+Color Sample(float x, float y, float time, int count, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < count; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / count;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0, time));
+	}
+	return ColorScale(sum, 1.0f / count);
+}
+
+#include "sdf.inc"
+
+Color Trace(float ox, float oy, float dx, float dy, int depth, float time)
+{
+	float t = 1e-3f;
+	float sign = Scene(ox, oy, time).sdf > 0.0f ? 1.0f : -1.0f;
+
+	for (int i = 0; i < RAY_MARCHING_MAX_STEP && t < RAY_MARCHING_MAX_DISTANCE; ++i)
+	{
+		float x = ox + dx * t;
+		float y = oy + dy * t;
+		TraceResult r = Scene(x, y, time);
+		if (r.sdf * sign  < EPSILON) //Ϊǹⲿп,ڹ߲ʱҪǷ
+		{
+			Color sum = r.emissive;
+			//SDFõǿɷ߿,TraceĵݹҪķΧ
+			if (depth < RAY_MAX_TRACE_STEP && ((r.reflectivity > 0.0f) || (r.eta > 0.0f)))
+			{
+				float reflect = r.reflectivity;
+				float nx, ny, rx, ry;
+				Gradient(x, y, time, &nx, &ny);//㷨
+				//״ڲǻҪת
+				nx *= sign;
+				ny *= sign;
+				//׷
+				if (r.eta > 0.0f)
+				{
+					float eta = sign < 0.0f ? r.eta : 1.0f / r.eta;
+					//(dx,dy)
+					if (REFRACT == Refract(dx, dy, nx, ny, eta, &rx, &ry))
+					{
+						float cosi = -(dx * nx + dy * ny);
+						float cost = -(rx * nx + ry * ny);
+						reflect = sign < 0.0f ? Fresnel(cosi, cost, r.eta, 1.0f) : Fresnel(cosi, cost, 1.0f, r.eta);
+						Color trace = Trace(x - nx * RAY_BIAS, y - ny * RAY_BIAS, rx, ry, depth + 1, time);
+						sum = ColorAdd(sum, ColorScale(trace, 1.0f - reflect));
+					}
+					else
+					{
+						//ȫ,
+						reflect = 1.0f;
+					}
+				}
+				//׷ٷ
+				if (reflect > 0.0f)
+				{
+					Reflect(dx, dy, nx, ny, &rx, &ry);
+					Color trace = Trace(x + nx * RAY_BIAS, y + ny * RAY_BIAS, rx, ry, depth + 1, time);
+					sum = ColorAdd(sum, ColorScale(trace, reflect));
+				}
+			}
+			return ColorMultiply(sum, BeerLambert(r.absorption, t));
+		}
+
+		//߲ǹ״ڻ״
+		t += r.sdf * sign;
+	}
+
+	Color black = COLOR_BLACK;
+	return black;
+}
+
+void Reflect(float ix, float iy, float nx, float ny, float * rx, float * ry)
+{
+	float idotn2 = (ix * nx + iy * ny) * 2.0f;
+	*rx = ix - idotn2 * nx;
+	*ry = iy - idotn2 * ny;
+}
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float * rx, float * ry)
+{
+	//(nx,ny)ǵλ,(rx, ry)ǵλ
+	float idotn = ix * nx + iy * ny;
+	float k = 1.0f - eta * eta * (1.0f - idotn * idotn);
+	if (k < 0.0f)
+	{
+		return TOTAL_REFLECT;//ȫ
+	}
+
+	float a = eta * idotn + sqrtf(k);
+	*rx = eta * ix - a * nx;
+	*ry = eta * iy - a * ny;
+	return REFRACT;//
+}
+
+void Gradient(float x, float y, float time, float * nx, float * ny)
+{
+	//ݶƫ΢,ʹýֵ,xyϷֱ𲽽delta(ȡõEpsilon),Ȼ΢
+	*nx = (Scene(x + EPSILON, y, time).sdf - Scene(x - EPSILON, y, time).sdf) * (0.5f / EPSILON);
+	*ny = (Scene(x, y + EPSILON, time).sdf - Scene(x, y - EPSILON, time).sdf) * (0.5f / EPSILON);
+}
+
+float Fresnel(float cosi, float cost, float etai, float etat)
+{
+	float rs = (etat * cosi - etai * cost) / (etat * cosi + etai * cost);
+	float rp = (etai * cosi - etat * cost) / (etai * cosi + etat * cost);
+	//ͼѧǿǹƫ,ȡsƫpƫľֵ
+	return (rs * rs + rp * rp) * 0.5f;
+}
+
+Color BeerLambert(Color a, float d)
+{
+	Color c = { expf(-a.r * d), expf(-a.g * d), expf(-a.b * d) };
+	return c;
+}
+
+TraceResult Scene(float x, float y, float time)
+{
+	return Union(CachedStaticScene(x, y), DynamicScene(x, y, time));
+}
+
+TraceResult StaticMaterial(int material, float sdf)
+{
+	TraceResult glass  = { sdf, 0.0f, 1.5f, COLOR_BLACK, { 4.0f, 4.0f, 1.0f }, 0.0f, 0.0f };
+	TraceResult mirror = { sdf, 0.9f, 0.0f, COLOR_BLACK, COLOR_BLACK, 0.0f, 0.0f };
+	return material == 0 ? glass : mirror;
+}
+
+TraceResult StaticScene(float x, float y, int* material)
+{
+	float a = NgonSDF(x, y, 0.5f, 0.5f, 0.2f, 5.0f);
+	float b = BoxSDF(x, y, 0.5f, 0.9f, TWO_PI / 16.0f, 0.15f, 0.02f);
+	*material = a < b ? 0 : 1;
+	return StaticMaterial(*material, fminf(a, b));
+}
+
+void EmitterMotion(float time, float* cx, float* cy, float* vx, float* vy)
+{
+	//ԲƳĻת,ÿתͣ
+	float w = 0.5f * TWO_PI / 4.0f;
+	float phase = floorf(time) * 0.5f + fminf(time - floorf(time), 0.5f);
+	float moving = time - floorf(time) < 0.5f ? 1.0f : 0.0f;
+
+	*cx = 0.5f + 0.4f * cosf(w * phase);
+	*cy = 0.5f + 0.4f * sinf(w * phase);
+	*vx = -0.4f * w * sinf(w * phase) * moving;
+	*vy = 0.4f * w * cosf(w * phase) * moving;
+}
+
+TraceResult DynamicScene(float x, float y, float time)
+{
+	float cx, cy, vx, vy;
+	EmitterMotion(time, &cx, &cy, &vx, &vy);
+
+	TraceResult r = { CircleSDF(x, y, cx, cy, 0.05f), 0.0f, 0.0f, { 6.0f, 6.0f, 6.0f }, COLOR_BLACK, vx, vy };
+	return r;
+}
+
+int DynamicChanged(float prevTime, float time)
+{
+	//Ƚʱ̶̬ͼԪ״̬,ֻһԲ
+	float px, py, cx, cy, vx, vy;
+	EmitterMotion(prevTime, &px, &py, &vx, &vy);
+	EmitterMotion(time, &cx, &cy, &vx, &vy);
+	return px != cx || py != cy;
+}
+
+void BuildSDFGrid()
+{
+	//̬ͼԪʱ仯,ԤȰǵSDF,ʱԶĵطֵ
+#pragma omp parallel for
+	for (int j = 0; j < SDF_GRID_SIZE; ++j)
+	{
+		for (int i = 0; i < SDF_GRID_SIZE; ++i)
+		{
+			int material;
+			TraceResult r = StaticScene(SDF_GRID_MIN + i * SDF_GRID_CELL, SDF_GRID_MIN + j * SDF_GRID_CELL, &material);
+			sdfGrid[j * SDF_GRID_SIZE + i] = r.sdf;
+			sdfGridMaterial[j * SDF_GRID_SIZE + i] = (byte)material;
+		}
+	}
+}
+
+TraceResult CachedStaticScene(float x, float y)
+{
+	int material;
+	float fx = (x - SDF_GRID_MIN) / SDF_GRID_CELL, fy = (y - SDF_GRID_MIN) / SDF_GRID_CELL;
+	int i = (int)floorf(fx), j = (int)floorf(fy);
+	if (i < 0 || j < 0 || i + 1 >= SDF_GRID_SIZE || j + 1 >= SDF_GRID_SIZE)
+	{
+		return StaticScene(x, y, &material);
+	}
+
+	float sx = fx - i, sy = fy - j;
+	const float* p = &sdfGrid[j * SDF_GRID_SIZE + i];
+	float d = (p[0] + (p[1] - p[0]) * sx) * (1.0f - sy) + (p[SDF_GRID_SIZE] + (p[SDF_GRID_SIZE + 1] - p[SDF_GRID_SIZE]) * sx) * sy;
+
+	//ʱֵӰкͷ,ʱʵʵֵ
+	if (fabsf(d) < SDF_GRID_ERROR + SDF_GRID_TRUST)
+	{
+		return StaticScene(x, y, &material);
+	}
+
+	//Զʱȥֵ,֤Խ
+	d = d > 0.0f ? d - SDF_GRID_ERROR : d + SDF_GRID_ERROR;
+	return StaticMaterial(sdfGridMaterial[j * SDF_GRID_SIZE + i], d);
+}
+//
+//
+////DOC:
+////ʱ
+//֮֡Դ״ֻƶһ,ÿ֡ͷȾ˷,︴һ֡Ľ:
+//1.Scenetime,TraceResult¼ͼԪ˶ٶ(vx,vy)
+//2.ʷÿֻ֡׷TEMPORAL_SAMPLE:ڶʱʷTEMPORAL_ALPHAָƽ,
+//  ˶ͼԪڲʱٶȻصһ֡λȡʷ(ͶӰ)
+//  ¾ɽ̫˵ʷʧЧ,LIGHT_COUNT
+//3.ֻͳƳϴα仯Ժ׷ٵĹ,̬ͼԪͣԺһֱۼ,ʾɫ𽥹ɵۼӵƽֵ;
+//  tileÿضܹLIGHT_COUNT,ҳû,ֱӿʷ,һ߶׷
+//4.̬ͼԪԤȲSDF,Զʱ,ֵȥ˫Բֵ(Խ߳)ΪصĲ
@@ -0,0 +1,999 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define USE_SSE2
+#endif
+#if defined(__GLIBC__)
+#define HEAP_COUNTING                    //glibc:Լmallocһ,ٽlibc,(libgompstdio)Ķѷ䶼
+#elif defined(_MSC_VER) && defined(_DEBUG)
+#include <crtdbg.h>
+#define HEAP_COUNTING                    //MSVC԰CRT:_CrtSetAllocHook;ƽֻ̨ͳAlignedMalloc
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+#define CHECK_COUNT               (4099)   //-checkʱÿ˺Եļ¼,ⲻ4ı,βҲҪ⵽
+#define CHECK_FRAMES              (4)      //-checkȾô֡,һ֡Ժÿһ֡Ӧжѷ
+
+//ÿ̵߳ʱڴ
+#define ARENA_ALIGN               (64)     //ÿη䶼ж,SSE/AVXĶض
+#define ARENA_INITIAL             (1 << 20)
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+//һ,SoA
+typedef struct
+{
+	float *ox, *oy, *dx, *dy;
+	float *wr, *wg, *wb;  //:ߴķҪżӵ
+	int* pixel;
+	int count, capacity;
+} RayBatch;
+
+//һм¼,SoA;벿ɫ˺
+typedef struct
+{
+	float *x, *y, *dx, *dy, *nx, *ny;  //Ѿⷭת,Traceһ
+	float *reflectivity, *eta, *etai, *etat, *ratio, *distance;  //etaǲʵ,0ʾ;ratio/
+	float *ar, *ag, *ab, *er, *eg, *eb;
+	float *wr, *wg, *wb;
+	int* pixel;
+
+	float *tr, *tg, *tb;       //BeerLambert͸
+	float *rx, *ry, *tx, *ty;  //䷽,䷽
+	float *cosi, *cost, *fresnel;
+	int* refracted;
+	int count, capacity;
+} HitBatch;
+
+//,Ųʱʱ,˻ص֮ǰλʱͷ
+typedef struct ArenaBlock
+{
+	struct ArenaBlock* next;
+	size_t position, size;  //ǰused + overflow,ͿĴС
+} ArenaBlock;
+
+//Է:ֻǰused,ܵͷ,ֻ˻صĳλû֡
+typedef struct
+{
+	byte* base;
+	size_t capacity, used;
+	size_t overflow;        //ֽ
+	size_t peak;            //used + overflowʷֵ
+	ArenaBlock* blocks;     //ǰ
+} Arena;
+
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+byte image[WIDTH * HEIGHT * RGB];
+
+Color batched[WIDTH * HEIGHT], scalar[WIDTH * HEIGHT];
+
+Arena arena;  //ÿ߳һ,֮䱣,߳һֱͬһڴ
+#pragma omp threadprivate(arena)
+
+int heapAllocations;  //̵Ķѷ,ûHEAP_COUNTINGʱֻAlignedMalloc
+size_t arenaPeak, arenaCapacity;  //һ̵֡߳ķֵС֮
+size_t arenaMaxPeak;              //һ̵ֵ֡߳,̵߳鶼ô
+
+TraceResult Scene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+//汾:n¼һ,SSE2ÿ4,ʣ²4Ľı
+void ReflectBatch(int n, const float* ix, const float* iy, const float* nx, const float* ny, float* rx, float* ry);
+
+void RefractBatch(int n, const float* ix, const float* iy, const float* nx, const float* ny, const float* eta, float* rx, float* ry, int* result);
+
+void FresnelBatch(int n, const float* cosi, const float* cost, const float* etai, const float* etat, float* r);
+
+void BeerLambertBatch(int n, const float* ar, const float* ag, const float* ab, const float* d, float* tr, float* tg, float* tb);
+
+void ShadeBatch(HitBatch* hits, RayBatch* next);
+
+void* AlignedMalloc(size_t size);
+
+void AlignedFree(void* p);
+
+#if defined(HEAP_COUNTING) && defined(__GLIBC__)
+//glibcԭʼ亯
+void* __libc_malloc(size_t size);
+
+void* __libc_calloc(size_t count, size_t size);
+
+void* __libc_realloc(void* p, size_t size);
+
+void* __libc_memalign(size_t alignment, size_t size);
+#elif defined(HEAP_COUNTING)
+int AllocHook(int allocType, void* userData, size_t size, int blockType, long requestNumber, const unsigned char* filename, int lineNumber);
+#endif
+
+void* ArenaAlloc(Arena* a, size_t size);
+
+size_t ArenaMark(Arena* a);
+
+void ArenaRelease(Arena* a, size_t mark);
+
+void ArenaReset(Arena* a);
+
+void ArenaReserve(Arena* a, size_t capacity);
+
+void AllocRays(Arena* a, RayBatch* rays, int n);
+
+void AllocHits(Arena* a, HitBatch* hits, int n);
+
+void RenderBatched(Color* out);
+
+void RenderRow(Color* out, int y, RayBatch* rays, HitBatch* hits);
+
+void ArenaEndFrame();
+
+void RenderScalar(Color* out);
+
+int CheckKernels();
+
+void WriteImage(const Color* c, const char* path);
+
+int main(int argc, char* argv[])
+{
+	//BatchShadeMain [-check] [-frames ֡] : -checkȶԱȺ˺ͱ,Ⱦ֡,
+	//ȷϵһ֡Ժûжѷ,صݹTraceȾһȽ
+	int check = 0, frames = 1;
+#if defined(HEAP_COUNTING) && defined(_MSC_VER)
+	_CrtSetAllocHook(AllocHook);
+#endif
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-check") == 0)
+		{
+			check = 1;
+		}
+		else if (strcmp(argv[i], "-frames") == 0 && i + 1 < argc)
+		{
+			frames = atoi(argv[++i]);
+		}
+	}
+	if (check && !CheckKernels())
+	{
+		return 1;
+	}
+	if (check && frames < CHECK_FRAMES)
+	{
+		frames = CHECK_FRAMES;
+	}
+
+	//ͬһȾframes,֡
+	int steadyAllocations = 0;
+	for (int frame = 0; frame < frames; ++frame)
+	{
+		int allocations = heapAllocations;
+		double start = Now();
+		RenderBatched(batched);
+		allocations = heapAllocations - allocations;
+		printf("batched render: %.2fs, %d heap allocations, arena peak %.1fMB of %.1fMB\n",
+			Now() - start, allocations, arenaPeak / 1048576.0, arenaCapacity / 1048576.0);
+		steadyAllocations += frame > 0 ? allocations : 0;
+	}
+	WriteImage(batched, "..//..//png//batch_shade.png");
+
+	if (check)
+	{
+		double start = Now();
+		RenderScalar(scalar);
+		printf("scalar render: %.2fs\n", Now() - start);
+
+		//ȫһ,ֻۼ˳SIMDexpf
+		float maxDiff = 0.0f;
+		for (int i = 0; i < WIDTH * HEIGHT; ++i)
+		{
+			maxDiff = fmaxf(maxDiff, fabsf(batched[i].r - scalar[i].r));
+			maxDiff = fmaxf(maxDiff, fabsf(batched[i].g - scalar[i].g));
+			maxDiff = fmaxf(maxDiff, fabsf(batched[i].b - scalar[i].b));
+		}
+		printf("max difference against scalar render: %g\n", maxDiff);
+
+#ifdef HEAP_COUNTING
+		printf("heap allocations after the first frame: %d\n", steadyAllocations);
+#else
+		printf("heap allocations after the first frame: %d (AlignedMalloc only)\n", steadyAllocations);
+#endif
+		if (steadyAllocations != 0)
+		{
+			return 1;
+		}
+	}
+
+	printf("Svnpng Success\n");
+	return 0;
+}
+
+void RenderBatched(Color* out)
+{
+	//ǰ:һصйһ𲽽,м¼ܳһٽɫ˺,һĹ
+	//ߺм¼߳Լarena,һ˻
+	arenaPeak = arenaCapacity = arenaMaxPeak = 0;
+#ifdef _OPENMP
+	//libgompÿνֻһ̵߳ĲҪ·team,omp forҲҪ,ֻһ߳ʱOpenMP
+	if (omp_get_max_threads() > 1)
+	{
+#pragma omp parallel
+		{
+			RayBatch rays[2];
+			HitBatch hits;
+
+#pragma omp for schedule(dynamic)
+			for (int y = 0; y < HEIGHT; ++y)
+			{
+				RenderRow(out, y, rays, &hits);
+			}
+			ArenaEndFrame();
+		}
+		return;
+	}
+#endif
+	RayBatch rays[2];
+	HitBatch hits;
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		RenderRow(out, y, rays, &hits);
+	}
+	ArenaEndFrame();
+}
+
+void RenderRow(Color* out, int y, RayBatch* rays, HitBatch* hits)
+{
+	size_t mark = ArenaMark(&arena);
+	RayBatch* cur = &rays[0];
+	RayBatch* next = &rays[1];
+	AllocRays(&arena, cur, WIDTH * LIGHT_COUNT);
+	for (int x = 0; x < WIDTH; ++x)
+	{
+		//Sampleȫһ
+		unsigned int seed = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+		out[y * WIDTH + x].r = out[y * WIDTH + x].g = out[y * WIDTH + x].b = 0.0f;
+		for (int i = 0; i < LIGHT_COUNT; ++i)
+		{
+			float radians = TWO_PI * (i + Random(&seed)) / LIGHT_COUNT;
+			int k = cur->count++;
+			cur->ox[k] = (float)x / WIDTH;
+			cur->oy[k] = (float)y / HEIGHT;
+			cur->dx[k] = cosf(radians);
+			cur->dy[k] = sinf(radians);
+			cur->wr[k] = cur->wg[k] = cur->wb[k] = 1.0f / LIGHT_COUNT;
+			cur->pixel[k] = y * WIDTH + x;
+		}
+	}
+
+	for (int depth = 0; cur->count > 0; ++depth)
+	{
+		//ֻһһ(ÿߵĲһ),еļ²
+		AllocHits(&arena, hits, cur->count);
+		for (int k = 0; k < cur->count; ++k)
+		{
+			float ox = cur->ox[k], oy = cur->oy[k], dx = cur->dx[k], dy = cur->dy[k];
+			float t = 1e-3f;
+			float sign = Scene(ox, oy).sdf > 0.0f ? 1.0f : -1.0f;
+			for (int i = 0; i < RAY_MARCHING_MAX_STEP && t < RAY_MARCHING_MAX_DISTANCE; ++i)
+			{
+				float x = ox + dx * t;
+				float y = oy + dy * t;
+				TraceResult r = Scene(x, y);
+				if (r.sdf * sign < EPSILON)
+				{
+					int h = hits->count++;
+					hits->x[h] = x;
+					hits->y[h] = y;
+					hits->dx[h] = dx;
+					hits->dy[h] = dy;
+					hits->nx[h] = sign;  //ȼ·,Ҫ׷ٵĲ㷨
+					hits->reflectivity[h] = r.reflectivity;
+					hits->eta[h] = r.eta;
+					hits->distance[h] = t;
+					hits->ar[h] = r.absorption.r;
+					hits->ag[h] = r.absorption.g;
+					hits->ab[h] = r.absorption.b;
+					hits->er[h] = r.emissive.r;
+					hits->eg[h] = r.emissive.g;
+					hits->eb[h] = r.emissive.b;
+					hits->wr[h] = cur->wr[k];
+					hits->wg[h] = cur->wg[k];
+					hits->wb[h] = cur->wb[k];
+					hits->pixel[h] = cur->pixel[k];
+					break;
+				}
+				t += r.sdf * sign;
+			}
+		}
+
+		//еԷͺз䡢ĹⶼҪһε͸
+		BeerLambertBatch(hits->count, hits->ar, hits->ag, hits->ab, hits->distance, hits->tr, hits->tg, hits->tb);
+
+		int n = 0;
+		for (int h = 0; h < hits->count; ++h)
+		{
+			float wr = hits->wr[h] * hits->tr[h], wg = hits->wg[h] * hits->tg[h], wb = hits->wb[h] * hits->tb[h];
+			Color* c = &out[hits->pixel[h]];
+			c->r += hits->er[h] * wr;
+			c->g += hits->eg[h] * wg;
+			c->b += hits->eb[h] * wb;
+
+			//ɷ߿,ҵݹҪķΧ,ShadeBatch
+			if (depth < RAY_MAX_TRACE_STEP && (hits->reflectivity[h] > 0.0f || hits->eta[h] > 0.0f))
+			{
+				float sign = hits->nx[h], nx, ny;
+				Gradient(hits->x[h], hits->y[h], &nx, &ny);
+				hits->x[n] = hits->x[h];
+				hits->y[n] = hits->y[h];
+				hits->dx[n] = hits->dx[h];
+				hits->dy[n] = hits->dy[h];
+				hits->nx[n] = nx * sign;
+				hits->ny[n] = ny * sign;
+				hits->reflectivity[n] = hits->reflectivity[h];
+				hits->etai[n] = sign < 0.0f ? hits->eta[h] : 1.0f;
+				hits->etat[n] = sign < 0.0f ? 1.0f : hits->eta[h];
+				hits->eta[n] = hits->eta[h];
+				//ļ¼ҲҪһֵ,RefractBatch,
+				hits->ratio[n] = hits->eta[h] > 0.0f ? hits->etai[n] / hits->etat[n] : 1.0f;
+				hits->wr[n] = wr;
+				hits->wg[n] = wg;
+				hits->wb[n] = wb;
+				hits->pixel[n] = hits->pixel[h];
+				++n;
+			}
+		}
+		hits->count = n;
+
+		ShadeBatch(hits, next);
+		RayBatch* swap = cur;
+		cur = next;
+		next = swap;
+	}
+	ArenaRelease(&arena, mark);
+}
+
+void ArenaEndFrame()
+{
+	//֡:Ƕ̵̬߳,һ֡һֵܷ߳̿߳һ֡ص,
+	//̵߳鶼߳ķֵ·,һ֡Ͳٷ
+	ArenaReset(&arena);
+#pragma omp critical(arenaStats)
+	if (arena.peak > arenaMaxPeak)
+	{
+		arenaMaxPeak = arena.peak;
+	}
+#pragma omp barrier
+	ArenaReserve(&arena, arenaMaxPeak);
+#pragma omp critical(arenaStats)
+	{
+		arenaPeak += arena.peak;
+		arenaCapacity += arena.capacity;
+	}
+}
+
+void ShadeBatch(HitBatch* hits, RayBatch* next)
+{
+	int n = hits->count;
+
+	RefractBatch(n, hits->dx, hits->dy, hits->nx, hits->ny, hits->ratio, hits->tx, hits->ty, hits->refracted);
+	for (int i = 0; i < n; ++i)
+	{
+		hits->cosi[i] = -(hits->dx[i] * hits->nx[i] + hits->dy[i] * hits->ny[i]);
+		hits->cost[i] = -(hits->tx[i] * hits->nx[i] + hits->ty[i] * hits->ny[i]);
+	}
+	FresnelBatch(n, hits->cosi, hits->cost, hits->etai, hits->etat, hits->fresnel);
+	ReflectBatch(n, hits->dx, hits->dy, hits->nx, hits->ny, hits->rx, hits->ry);
+
+	//һĹ,ȨصķTraceȫһ
+	AllocRays(&arena, next, n * 2);
+	for (int i = 0; i < n; ++i)
+	{
+		float reflect = hits->reflectivity[i];
+		float x = hits->x[i], y = hits->y[i], nx = hits->nx[i], ny = hits->ny[i];
+		if (hits->eta[i] > 0.0f)
+		{
+			if (hits->refracted[i] == REFRACT)
+			{
+				reflect = hits->fresnel[i];
+				int k = next->count++;
+				next->ox[k] = x - nx * RAY_BIAS;
+				next->oy[k] = y - ny * RAY_BIAS;
+				next->dx[k] = hits->tx[i];
+				next->dy[k] = hits->ty[i];
+				next->wr[k] = hits->wr[i] * (1.0f - reflect);
+				next->wg[k] = hits->wg[i] * (1.0f - reflect);
+				next->wb[k] = hits->wb[i] * (1.0f - reflect);
+				next->pixel[k] = hits->pixel[i];
+			}
+			else
+			{
+				reflect = 1.0f;
+			}
+		}
+		if (reflect > 0.0f)
+		{
+			int k = next->count++;
+			next->ox[k] = x + nx * RAY_BIAS;
+			next->oy[k] = y + ny * RAY_BIAS;
+			next->dx[k] = hits->rx[i];
+			next->dy[k] = hits->ry[i];
+			next->wr[k] = hits->wr[i] * reflect;
+			next->wg[k] = hits->wg[i] * reflect;
+			next->wb[k] = hits->wb[i] * reflect;
+			next->pixel[k] = hits->pixel[i];
+		}
+	}
+}
+
+#ifdef USE_SSE2
+__m128 ExpSSE(__m128 x)
+{
+	//cephesexpf:x = n*ln2 + r,e^röʽ,2^nֱƴָλ;expf1e-7
+	const __m128 one = _mm_set1_ps(1.0f);
+	x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-87.3365f)), _mm_set1_ps(88.3762f));
+
+	__m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+	__m128 n = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+	n = _mm_sub_ps(n, _mm_and_ps(_mm_cmpgt_ps(n, fx), one));
+
+	//ln2,ʱ򲻶
+	x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(0.693359375f)));
+	x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(-2.12194440e-4f)));
+
+	__m128 y = _mm_set1_ps(1.9875691500e-4f);
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+	y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, _mm_mul_ps(x, x)), x), one);
+
+	__m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n), _mm_set1_epi32(127)), 23));
+	return _mm_mul_ps(y, scale);
+}
+#endif
+
+void ReflectBatch(int n, const float* ix, const float* iy, const float* nx, const float* ny, float* rx, float* ry)
+{
+	int i = 0;
+#ifdef USE_SSE2
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 dx = _mm_loadu_ps(ix + i), dy = _mm_loadu_ps(iy + i);
+		__m128 gx = _mm_loadu_ps(nx + i), gy = _mm_loadu_ps(ny + i);
+		__m128 idotn2 = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(dx, gx), _mm_mul_ps(dy, gy)), _mm_set1_ps(2.0f));
+		_mm_storeu_ps(rx + i, _mm_sub_ps(dx, _mm_mul_ps(idotn2, gx)));
+		_mm_storeu_ps(ry + i, _mm_sub_ps(dy, _mm_mul_ps(idotn2, gy)));
+	}
+#endif
+	for (; i < n; ++i)
+	{
+		Reflect(ix[i], iy[i], nx[i], ny[i], &rx[i], &ry[i]);
+	}
+}
+
+void RefractBatch(int n, const float* ix, const float* iy, const float* nx, const float* ny, const float* eta, float* rx, float* ry, int* result)
+{
+	int i = 0;
+#ifdef USE_SSE2
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 dx = _mm_loadu_ps(ix + i), dy = _mm_loadu_ps(iy + i);
+		__m128 gx = _mm_loadu_ps(nx + i), gy = _mm_loadu_ps(ny + i);
+		__m128 e = _mm_loadu_ps(eta + i);
+		__m128 idotn = _mm_add_ps(_mm_mul_ps(dx, gx), _mm_mul_ps(dy, gy));
+		__m128 k = _mm_sub_ps(one, _mm_mul_ps(_mm_mul_ps(e, e), _mm_sub_ps(one, _mm_mul_ps(idotn, idotn))));
+
+		//ȫǼk<0,,TOTAL_REFLECT
+		__m128 valid = _mm_cmpge_ps(k, zero);
+		__m128 a = _mm_add_ps(_mm_mul_ps(e, idotn), _mm_sqrt_ps(_mm_max_ps(k, zero)));
+		_mm_storeu_ps(rx + i, _mm_and_ps(_mm_sub_ps(_mm_mul_ps(e, dx), _mm_mul_ps(a, gx)), valid));
+		_mm_storeu_ps(ry + i, _mm_and_ps(_mm_sub_ps(_mm_mul_ps(e, dy), _mm_mul_ps(a, gy)), valid));
+		_mm_storeu_si128((__m128i*)(result + i), _mm_and_si128(_mm_castps_si128(valid), _mm_set1_epi32(REFRACT)));
+	}
+#endif
+	for (; i < n; ++i)
+	{
+		rx[i] = ry[i] = 0.0f;
+		result[i] = Refract(ix[i], iy[i], nx[i], ny[i], eta[i], &rx[i], &ry[i]);
+	}
+}
+
+void FresnelBatch(int n, const float* cosi, const float* cost, const float* etai, const float* etat, float* r)
+{
+	int i = 0;
+#ifdef USE_SSE2
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 ci = _mm_loadu_ps(cosi + i), ct = _mm_loadu_ps(cost + i);
+		__m128 ei = _mm_loadu_ps(etai + i), et = _mm_loadu_ps(etat + i);
+		__m128 tci = _mm_mul_ps(et, ci), ict = _mm_mul_ps(ei, ct);
+		__m128 ici = _mm_mul_ps(ei, ci), tct = _mm_mul_ps(et, ct);
+		__m128 rs = _mm_div_ps(_mm_sub_ps(tci, ict), _mm_add_ps(tci, ict));
+		__m128 rp = _mm_div_ps(_mm_sub_ps(ici, tct), _mm_add_ps(ici, tct));
+		_mm_storeu_ps(r + i, _mm_mul_ps(_mm_add_ps(_mm_mul_ps(rs, rs), _mm_mul_ps(rp, rp)), _mm_set1_ps(0.5f)));
+	}
+#endif
+	for (; i < n; ++i)
+	{
+		r[i] = Fresnel(cosi[i], cost[i], etai[i], etat[i]);
+	}
+}
+
+void BeerLambertBatch(int n, const float* ar, const float* ag, const float* ab, const float* d, float* tr, float* tg, float* tb)
+{
+	int i = 0;
+#ifdef USE_SSE2
+	const __m128 zero = _mm_setzero_ps();
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 nd = _mm_sub_ps(zero, _mm_loadu_ps(d + i));
+		_mm_storeu_ps(tr + i, ExpSSE(_mm_mul_ps(_mm_loadu_ps(ar + i), nd)));
+		_mm_storeu_ps(tg + i, ExpSSE(_mm_mul_ps(_mm_loadu_ps(ag + i), nd)));
+		_mm_storeu_ps(tb + i, ExpSSE(_mm_mul_ps(_mm_loadu_ps(ab + i), nd)));
+	}
+#endif
+	for (; i < n; ++i)
+	{
+		Color a = { ar[i], ag[i], ab[i] };
+		Color t = BeerLambert(a, d[i]);
+		tr[i] = t.r;
+		tg[i] = t.g;
+		tb[i] = t.b;
+	}
+}
+
+int CheckKernels()
+{
+	//м¼,ͱȽ
+	HitBatch h;
+	size_t mark = ArenaMark(&arena);
+	AllocHits(&arena, &h, CHECK_COUNT);
+	unsigned int seed = 12345u;
+	for (int i = 0; i < CHECK_COUNT; ++i)
+	{
+		float a = TWO_PI * Random(&seed), b = TWO_PI * Random(&seed);
+		h.dx[i] = cosf(a);
+		h.dy[i] = sinf(a);
+		h.nx[i] = cosf(b);
+		h.ny[i] = sinf(b);
+		//һ,һ,ȫ
+		h.etai[i] = Random(&seed) < 0.5f ? 1.0f : 1.0f + Random(&seed);
+		h.etat[i] = h.etai[i] > 1.0f ? 1.0f : 1.0f + Random(&seed);
+		h.ratio[i] = h.etai[i] / h.etat[i];
+		h.distance[i] = 2.0f * Random(&seed);
+		h.ar[i] = 10.0f * Random(&seed);
+		h.ag[i] = 4.0f * Random(&seed);
+		h.ab[i] = Random(&seed);
+	}
+
+	ReflectBatch(CHECK_COUNT, h.dx, h.dy, h.nx, h.ny, h.rx, h.ry);
+	RefractBatch(CHECK_COUNT, h.dx, h.dy, h.nx, h.ny, h.ratio, h.tx, h.ty, h.refracted);
+	for (int i = 0; i < CHECK_COUNT; ++i)
+	{
+		h.cosi[i] = -(h.dx[i] * h.nx[i] + h.dy[i] * h.ny[i]);
+		h.cost[i] = -(h.tx[i] * h.nx[i] + h.ty[i] * h.ny[i]);
+	}
+	FresnelBatch(CHECK_COUNT, h.cosi, h.cost, h.etai, h.etat, h.fresnel);
+	BeerLambertBatch(CHECK_COUNT, h.ar, h.ag, h.ab, h.distance, h.tr, h.tg, h.tb);
+
+	float reflectError = 0.0f, refractError = 0.0f, fresnelError = 0.0f, beerError = 0.0f;
+	int mismatch = 0, total = 0;
+	for (int i = 0; i < CHECK_COUNT; ++i)
+	{
+		float rx, ry;
+		Reflect(h.dx[i], h.dy[i], h.nx[i], h.ny[i], &rx, &ry);
+		reflectError = fmaxf(reflectError, fmaxf(fabsf(rx - h.rx[i]), fabsf(ry - h.ry[i])));
+
+		int result = Refract(h.dx[i], h.dy[i], h.nx[i], h.ny[i], h.ratio[i], &rx, &ry);
+		mismatch += result != h.refracted[i];
+		if (result == REFRACT && h.refracted[i] == REFRACT)
+		{
+			refractError = fmaxf(refractError, fmaxf(fabsf(rx - h.tx[i]), fabsf(ry - h.ty[i])));
+			fresnelError = fmaxf(fresnelError, fabsf(Fresnel(h.cosi[i], h.cost[i], h.etai[i], h.etat[i]) - h.fresnel[i]));
+		}
+		total += result == TOTAL_REFLECT;
+
+		//͸ȡ,СֵҲҪ׼
+		Color a = { h.ar[i], h.ag[i], h.ab[i] };
+		Color t = BeerLambert(a, h.distance[i]);
+		beerError = fmaxf(beerError, fabsf(t.r - h.tr[i]) / t.r);
+		beerError = fmaxf(beerError, fabsf(t.g - h.tg[i]) / t.g);
+		beerError = fmaxf(beerError, fabsf(t.b - h.tb[i]) / t.b);
+	}
+	ArenaRelease(&arena, mark);
+
+	printf("%d records, %d total reflections\n", CHECK_COUNT, total);
+	printf("Reflect     max abs error %g\n", reflectError);
+	printf("Refract     max abs error %g, %d mismatched results\n", refractError, mismatch);
+	printf("Fresnel     max abs error %g\n", fresnelError);
+	printf("BeerLambert max rel error %g\n", beerError);
+
+	int ok = mismatch == 0 && reflectError < 1e-6f && refractError < 1e-5f && fresnelError < 1e-5f && beerError < 1e-5f;
+	printf(ok ? "kernels match\n" : "kernels DO NOT match\n");
+	return ok;
+}
+
+void* AlignedMalloc(size_t size)
+{
+	//ҪARENA_ALIGNֽ,ĵַǰmallocصԭʼַ
+	byte* raw = (byte*)malloc(size + ARENA_ALIGN + sizeof(void*));
+	if (!raw)
+	{
+		return NULL;
+	}
+	byte* p = (byte*)(((size_t)(raw + sizeof(void*)) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1));
+	((void**)p)[-1] = raw;
+#ifndef HEAP_COUNTING
+#pragma omp atomic
+	++heapAllocations;
+#endif
+	return p;
+}
+
+void AlignedFree(void* p)
+{
+	if (p)
+	{
+		free(((void**)p)[-1]);
+	}
+}
+
+#if defined(HEAP_COUNTING) && defined(__GLIBC__)
+//glibcԼmallocһ滻libc,ֻ,ķ仹ǽlibc
+//ڴ滹libcֵ,freemalloc_usable_sizeû
+void* malloc(size_t size)
+{
+	__sync_fetch_and_add(&heapAllocations, 1);
+	return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+	__sync_fetch_and_add(&heapAllocations, 1);
+	return __libc_calloc(count, size);
+}
+
+void* realloc(void* p, size_t size)
+{
+	__sync_fetch_and_add(&heapAllocations, 1);
+	return __libc_realloc(p, size);
+}
+
+void* memalign(size_t alignment, size_t size)
+{
+	__sync_fetch_and_add(&heapAllocations, 1);
+	return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+	return memalign(alignment, size);
+}
+
+int posix_memalign(void** p, size_t alignment, size_t size)
+{
+	//2,sizeof(void*)ı
+	if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+	{
+		return EINVAL;
+	}
+	void* q = memalign(alignment, size);
+	if (!q)
+	{
+		return ENOMEM;
+	}
+	*p = q;
+	return 0;
+}
+#elif defined(HEAP_COUNTING)
+int AllocHook(int allocType, void* userData, size_t size, int blockType, long requestNumber, const unsigned char* filename, int lineNumber)
+{
+	//ﲻܵûڴCRT,ֻ;_HOOK_ALLOC_HOOK_REALLOC
+	(void)userData; (void)size; (void)blockType; (void)requestNumber; (void)filename; (void)lineNumber;
+	if (allocType != _HOOK_FREE)
+	{
+#pragma omp atomic
+		++heapAllocations;
+	}
+	return 1;
+}
+#endif
+
+void* ArenaAlloc(Arena* a, size_t size)
+{
+	if (!a->base)
+	{
+		ArenaReserve(a, ARENA_INITIAL);
+	}
+
+	size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+	void* p;
+	if (a->used + size <= a->capacity)
+	{
+		p = a->base + a->used;
+		a->used += size;
+	}
+	else
+	{
+		//鲻:һ;ٷ䲻ڴûȾ
+		ArenaBlock* block = (ArenaBlock*)AlignedMalloc(ARENA_ALIGN + size);
+		if (!block)
+		{
+			printf("out of memory: %.1fMB\n", (ARENA_ALIGN + size) / 1048576.0);
+			exit(1);
+		}
+		block->next = a->blocks;
+		block->position = a->used + a->overflow;
+		block->size = size;
+		a->blocks = block;
+		a->overflow += size;
+		p = (byte*)block + ARENA_ALIGN;
+	}
+	if (a->used + a->overflow > a->peak)
+	{
+		a->peak = a->used + a->overflow;
+	}
+	return p;
+}
+
+size_t ArenaMark(Arena* a)
+{
+	//λ,ֻ
+	return a->used + a->overflow;
+}
+
+void ArenaRelease(Arena* a, size_t mark)
+{
+	//mark֮鶼ͷŵ,ʣµ,˻صӦλ
+	while (a->blocks && a->blocks->position >= mark)
+	{
+		ArenaBlock* next = a->blocks->next;
+		a->overflow -= a->blocks->size;
+		AlignedFree(a->blocks);
+		a->blocks = next;
+	}
+	a->used = mark - a->overflow;
+
+	//ȫ˻ʱû,ֵ˵ù,ֵ·,Ժ󶼹
+	if (mark == 0)
+	{
+		ArenaReserve(a, a->peak);
+	}
+}
+
+void ArenaReset(Arena* a)
+{
+	ArenaRelease(a, 0);
+}
+
+void ArenaReserve(Arena* a, size_t capacity)
+{
+	//ֻarenaȫʱ;¿ʧܾͼþɵ,ŲµĲ
+	if (capacity <= a->capacity || a->used != 0 || a->blocks)
+	{
+		return;
+	}
+	byte* base = (byte*)AlignedMalloc(capacity);
+	if (base)
+	{
+		AlignedFree(a->base);
+		a->base = base;
+		a->capacity = capacity;
+	}
+}
+
+void AllocRays(Arena* a, RayBatch* rays, int n)
+{
+	float** fields[] = { &rays->ox, &rays->oy, &rays->dx, &rays->dy, &rays->wr, &rays->wg, &rays->wb };
+	for (int i = 0; i < (int)(sizeof(fields) / sizeof(fields[0])); ++i)
+	{
+		*fields[i] = (float*)ArenaAlloc(a, (size_t)n * sizeof(float));
+	}
+	rays->pixel = (int*)ArenaAlloc(a, (size_t)n * sizeof(int));
+	rays->count = 0;
+	rays->capacity = n;
+}
+
+void AllocHits(Arena* a, HitBatch* hits, int n)
+{
+	float** fields[] =
+	{
+		&hits->x, &hits->y, &hits->dx, &hits->dy, &hits->nx, &hits->ny,
+		&hits->reflectivity, &hits->eta, &hits->etai, &hits->etat, &hits->ratio, &hits->distance,
+		&hits->ar, &hits->ag, &hits->ab, &hits->er, &hits->eg, &hits->eb,
+		&hits->wr, &hits->wg, &hits->wb,
+		&hits->tr, &hits->tg, &hits->tb, &hits->rx, &hits->ry, &hits->tx, &hits->ty,
+		&hits->cosi, &hits->cost, &hits->fresnel,
+	};
+	for (int i = 0; i < (int)(sizeof(fields) / sizeof(fields[0])); ++i)
+	{
+		*fields[i] = (float*)ArenaAlloc(a, (size_t)n * sizeof(float));
+	}
+	hits->pixel = (int*)ArenaAlloc(a, (size_t)n * sizeof(int));
+	hits->refracted = (int*)ArenaAlloc(a, (size_t)n * sizeof(int));
+	hits->count = 0;
+	hits->capacity = n;
+}
+
+void RenderScalar(Color* out)
+{
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			unsigned int seed = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+			out[y * WIDTH + x] = Sample((float)x / WIDTH, (float)y / HEIGHT, &seed);
+		}
+	}
+}
+
+void WriteImage(const Color* c, const char* path)
+{
+	byte* p = image;
+	for (int i = 0; i < WIDTH * HEIGHT; ++i)
+	{
+		p[0] = (int)(fminf(c[i].r * 255.0f, 255.0f));
+		p[1] = (int)(fminf(c[i].g * 255.0f, 255.0f));
+		p[2] = (int)(fminf(c[i].b * 255.0f, 255.0f));
+		p += RGB;
+	}
+
+	FILE* fp = fopen(path, "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / LIGHT_COUNT);
+}
+
+#include "sdf.inc"
+#include "trace.inc"
+
+TraceResult Scene(float x, float y)
+{
+	TraceResult a = { CircleSDF(x, y, 0.5f, -0.2f, 0.1f), 0.0f, 0.0f,{ 10.0f, 10.0f, 10.0f }, COLOR_BLACK };
+	//babsorptionrgb(4,4,1),ʾrg,ʾɫɫ
+	TraceResult b = { NgonSDF(x, y, 0.5f, 0.5f, 0.25f, 5.0f), 0.0f, 1.5f, COLOR_BLACK,  { 4.0f, 4.0f, 1.0f } };
+
+
+	return Union(a, b);
+}
+
+//
+//
+////DOC:
+////ɫ
+//Traceǵݹ,ÿֻһߵReflect/Refract/Fresnel/BeerLambert,ָ,û
+//ﻻɰеĲǰ:
+//1.һصй(WIDTH*LIGHT_COUNT)RayBatchһ𲽽,еļǵHitBatch,SoA
+//2.BeerLambertBatchһе͸,Էȥӵ,ܼ׷ٵļ¼÷
+//3.ShadeBatchεRefractBatchFresnelBatchReflectBatch,TraceһıһĹߺȨ
+//4.һٻص1,ֱûй
+//˺SSE2һδ4¼,expfcephesĶʽ,4βֱӵԭı,
+//ûSSE2ʱȫ߱;BatchShadeMain -checkĸ˺ͱȽ,ٺ͵ݹTraceȾȽ
+////ÿ֡Է
+//ߺм¼ÿһСһ,ÿmalloc/freeڶ߳»Ƭ
+//1.ÿ߳һArena(threadprivate),ֻǰusedƲ뵽ARENA_ALIGN,һ˻صпʼλ
+//2.Ųʱ,˻ʱһͷ;ȫ˻(ÿн֡ArenaReset)ʱֵַ,
+//  Ͱֵ·;Ƕ̬ȵ,֡ʱ̵߳ͳһǸֵ,֮ٷ
+//3.peak¼ֵ,ÿ֡ӡ̵߳ķֵС
+//4.-checkȾCHECK_FRAMES֡,һ֡Ժÿһ֡Ķѷ0ķ:
+//  glibc±Լmalloc/calloc/realloc/memalign/aligned_alloc/posix_memalign,󽻸__libc_malloc,
+//  libgompstdioķҲõ;MSVC԰_CrtSetAllocHook;ƽֻ̨AlignedMalloc
@@ -124,66 +124,7 @@ Color Sample(float x, float y)
 	return ColorScale(sum, 1.0f / LIGHT_COUNT);
 }
 
-float CircleSDF(float x, float y, float cx, float cy, float radius)
-{
-	float dx = x - cx;
-	float dy = y - cy;
-	return sqrtf(dx * dx + dy * dy) - radius;
-}
-
-float PlaneSDF(float x, float y, float px, float py, float nx, float ny)
-{
-	return (x - px) * nx + (y - py) * ny;
-}
-
-float SegmentSDF(float x, float y, float ax, float ay, float bx, float by)
-{
-	float vx = x - ax, vy = y - ay;
-	float ux = bx - ax, uy = by - ay;
-	float dot = vx * ux + vy * uy;
-	float t = fmaxf(fminf(dot / (ux * ux + uy * uy), 1.0f), 0.0f);
-	float dx = vx - ux * t, dy = vy - uy * t;
-
-	return sqrtf(dx * dx + dy * dy);
-}
-
-float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius)
-{
-	return SegmentSDF(x, y, ax, ay, bx, by) - radius;
-}
-
-float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy)
-{
-	float costheta = cosf(theta);
-	float sintheta = sinf(theta);
-
-	//任,任Boxľֲϵ  ת+ƽ
-	float dx = fabsf((x - ox) * costheta + (y - oy) * sintheta) - sx;
-	float dy = fabsf((y - oy) * costheta - (x - ox) * sintheta) - sy;
-
-	float ax = fmaxf(dx, 0.0f);
-	float ay = fmaxf(dy, 0.0f);
-
-	return fminf(fmaxf(dx, dy), 0.0f) + sqrtf(ax * ax + ay * ay);
-}
-
-float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy)
-{
-	float d = fminf(fminf(SegmentSDF(x, y, ax, ay, bx, by), SegmentSDF(x, y, bx, by, cx, cy)),
-		SegmentSDF(x, y, cx, cy, ax, ay));
-
-	return  (bx - ax) * (y - ay) > (by - ay) * (x - ax) &&
-		(cx - bx) * (y - by) > (cy - by) * (x - bx) &&
-		(ax - cx) * (y - cy) > (ay - cy) * (x - cx) ? -d : d;
-}
-
-float NgonSDF(float x, float y, float cx, float cy, float r, float n)
-{
-	float ux = x - cx, uy = y - cy, a = TWO_PI / n;
-	float t = fmodf(atan2f(uy, ux) + TWO_PI, a), s = sqrtf(ux * ux + uy * uy);
-	return PlaneSDF(s * cosf(t), s * sinf(t), r, 0.0f, cosf(a * 0.5f), sinf(a * 0.5f));
-
-}
+#include "sdf.inc"
 
 Color Trace(float ox, float oy, float dx, float dy, int depth)
 {
@@ -302,29 +243,6 @@ TraceResult Scene(float x, float y)
 
 	return Union(a, b);
 }
-
-TraceResult Union(TraceResult lhs, TraceResult rhs)
-{
-	return lhs.sdf < rhs.sdf ? lhs : rhs;
-}
-
-TraceResult Intersec(TraceResult lhs, TraceResult rhs)
-{
-	TraceResult r = lhs;
-	Color emissive = lhs.sdf > rhs.sdf ? lhs.emissive : rhs.emissive;
-	float sdf = lhs.sdf > rhs.sdf ? lhs.sdf : rhs.sdf;
-
-	r.emissive = emissive;
-	r.sdf = sdf;
-	return r;
-}
-
-TraceResult Subtract(TraceResult lhs, TraceResult rhs)
-{
-	TraceResult r = lhs;
-	r.sdf = lhs.sdf > -rhs.sdf ? lhs.sdf : -rhs.sdf;
-	return r;
-}
 //
 //
 ////DOC:
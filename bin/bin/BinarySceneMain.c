@@ -0,0 +1,688 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdint.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//Ƴļ
+#define SCENE_MAGIC               "L2DS"
+#define SCENE_VERSION             (1)
+#define SCENE_ALIGN               (64)     //ÿһζж,mmapֱ֮ӵ
+#define SCENE_PATH                "strands.l2ds"
+
+//ļĸ,˳;ҵĲSoA,PreparedSceneĽһԤõĲ
+#define SECTION_AX                (0)
+#define SECTION_AY                (1)
+#define SECTION_UX                (2)      //b - a
+#define SECTION_UY                (3)
+#define SECTION_INV_LENGTH2       (4)      //1 / |b - a|^2
+#define SECTION_RADIUS            (5)
+#define SECTION_MATERIAL          (6)      //ÿҵĲʱ
+#define SECTION_MATERIAL_TABLE    (7)      //TraceResult,ȫfloat
+#define SECTION_CELL_START        (8)      //,iĽcellIndex[cellStart[i]...cellStart[i+1]-1]
+#define SECTION_CELL_INDEX        (9)
+#define SECTION_COUNT             (10)
+
+//ɵĳ:ܶϸ,ÿһ
+#define DEFAULT_STRANDS           (10000)
+#define STRAND_SEGMENTS           (20)
+#define CELL_CAPSULES             (2)      //Сƽÿôѡ
+#define MAX_SEARCH_RING           (8)      //ҼȦ
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+//ļͷļͷ,жֽڵֵС
+typedef struct
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t capsuleCount, materialCount;
+	uint32_t gridX, gridY, cellIndexCount, reserved;
+	float minX, minY, cellSize, maxRadius;
+	uint64_t fileSize;
+	uint64_t offset[SECTION_COUNT];  //ÿһļͷƫ,SCENE_ALIGNı
+} SceneHeader;
+
+//ɵĳָmalloc,򿪵ĳֱָӳڴ,ֻ
+typedef struct
+{
+	SceneHeader h;
+	float *ax, *ay, *ux, *uy, *invLength2, *radius;
+	uint32_t* material;
+	TraceResult* materials;
+	uint32_t *cellStart, *cellIndex;
+} SceneData;
+
+typedef struct
+{
+	void* data;
+	size_t size;
+#ifdef _WIN32
+	HANDLE file, mapping;
+#endif
+} MappedFile;
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+byte image[WIDTH * HEIGHT * RGB];
+
+SceneData scene;
+
+TraceResult strandMaterials[] =
+{
+	{ 0.0f, 0.0f, 0.0f, { 3.0f, 1.8f, 0.8f }, COLOR_BLACK },        //ůɫĹ
+	{ 0.0f, 0.0f, 0.0f, { 0.6f, 1.2f, 3.0f }, COLOR_BLACK },        //ɫĹ
+	{ 0.0f, 0.0f, 0.0f, COLOR_BLACK, COLOR_BLACK },                 //
+	{ 0.0f, 0.8f, 0.0f, COLOR_BLACK, COLOR_BLACK },                 //
+};
+
+TraceResult Scene(float x, float y);
+
+Color Sample(float x, float y, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+void GenerateScene(SceneData* s, int strands);
+
+void BuildGrid(SceneData* s);
+
+int WriteScene(const char* path, SceneData* s);
+
+int MapFile(const char* path, MappedFile* m);
+
+void UnmapFile(MappedFile* m);
+
+int OpenScene(const MappedFile* m, SceneData* s);
+
+int VerifyScene(const SceneData* s);
+
+int main(int argc, char* argv[])
+{
+	//BinarySceneMain -generate [] [ļ] : ɳ,,дɶļ
+	//BinarySceneMain [ļ] [-verify]             : mmap򿪳Ⱦ,-verify±ǷԽ
+	if (argc > 1 && strcmp(argv[1], "-generate") == 0)
+	{
+		int strands = argc > 2 ? atoi(argv[2]) : DEFAULT_STRANDS;
+		const char* path = argc > 3 ? argv[3] : SCENE_PATH;
+		double start = Now();
+		GenerateScene(&scene, strands);
+		double generated = Now();
+		BuildGrid(&scene);
+		double built = Now();
+		if (!WriteScene(path, &scene))
+		{
+			printf("can not write %s\n", path);
+			return 1;
+		}
+		printf("%u capsules: generate %.3fs, grid %ux%u with %u entries %.3fs, write %.3fs, %.1f MB\n",
+			scene.h.capsuleCount, generated - start, scene.h.gridX, scene.h.gridY, scene.h.cellIndexCount,
+			built - generated, Now() - built, scene.h.fileSize / 1048576.0);
+		return 0;
+	}
+
+	const char* path = SCENE_PATH;
+	int verify = 0;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-verify") == 0)
+		{
+			verify = 1;
+		}
+		else
+		{
+			path = argv[i];
+		}
+	}
+
+	MappedFile file;
+	double start = Now();
+	if (!MapFile(path, &file))
+	{
+		printf("can not map %s, run BinarySceneMain -generate first\n", path);
+		return 1;
+	}
+	if (!OpenScene(&file, &scene))
+	{
+		printf("%s is not a version %d scene file\n", path, SCENE_VERSION);
+		UnmapFile(&file);
+		return 1;
+	}
+	printf("mapped %s: %u capsules, %.1f MB in %.3f ms\n", path, scene.h.capsuleCount, file.size / 1048576.0, (Now() - start) * 1000.0);
+	if (verify)
+	{
+		start = Now();
+		int ok = VerifyScene(&scene);
+		printf("verify: %s in %.3fs\n", ok ? "ok" : "FAILED", Now() - start);
+		if (!ok)
+		{
+			UnmapFile(&file);
+			return 1;
+		}
+	}
+
+	start = Now();
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			unsigned int s = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+			Color c = Sample((float)x / WIDTH, (float)y / HEIGHT, &s);
+			byte* p = &image[(y * WIDTH + x) * RGB];
+			p[0] = (int)(fminf(c.r * 255.0f, 255.0f));
+			p[1] = (int)(fminf(c.g * 255.0f, 255.0f));
+			p[2] = (int)(fminf(c.b * 255.0f, 255.0f));
+		}
+	}
+	printf("render: %.2fs\n", Now() - start);
+	UnmapFile(&file);
+
+	FILE* fp = fopen("..//..//png//binary_scene.png", "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+	printf("Svnpng Success\n");
+	return 0;
+}
+
+void GenerateScene(SceneData* s, int strands)
+{
+	//ÿߴλó,һƫת
+	unsigned int n = (unsigned int)strands * STRAND_SEGMENTS;
+	memset(&s->h, 0, sizeof(s->h));
+	s->h.capsuleCount = n;
+	s->h.materialCount = sizeof(strandMaterials) / sizeof(strandMaterials[0]);
+	s->ax = (float*)malloc(sizeof(float) * n);
+	s->ay = (float*)malloc(sizeof(float) * n);
+	s->ux = (float*)malloc(sizeof(float) * n);
+	s->uy = (float*)malloc(sizeof(float) * n);
+	s->invLength2 = (float*)malloc(sizeof(float) * n);
+	s->radius = (float*)malloc(sizeof(float) * n);
+	s->material = (uint32_t*)malloc(sizeof(uint32_t) * n);
+	s->materials = strandMaterials;
+
+	unsigned int seed = 20170801u;
+	unsigned int k = 0;
+	for (int i = 0; i < strands; ++i)
+	{
+		float x = 0.05f + 0.9f * Random(&seed), y = 0.05f + 0.9f * Random(&seed);
+		float angle = TWO_PI * Random(&seed);
+		float radius = 0.0003f + 0.0005f * Random(&seed);
+		float m = Random(&seed);
+		uint32_t material = m < 0.04f ? 0 : m < 0.08f ? 1 : m < 0.9f ? 2 : 3;
+		for (int j = 0; j < STRAND_SEGMENTS; ++j, ++k)
+		{
+			angle += (Random(&seed) - 0.5f) * 0.6f;
+			float ux = cosf(angle) * 0.003f, uy = sinf(angle) * 0.003f;
+			s->ax[k] = x;
+			s->ay[k] = y;
+			s->ux[k] = ux;
+			s->uy[k] = uy;
+			s->invLength2[k] = 1.0f / (ux * ux + uy * uy);
+			s->radius[k] = radius;
+			s->material[k] = material;
+			x += ux;
+			y += uy;
+		}
+	}
+}
+
+void CapsuleCells(const SceneData* s, uint32_t k, int* x0, int* y0, int* x1, int* y1)
+{
+	//ҵİΧиǵĸ,ұһЩ
+	const SceneHeader* h = &s->h;
+	float r = s->radius[k];
+	float bx = s->ax[k] + s->ux[k], by = s->ay[k] + s->uy[k];
+	*x0 = (int)((fminf(s->ax[k], bx) - r - h->minX) / h->cellSize);
+	*y0 = (int)((fminf(s->ay[k], by) - r - h->minY) / h->cellSize);
+	*x1 = (int)((fmaxf(s->ax[k], bx) + r - h->minX) / h->cellSize);
+	*y1 = (int)((fmaxf(s->ay[k], by) + r - h->minY) / h->cellSize);
+	*x0 = *x0 < 0 ? 0 : *x0;
+	*y0 = *y0 < 0 ? 0 : *y0;
+	*x1 = *x1 >= (int)h->gridX ? (int)h->gridX - 1 : *x1;
+	*y1 = *y1 >= (int)h->gridY ? (int)h->gridY - 1 : *y1;
+}
+
+void BuildGrid(SceneData* s)
+{
+	SceneHeader* h = &s->h;
+	float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+	h->maxRadius = 0.0f;
+	for (uint32_t k = 0; k < h->capsuleCount; ++k)
+	{
+		float r = s->radius[k];
+		float bx = s->ax[k] + s->ux[k], by = s->ay[k] + s->uy[k];
+		minX = fminf(minX, fminf(s->ax[k], bx) - r);
+		minY = fminf(minY, fminf(s->ay[k], by) - r);
+		maxX = fmaxf(maxX, fmaxf(s->ax[k], bx) + r);
+		maxY = fmaxf(maxY, fmaxf(s->ay[k], by) + r);
+		h->maxRadius = fmaxf(h->maxRadius, r);
+	}
+
+	//Լǽ/CELL_CAPSULES
+	float width = maxX - minX, height = maxY - minY;
+	h->cellSize = sqrtf(width * height * CELL_CAPSULES / h->capsuleCount);
+	h->minX = minX;
+	h->minY = minY;
+	h->gridX = (uint32_t)(width / h->cellSize) + 1;
+	h->gridY = (uint32_t)(height / h->cellSize) + 1;
+
+	//ÿм,ǰ׺͵õ,һ
+	uint32_t cellCount = h->gridX * h->gridY;
+	s->cellStart = (uint32_t*)calloc(cellCount + 1, sizeof(uint32_t));
+	for (uint32_t k = 0; k < h->capsuleCount; ++k)
+	{
+		int x0, y0, x1, y1;
+		CapsuleCells(s, k, &x0, &y0, &x1, &y1);
+		for (int y = y0; y <= y1; ++y)
+		{
+			for (int x = x0; x <= x1; ++x)
+			{
+				++s->cellStart[y * h->gridX + x + 1];
+			}
+		}
+	}
+	for (uint32_t i = 0; i < cellCount; ++i)
+	{
+		s->cellStart[i + 1] += s->cellStart[i];
+	}
+	h->cellIndexCount = s->cellStart[cellCount];
+
+	uint32_t* cursor = (uint32_t*)malloc(sizeof(uint32_t) * cellCount);
+	memcpy(cursor, s->cellStart, sizeof(uint32_t) * cellCount);
+	s->cellIndex = (uint32_t*)malloc(sizeof(uint32_t) * h->cellIndexCount);
+	for (uint32_t k = 0; k < h->capsuleCount; ++k)
+	{
+		int x0, y0, x1, y1;
+		CapsuleCells(s, k, &x0, &y0, &x1, &y1);
+		for (int y = y0; y <= y1; ++y)
+		{
+			for (int x = x0; x <= x1; ++x)
+			{
+				s->cellIndex[cursor[y * h->gridX + x]++] = k;
+			}
+		}
+	}
+	free(cursor);
+}
+
+uint64_t SectionSize(const SceneHeader* h, int section)
+{
+	switch (section)
+	{
+	case SECTION_MATERIAL_TABLE:
+		return (uint64_t)h->materialCount * sizeof(TraceResult);
+	case SECTION_CELL_START:
+		return ((uint64_t)h->gridX * h->gridY + 1) * sizeof(uint32_t);
+	case SECTION_CELL_INDEX:
+		return (uint64_t)h->cellIndexCount * sizeof(uint32_t);
+	default:
+		return (uint64_t)h->capsuleCount * 4;  //ҵĲͲʱŶ4ֽ
+	}
+}
+
+uint64_t AlignUp(uint64_t x)
+{
+	return (x + SCENE_ALIGN - 1) & ~(uint64_t)(SCENE_ALIGN - 1);
+}
+
+int WriteScene(const char* path, SceneData* s)
+{
+	const void* data[SECTION_COUNT] =
+	{
+		s->ax, s->ay, s->ux, s->uy, s->invLength2, s->radius, s->material, s->materials, s->cellStart, s->cellIndex
+	};
+	SceneHeader* h = &s->h;
+	memcpy(h->magic, SCENE_MAGIC, 4);
+	h->version = SCENE_VERSION;
+	uint64_t offset = AlignUp(sizeof(SceneHeader));
+	for (int i = 0; i < SECTION_COUNT; ++i)
+	{
+		h->offset[i] = offset;
+		offset = AlignUp(offset + SectionSize(h, i));
+	}
+	h->fileSize = offset;
+
+	FILE* fp = fopen(path, "wb");
+	if (!fp)
+	{
+		return 0;
+	}
+	static const char zero[SCENE_ALIGN];
+	fwrite(h, sizeof(SceneHeader), 1, fp);
+	uint64_t written = sizeof(SceneHeader);
+	for (int i = 0; i < SECTION_COUNT; ++i)
+	{
+		fwrite(zero, 1, (size_t)(h->offset[i] - written), fp);
+		fwrite(data[i], 1, (size_t)SectionSize(h, i), fp);
+		written = h->offset[i] + SectionSize(h, i);
+	}
+	fwrite(zero, 1, (size_t)(h->fileSize - written), fp);
+	int ok = ferror(fp) == 0;
+	fclose(fp);
+	return ok;
+}
+
+int MapFile(const char* path, MappedFile* m)
+{
+	//ֻӳ:̴ͬһʱҳͬһ
+#ifdef _WIN32
+	LARGE_INTEGER size;
+	m->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m->file == INVALID_HANDLE_VALUE)
+	{
+		return 0;
+	}
+	if (!GetFileSizeEx(m->file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(m->file);
+		return 0;
+	}
+	m->size = (size_t)size.QuadPart;
+	m->mapping = CreateFileMappingA(m->file, NULL, PAGE_READONLY, 0, 0, NULL);
+	m->data = m->mapping ? MapViewOfFile(m->mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+	if (!m->data)
+	{
+		if (m->mapping)
+		{
+			CloseHandle(m->mapping);
+		}
+		CloseHandle(m->file);
+		return 0;
+	}
+	return 1;
+#else
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return 0;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		close(fd);
+		return 0;
+	}
+	m->size = (size_t)st.st_size;
+	m->data = mmap(NULL, m->size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (m->data == MAP_FAILED)
+	{
+		m->data = NULL;
+		return 0;
+	}
+	return 1;
+#endif
+}
+
+void UnmapFile(MappedFile* m)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(m->data);
+	CloseHandle(m->mapping);
+	CloseHandle(m->file);
+#else
+	munmap(m->data, m->size);
+#endif
+	m->data = NULL;
+}
+
+int OpenScene(const MappedFile* m, SceneData* s)
+{
+	//ֻļͷ͸ελ,ݱ,򿪵ʱͳС޹
+	const byte* base = (const byte*)m->data;
+	if (m->size < sizeof(SceneHeader))
+	{
+		return 0;
+	}
+	memcpy(&s->h, base, sizeof(SceneHeader));
+	const SceneHeader* h = &s->h;
+	if (memcmp(h->magic, SCENE_MAGIC, 4) != 0 || h->version != SCENE_VERSION || h->fileSize != m->size ||
+		h->capsuleCount == 0 || h->gridX == 0 || h->gridY == 0 || !(h->cellSize > 0.0f))
+	{
+		return 0;
+	}
+	for (int i = 0; i < SECTION_COUNT; ++i)
+	{
+		if (h->offset[i] % SCENE_ALIGN != 0 || h->offset[i] < sizeof(SceneHeader) || h->offset[i] + SectionSize(h, i) > m->size)
+		{
+			return 0;
+		}
+	}
+
+	s->ax = (float*)(base + h->offset[SECTION_AX]);
+	s->ay = (float*)(base + h->offset[SECTION_AY]);
+	s->ux = (float*)(base + h->offset[SECTION_UX]);
+	s->uy = (float*)(base + h->offset[SECTION_UY]);
+	s->invLength2 = (float*)(base + h->offset[SECTION_INV_LENGTH2]);
+	s->radius = (float*)(base + h->offset[SECTION_RADIUS]);
+	s->material = (uint32_t*)(base + h->offset[SECTION_MATERIAL]);
+	s->materials = (TraceResult*)(base + h->offset[SECTION_MATERIAL_TABLE]);
+	s->cellStart = (uint32_t*)(base + h->offset[SECTION_CELL_START]);
+	s->cellIndex = (uint32_t*)(base + h->offset[SECTION_CELL_INDEX]);
+	return 1;
+}
+
+int VerifyScene(const SceneData* s)
+{
+	//Ҫһļ,ֻڻļ˵ʱ
+	const SceneHeader* h = &s->h;
+	uint32_t cellCount = h->gridX * h->gridY;
+	if (s->cellStart[0] != 0 || s->cellStart[cellCount] != h->cellIndexCount)
+	{
+		return 0;
+	}
+	for (uint32_t i = 0; i < cellCount; ++i)
+	{
+		if (s->cellStart[i] > s->cellStart[i + 1])
+		{
+			return 0;
+		}
+	}
+	for (uint32_t i = 0; i < h->cellIndexCount; ++i)
+	{
+		if (s->cellIndex[i] >= h->capsuleCount)
+		{
+			return 0;
+		}
+	}
+	for (uint32_t k = 0; k < h->capsuleCount; ++k)
+	{
+		if (s->material[k] >= h->materialCount)
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+TraceResult Scene(float x, float y)
+{
+	const SceneHeader* h = &scene.h;
+	int gx = (int)h->gridX, gy = (int)h->gridY;
+
+	//񳬹һʱ,ľһ㹻õ½,߲ߵ
+	float ox = fmaxf(fmaxf(h->minX - x, x - (h->minX + gx * h->cellSize)), 0.0f);
+	float oy = fmaxf(fmaxf(h->minY - y, y - (h->minY + gy * h->cellSize)), 0.0f);
+	float outside = sqrtf(ox * ox + oy * oy);
+	if (outside > h->cellSize)
+	{
+		TraceResult r = scene.materials[0];
+		r.sdf = outside;
+		return r;
+	}
+
+	//ӵڵĸӿʼһȦһȦ,ʹĸӿʼ
+	int cx = (int)floorf((x - h->minX) / h->cellSize), cy = (int)floorf((y - h->minY) / h->cellSize);
+	cx = cx < 0 ? 0 : cx >= gx ? gx - 1 : cx;
+	cy = cy < 0 ? 0 : cy >= gy ? gy - 1 : cy;
+
+	float best = 1e30f;
+	uint32_t bestMaterial = 0;
+	int ring;
+	for (ring = 0; ring < MAX_SEARCH_RING; ++ring)
+	{
+		for (int j = cy - ring; j <= cy + ring; ++j)
+		{
+			if (j < 0 || j >= gy)
+			{
+				continue;
+			}
+			//һкһжһȦ,мֻ˵ĸ
+			int step = j == cy - ring || j == cy + ring ? 1 : 2 * ring;
+			for (int i = cx - ring; i <= cx + ring; i += step)
+			{
+				if (i < 0 || i >= gx)
+				{
+					continue;
+				}
+				uint32_t cell = (uint32_t)(j * gx + i);
+				for (uint32_t c = scene.cellStart[cell]; c < scene.cellStart[cell + 1]; ++c)
+				{
+					uint32_t k = scene.cellIndex[c];
+					float vx = x - scene.ax[k], vy = y - scene.ay[k];
+					float t = fmaxf(fminf((vx * scene.ux[k] + vy * scene.uy[k]) * scene.invLength2[k], 1.0f), 0.0f);
+					float dx = vx - scene.ux[k] * t, dy = vy - scene.uy[k] * t;
+					float d = sqrtf(dx * dx + dy * dy) - scene.radius[k];
+					if (d < best)
+					{
+						best = d;
+						bestMaterial = scene.material[k];
+					}
+				}
+			}
+		}
+		if (best <= ring * h->cellSize)
+		{
+			break;
+		}
+	}
+	//տĵطҲʱ,ûҹĸMAX_SEARCH_RING-1,½,ֻǲСһ
+	if (ring == MAX_SEARCH_RING)
+	{
+		best = fminf(best, (MAX_SEARCH_RING - 1) * h->cellSize);
+	}
+
+	TraceResult r = scene.materials[bestMaterial];
+	r.sdf = best;
+	return r;
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / LIGHT_COUNT);
+}
+
+#include "trace.inc"
+//
+//
+////DOC:
+////Ƴļ
+//ɵĳʮ,ÿɡٽṹ,̵ȾʱȾ
+//ѳһļ,ʱֱmmap,Ҳ:
+//1.ļͷSceneHeaderŰ汾͸εƫ,ÿΰSCENE_ALIGN,ӳֱ֮ӵ
+//2.ҲSoAԤõĲ(㡢ƽĵ뾶),PreparedSceneĽһ;
+//  ʱŵһ,ʱTraceResult
+//3.ٽṹǽõľ,ÿҵǼΧиǵĸ
+//4.OpenSceneֻļͷ͸ελ,,ʱͳС޹;ҳڵһηʱŴӴ̶,
+//  ӳֻ,ͬʱȾͬһʱҳ;-verifyһ±Խ
+//5.SceneֵڵĸһȦһȦĽ,rȦ,ûҹĸr,
+//  Ѿҵľ벻ֵͿͣ;MAX_SEARCH_RINGȦ,ûҵͷ½,
+//  һĵֱӷصľ,Թ߲˵ֻǲСһ
+//BinarySceneMain -generate [] [ļ] ɳļ,BinarySceneMain [ļ] 򿪲Ⱦ
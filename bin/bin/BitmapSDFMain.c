@@ -0,0 +1,678 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define USE_SSE2
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//任
+#define MASK_MAX_SIZE             (16384)  //зľ16λ,ܳDISTANCE_INFINITY
+#define DISTANCE_INFINITY         (32767)  //һûҪҵ
+#define COLUMN_STRIP              (256)    //ɨ谴ôָ߳
+#define MAZE_MASK_SIZE            (1024)
+#define MAZE_CELLS                (8)
+#define RING_MASK_SIZE            (256)
+#define BENCH_SIZE                (8192)   //-benchĬϵͼС
+#define VERIFY_SIZE               (384)    //ͱԱõͼС
+#define VERIFY_PIXELS             (2000)
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+//SDF:ֵΪλ,(i, j)(i + 0.5, j + 0.5);
+//ͼϽǷڳ(x0, y0),ÿصı߳scale
+typedef struct
+{
+	int width, height;
+	float* sdf;
+	float x0, y0, scale;
+} DistanceField;
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+byte image[WIDTH * HEIGHT * RGB];
+
+DistanceField occluder, emitter;
+
+TraceResult Scene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+byte* LoadPGM(const char* path, int* width, int* height);
+
+byte* MakeMazeMask(int size);
+
+byte* MakeRingMask(int size);
+
+byte* MakeBlobMask(int size);
+
+void DistanceTransform(const byte* mask, int width, int height, float* sdf);
+
+float BruteDistance(const byte* mask, int width, int height, int x, int y);
+
+int MakeField(DistanceField* f, byte* mask, int width, int height, float x0, float y0, float size);
+
+float SampledSDF(const DistanceField* f, float x, float y);
+
+int Bench(int size);
+
+int main(int argc, char* argv[])
+{
+	//BitmapSDFMain [ڵ.pgm] : ûиļʱóɵԹ
+	//BitmapSDFMain -bench [С] : ȺͱԱ,ٲͼľ任ʱ
+	if (argc > 1 && strcmp(argv[1], "-bench") == 0)
+	{
+		return Bench(argc > 2 ? atoi(argv[2]) : BENCH_SIZE);
+	}
+
+	int width = MAZE_MASK_SIZE, height = MAZE_MASK_SIZE;
+	byte* mask = NULL;
+	if (argc > 1)
+	{
+		mask = LoadPGM(argv[1], &width, &height);
+		if (!mask)
+		{
+			printf("can not load %s, expecting an 8-bit P5 or P2 pgm up to %d pixels wide\n", argv[1], MASK_MAX_SIZE);
+			return 1;
+		}
+	}
+	else
+	{
+		mask = MakeMazeMask(width);
+	}
+
+	double start = Now();
+	int ok = MakeField(&occluder, mask, width, height, 0.2f, 0.2f, 0.6f) &&
+		MakeField(&emitter, MakeRingMask(RING_MASK_SIZE), RING_MASK_SIZE, RING_MASK_SIZE, 0.0f, 0.0f, 0.22f);
+	if (!ok)
+	{
+		printf("out of memory\n");
+		return 1;
+	}
+	printf("distance fields %dx%d + %dx%d: %.3fs\n", width, height, RING_MASK_SIZE, RING_MASK_SIZE, Now() - start);
+
+	start = Now();
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			unsigned int s = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+			Color c = Sample((float)x / WIDTH, (float)y / HEIGHT, &s);
+			byte* p = &image[(y * WIDTH + x) * RGB];
+			p[0] = (int)(fminf(c.r * 255.0f, 255.0f));
+			p[1] = (int)(fminf(c.g * 255.0f, 255.0f));
+			p[2] = (int)(fminf(c.b * 255.0f, 255.0f));
+		}
+	}
+	printf("render: %.2fs\n", Now() - start);
+
+	FILE* fp = fopen("..//..//png//bitmap_sdf.png", "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+	free(occluder.sdf);
+	free(emitter.sdf);
+	printf("Svnpng Success\n");
+	return 0;
+}
+
+int Bench(int size)
+{
+	if (size < 2 || size > MASK_MAX_SIZE)
+	{
+		printf("size must be in [2, %d]\n", MASK_MAX_SIZE);
+		return 1;
+	}
+
+	//СͼغͱԱ,߶ͬһƽ,Ӧȫһ
+	byte* mask = MakeBlobMask(VERIFY_SIZE);
+	float* sdf = (float*)malloc(sizeof(float) * VERIFY_SIZE * VERIFY_SIZE);
+	DistanceTransform(mask, VERIFY_SIZE, VERIFY_SIZE, sdf);
+	int mismatch = 0;
+	unsigned int seed = 12345u;
+	for (int i = 0; i < VERIFY_PIXELS; ++i)
+	{
+		int x = (int)(Random(&seed) * VERIFY_SIZE), y = (int)(Random(&seed) * VERIFY_SIZE);
+		mismatch += sdf[y * VERIFY_SIZE + x] != BruteDistance(mask, VERIFY_SIZE, VERIFY_SIZE, x, y);
+	}
+	printf("verify %dx%d: %d of %d pixels differ from brute force\n", VERIFY_SIZE, VERIFY_SIZE, mismatch, VERIFY_PIXELS);
+	free(mask);
+	free(sdf);
+
+	mask = MakeBlobMask(size);
+	sdf = (float*)malloc(sizeof(float) * size * size);
+	if (!mask || !sdf)
+	{
+		printf("out of memory\n");
+		return 1;
+	}
+	double best = 1e30;
+	for (int i = 0; i < 3; ++i)
+	{
+		double start = Now();
+		DistanceTransform(mask, size, size, sdf);
+		double t = Now() - start;
+		best = t < best ? t : best;
+	}
+#ifdef _OPENMP
+	int threads = omp_get_max_threads();
+#else
+	int threads = 1;
+#endif
+	printf("distance transform %dx%d: %.3fs, %.1f Mpixel/s, %d threads\n", size, size, best, size * (double)size / best * 1e-6, threads);
+	free(mask);
+	free(sdf);
+	return mismatch != 0;
+}
+
+byte* LoadPGM(const char* path, int* width, int* height)
+{
+	//ֻ֧8λP5()P2(ı),ֵ1255,ֵһ״
+	FILE* fp = fopen(path, "rb");
+	if (!fp)
+	{
+		return NULL;
+	}
+	char magic[3] = { 0 };
+	int header[3] = { 0 }, n = 0;
+	if (fread(magic, 1, 2, fp) != 2 || magic[0] != 'P' || (magic[1] != '5' && magic[1] != '2'))
+	{
+		fclose(fp);
+		return NULL;
+	}
+	while (n < 3)
+	{
+		int c = fgetc(fp);
+		if (c == '#')
+		{
+			//ע͵β
+			while (c != '\n' && c != EOF)
+			{
+				c = fgetc(fp);
+			}
+		}
+		else if (c >= '0' && c <= '9')
+		{
+			ungetc(c, fp);
+			if (fscanf(fp, "%d", &header[n++]) != 1)
+			{
+				break;
+			}
+		}
+		else if (c == EOF)
+		{
+			break;
+		}
+	}
+	*width = header[0];
+	*height = header[1];
+	int maxval = header[2];
+	if (n < 3 || maxval < 1 || maxval > 255 || *width < 2 || *height < 2 || *width > MASK_MAX_SIZE || *height > MASK_MAX_SIZE)
+	{
+		fclose(fp);
+		return NULL;
+	}
+	fgetc(fp);  //ͷһհ
+
+	int count = *width * *height;
+	byte* mask = (byte*)malloc(count);
+	int ok = 1;
+	if (magic[1] == '5')
+	{
+		ok = mask && fread(mask, 1, count, fp) == (size_t)count;
+	}
+	else
+	{
+		for (int i = 0; ok && mask && i < count; ++i)
+		{
+			int v;
+			ok = fscanf(fp, "%d", &v) == 1 && v >= 0 && v <= maxval;
+			mask[i] = (byte)v;
+		}
+	}
+	fclose(fp);
+	if (!mask || !ok)
+	{
+		free(mask);
+		return NULL;
+	}
+	for (int i = 0; i < count; ++i)
+	{
+		mask[i] = mask[i] > maxval / 2 ? 255 : 0;
+	}
+	return mask;
+}
+
+byte* MakeMazeMask(int size)
+{
+	//MAZE_CELLS*MAZE_CELLSռͼ,֮һЩǽ,ǽǰ,Ȧ
+	byte* mask = (byte*)calloc(size * size, 1);
+	int cell = size / (MAZE_CELLS + 1), wall = cell / 10;
+	unsigned int seed = 20170801u;
+	for (int j = 0; j <= MAZE_CELLS; ++j)
+	{
+		for (int i = 0; i <= MAZE_CELLS; ++i)
+		{
+			//ÿҡ¸һǽ
+			int x = cell / 2 + i * cell, y = cell / 2 + j * cell;
+			if (i < MAZE_CELLS && Random(&seed) < 0.35f)
+			{
+				for (int v = y - wall; v <= y + wall; ++v)
+				{
+					memset(&mask[v * size + x - wall], 255, cell + 2 * wall + 1);
+				}
+			}
+			if (j < MAZE_CELLS && Random(&seed) < 0.35f)
+			{
+				for (int v = y - wall; v <= y + cell + wall; ++v)
+				{
+					memset(&mask[v * size + x - wall], 255, 2 * wall + 1);
+				}
+			}
+		}
+	}
+	return mask;
+}
+
+byte* MakeRingMask(int size)
+{
+	//ͬԲ,ɷ
+	byte* mask = (byte*)malloc(size * size);
+	for (int y = 0; y < size; ++y)
+	{
+		for (int x = 0; x < size; ++x)
+		{
+			float u = (x + 0.5f) / size - 0.5f, v = (y + 0.5f) / size - 0.5f;
+			float r = sqrtf(u * u + v * v);
+			mask[y * size + x] = r < 0.45f && fmodf(r, 0.15f) < 0.05f ? 255 : 0;
+		}
+	}
+	return mask;
+}
+
+byte* MakeBlobMask(int size)
+{
+	//Բ,
+	byte* mask = (byte*)calloc((size_t)size * size, 1);
+	if (!mask)
+	{
+		return NULL;
+	}
+	unsigned int seed = 12345u;
+	int count = 200;
+	for (int k = 0; k < count; ++k)
+	{
+		float cx = Random(&seed) * size, cy = Random(&seed) * size, r = (0.005f + 0.03f * Random(&seed)) * size;
+		int y0 = (int)fmaxf(cy - r, 0.0f), y1 = (int)fminf(cy + r, size - 1.0f);
+		int x0 = (int)fmaxf(cx - r, 0.0f), x1 = (int)fminf(cx + r, size - 1.0f);
+		for (int y = y0; y <= y1; ++y)
+		{
+			for (int x = x0; x <= x1; ++x)
+			{
+				float dx = x + 0.5f - cx, dy = y + 0.5f - cy;
+				if (dx * dx + dy * dy < r * r)
+				{
+					mask[(size_t)y * size + x] = 255;
+				}
+			}
+		}
+	}
+	return mask;
+}
+
+void ColumnPass(const byte* mask, int width, int height, int x0, int x1, unsigned short* gOut, unsigned short* gIn)
+{
+	//ÿһеǰ(gOut)ͱ(gIn)ľ,ͼ浱;
+	//д¡ٴɨ,ڲѭһ,SSE2һδ8
+	for (int y = 0; y < height; ++y)
+	{
+		const byte* m = &mask[(size_t)y * width];
+		unsigned short* o = &gOut[(size_t)y * width];
+		unsigned short* i = &gIn[(size_t)y * width];
+		int x = x0;
+#ifdef USE_SSE2
+		__m128i one = _mm_set1_epi16(1);
+		for (; x + 8 <= x1; x += 8)
+		{
+			__m128i po = y > 0 ? _mm_loadu_si128((const __m128i*)&o[x - width]) : _mm_set1_epi16(DISTANCE_INFINITY);
+			__m128i pi = y > 0 ? _mm_loadu_si128((const __m128i*)&i[x - width]) : _mm_setzero_si128();
+			//0255,Լչ16λȫ0ȫ1
+			__m128i mm = _mm_loadl_epi64((const __m128i*)&m[x]);
+			mm = _mm_unpacklo_epi8(mm, mm);
+			_mm_storeu_si128((__m128i*)&o[x], _mm_andnot_si128(mm, _mm_adds_epi16(po, one)));
+			_mm_storeu_si128((__m128i*)&i[x], _mm_and_si128(mm, _mm_adds_epi16(pi, one)));
+		}
+#endif
+		for (; x < x1; ++x)
+		{
+			int po = y > 0 ? o[x - width] : DISTANCE_INFINITY, pi = y > 0 ? i[x - width] : 0;
+			o[x] = m[x] ? 0 : (unsigned short)(po < DISTANCE_INFINITY ? po + 1 : DISTANCE_INFINITY);
+			i[x] = m[x] ? (unsigned short)(pi < DISTANCE_INFINITY ? pi + 1 : DISTANCE_INFINITY) : 0;
+		}
+	}
+	for (int y = height - 1; y >= 0; --y)
+	{
+		unsigned short* o = &gOut[(size_t)y * width];
+		unsigned short* i = &gIn[(size_t)y * width];
+		int x = x0;
+#ifdef USE_SSE2
+		__m128i one = _mm_set1_epi16(1);
+		for (; x + 8 <= x1; x += 8)
+		{
+			__m128i no = y < height - 1 ? _mm_loadu_si128((const __m128i*)&o[x + width]) : _mm_set1_epi16(DISTANCE_INFINITY);
+			__m128i ni = y < height - 1 ? _mm_loadu_si128((const __m128i*)&i[x + width]) : _mm_setzero_si128();
+			__m128i co = _mm_loadu_si128((const __m128i*)&o[x]), ci = _mm_loadu_si128((const __m128i*)&i[x]);
+			_mm_storeu_si128((__m128i*)&o[x], _mm_min_epi16(co, _mm_adds_epi16(no, one)));
+			_mm_storeu_si128((__m128i*)&i[x], _mm_min_epi16(ci, _mm_adds_epi16(ni, one)));
+		}
+#endif
+		for (; x < x1; ++x)
+		{
+			int no = y < height - 1 ? o[x + width] : DISTANCE_INFINITY, ni = y < height - 1 ? i[x + width] : 0;
+			if (no + 1 < o[x])
+			{
+				o[x] = (unsigned short)(no + 1);
+			}
+			if (ni + 1 < i[x])
+			{
+				i[x] = (unsigned short)(ni + 1);
+			}
+		}
+	}
+}
+
+void RowPass(const unsigned short* g, int width, int* s, int* t, long long* d2)
+{
+	//Meijsterĵڶ:f(x, i) = (x - i)^2 + g(i)^2һ,°,û
+	int q = 0;
+	s[0] = 0;
+	t[0] = 0;
+	for (int u = 1; u < width; ++u)
+	{
+		long long gu = (long long)g[u] * g[u];
+		while (q >= 0)
+		{
+			long long a = t[q] - s[q], b = t[q] - u;
+			if (a * a + (long long)g[s[q]] * g[s[q]] <= b * b + gu)
+			{
+				break;
+			}
+			--q;
+		}
+		if (q < 0)
+		{
+			q = 0;
+			s[0] = u;
+		}
+		else
+		{
+			//ߵĽ:ұu,ȡ
+			long long i = s[q];
+			long long num = (long long)u * u - i * i + gu - (long long)g[i] * g[i], den = 2 * (u - i);
+			long long w = 1 + (num >= 0 ? num / den : -((-num + den - 1) / den));
+			if (w < width)
+			{
+				++q;
+				s[q] = u;
+				t[q] = (int)w;
+			}
+		}
+	}
+	for (int u = width - 1; u >= 0; --u)
+	{
+		long long a = u - s[q];
+		d2[u] = a * a + (long long)g[s[q]] * g[s[q]];
+		if (u == t[q])
+		{
+			--q;
+		}
+	}
+}
+
+void DistanceTransform(const byte* mask, int width, int height, float* sdf)
+{
+	//ȷŷϾ任(Meijster),к,԰п顢в
+	unsigned short* gOut = (unsigned short*)malloc(sizeof(unsigned short) * width * height);
+	unsigned short* gIn = (unsigned short*)malloc(sizeof(unsigned short) * width * height);
+
+	int strips = (width + COLUMN_STRIP - 1) / COLUMN_STRIP;
+#pragma omp parallel for schedule(dynamic)
+	for (int k = 0; k < strips; ++k)
+	{
+		int x0 = k * COLUMN_STRIP, x1 = x0 + COLUMN_STRIP < width ? x0 + COLUMN_STRIP : width;
+		ColumnPass(mask, width, height, x0, x1, gOut, gIn);
+	}
+
+#pragma omp parallel
+	{
+		int* s = (int*)malloc(sizeof(int) * width * 2);
+		long long* d2 = (long long*)malloc(sizeof(long long) * width * 2);
+#pragma omp for schedule(dynamic)
+		for (int y = 0; y < height; ++y)
+		{
+			size_t row = (size_t)y * width;
+			RowPass(&gOut[row], width, s, s + width, d2);
+			RowPass(&gIn[row], width, s, s + width, d2 + width);
+			for (int x = 0; x < width; ++x)
+			{
+				//ͼҲǱ
+				long long left = x + 1, right = width - x;
+				long long in = d2[width + x];
+				in = in < left * left ? in : left * left;
+				in = in < right * right ? in : right * right;
+				//߽ǰͱĵм,
+				sdf[row + x] = d2[x] > 0 ? sqrtf((float)d2[x]) - 0.5f : 0.5f - sqrtf((float)in);
+			}
+		}
+		free(s);
+		free(d2);
+	}
+	free(gOut);
+	free(gIn);
+}
+
+float BruteDistance(const byte* mask, int width, int height, int x, int y)
+{
+	//һ,ͼ浱
+	int inside = mask[y * width + x] != 0;
+	long long best = inside ? (long long)(x + 1) * (x + 1) : 0x7fffffffffffll;
+	if (inside)
+	{
+		long long e[3] = { (long long)(width - x) * (width - x), (long long)(y + 1) * (y + 1), (long long)(height - y) * (height - y) };
+		for (int k = 0; k < 3; ++k)
+		{
+			best = e[k] < best ? e[k] : best;
+		}
+	}
+	for (int v = 0; v < height; ++v)
+	{
+		for (int u = 0; u < width; ++u)
+		{
+			if ((mask[v * width + u] != 0) != inside)
+			{
+				long long d = (long long)(u - x) * (u - x) + (long long)(v - y) * (v - y);
+				best = d < best ? d : best;
+			}
+		}
+	}
+	return inside ? 0.5f - sqrtf((float)best) : sqrtf((float)best) - 0.5f;
+}
+
+int MakeField(DistanceField* f, byte* mask, int width, int height, float x0, float y0, float size)
+{
+	//ͼϳһŵsize
+	f->width = width;
+	f->height = height;
+	f->x0 = x0;
+	f->y0 = y0;
+	f->scale = size / (width > height ? width : height);
+	f->sdf = mask ? (float*)malloc(sizeof(float) * width * height) : NULL;
+	if (f->sdf)
+	{
+		DistanceTransform(mask, width, height, f->sdf);
+	}
+	free(mask);
+	return f->sdf != NULL;
+}
+
+float SampledSDF(const DistanceField* f, float x, float y)
+{
+	//˫Բֵ,еΧɵľ
+	float u = (x - f->x0) / f->scale - 0.5f, v = (y - f->y0) / f->scale - 0.5f;
+	float cu = fminf(fmaxf(u, 0.0f), f->width - 1.0f), cv = fminf(fmaxf(v, 0.0f), f->height - 1.0f);
+	int i = (int)cu < f->width - 1 ? (int)cu : f->width - 2;
+	int j = (int)cv < f->height - 1 ? (int)cv : f->height - 2;
+	float s = cu - i, t = cv - j;
+	const float* p = &f->sdf[j * f->width + i];
+	float d = ((p[0] * (1.0f - s) + p[1] * s) * (1.0f - t) + (p[f->width] * (1.0f - s) + p[f->width + 1] * s) * t) * f->scale;
+
+	//ͼĵ:εľƽͶӰľƽһ½,ͼһȦ
+	float ox = (u - cu) * f->scale, oy = (v - cv) * f->scale;
+	float outside2 = ox * ox + oy * oy;
+	if (outside2 > 0.0f)
+	{
+		d = fmaxf(d, 0.0f);
+		return sqrtf(outside2 + d * d);
+	}
+	return d;
+}
+
+TraceResult Scene(float x, float y)
+{
+	TraceResult light = { CircleSDF(x, y, 0.9f, 0.9f, 0.05f), 0.0f, 0.0f, { 2.0f, 4.0f, 6.0f }, COLOR_BLACK };
+	TraceResult lamp = { CircleSDF(x, y, 0.53f, 0.49f, 0.015f), 0.0f, 0.0f, { 8.0f, 8.0f, 6.0f }, COLOR_BLACK };
+	TraceResult rings = { SampledSDF(&emitter, x, y), 0.0f, 0.0f, { 6.0f, 3.0f, 1.0f }, COLOR_BLACK };
+	TraceResult walls = { SampledSDF(&occluder, x, y), 0.0f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+	return Union(Union(light, lamp), Union(rings, walls));
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / LIGHT_COUNT);
+}
+
+#include "sdf.inc"
+#include "trace.inc"
+//
+//
+////DOC:
+////λͼתSDF
+//Ѷֵλͼ(ռͼ)зž볡,ͽͼԪһŽSceneﵱڵ߷
+//1.DistanceTransformǾȷŷϾ任(Meijster),һÿصǰغͱصľ:
+//  һÿһеɨ,з,ڲѭһ,SSE2һ8е16λ,ָ߳;
+//  ڶÿһf(x, i) = (x - i)^2 + g(i)^2°,ȫ,зָ߳
+//2.ͼ浱;߽ǰͱĵм,߸
+//3.SampledSDF˫Բֵ,ر߳ǳľ;ͼĵõͼľͱϵֵϳ½
+//4.ûPNG,ⲿ8λPGM(P5P2,ֵ1255,ֵһֵ);ûиļʱóɵԹռͼ,ͬԲҲɵ
+//BitmapSDFMain -bench [С] СͼϺͱضԱ,ٲͼʱ
@@ -0,0 +1,552 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+#define COLOR_WHITE {1.0f, 1.0f, 1.0f}
+
+//
+//i:̽2^i,4*4^i,ľ[INTERVAL0*(4^i-1)/3, INTERVAL0*(4^(i+1)-1)/3]
+#define CASCADE_COUNT             (6)
+#define CASCADE_DIRECTION         (4)  //0ķ,ÿһ4
+#define INTERVAL0                 (RAY_MARCHING_MAX_DISTANCE * 3.0f / ((1 << (2 * CASCADE_COUNT)) - 1)) //һպøǵ󲽽
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+//Աȵĳ,ǰ½ڵĳһ
+typedef struct
+{
+	const char* name;
+	TraceResult (*scene)(float x, float y);
+	int fresnel;  //0ʾrefractһµ,ʱֱòʵreflectivity
+} SceneDesc;
+
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+byte image[WIDTH * HEIGHT * RGB];
+
+Color traced[WIDTH * HEIGHT], cascaded[WIDTH * HEIGHT];
+
+//ÿһĿWIDTH*HEIGHT*CASCADE_DIRECTION(̽4,4),ºϲʱֻҪ
+Color cascades[2][WIDTH * HEIGHT * CASCADE_DIRECTION];
+
+TraceResult (*Scene)(float x, float y);
+
+int fresnel = 1;
+
+TraceResult BasicScene(float x, float y);
+
+TraceResult SDFScene(float x, float y);
+
+TraceResult ShapeScene(float x, float y);
+
+TraceResult ReflectScene(float x, float y);
+
+TraceResult RefractScene(float x, float y);
+
+TraceResult BeerLambertScene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+Color Shade(float x, float y, float dx, float dy, float sign, TraceResult r, int depth);
+
+Color TraceInterval(float ox, float oy, float dx, float dy, float t0, float t1, Color* transmittance);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+void RenderTrace(Color* out);
+
+void RenderCascades(Color* out);
+
+void WriteImage(const Color* c, const char* path);
+
+int main(int argc, char* argv[])
+{
+	//CascadeMain [cascade|trace|both] [] : Ĭֻ,ȫ7ϱȽϺʱ
+	const SceneDesc scenes[] =
+	{
+		{ "basic", BasicScene, 1 },
+		{ "rounded_triangle", SDFScene, 1 },
+		{ "intersec", ShapeScene, 1 },
+		{ "reflect", ReflectScene, 1 },
+		{ "refract", RefractScene, 0 },
+		{ "fresnel", RefractScene, 1 },
+		{ "beer_lambert", BeerLambertScene, 1 },
+	};
+	const char* mode = argc > 1 ? argv[1] : "both";
+	int useTrace = strcmp(mode, "cascade") != 0, useCascade = strcmp(mode, "trace") != 0;
+
+	printf("%-18s %10s %10s %8s\n", "scene", "trace(s)", "cascade(s)", "rmse");
+	for (int s = 0; s < (int)(sizeof(scenes) / sizeof(scenes[0])); ++s)
+	{
+		if (argc > 2 && strcmp(argv[2], scenes[s].name) != 0)
+		{
+			continue;
+		}
+		Scene = scenes[s].scene;
+		fresnel = scenes[s].fresnel;
+
+		char path[256];
+		double traceTime = 0.0, cascadeTime = 0.0;
+		if (useTrace)
+		{
+			double start = Now();
+			RenderTrace(traced);
+			traceTime = Now() - start;
+			sprintf(path, "..//..//png//cascade_%s_trace.png", scenes[s].name);
+			WriteImage(traced, path);
+		}
+		if (useCascade)
+		{
+			double start = Now();
+			RenderCascades(cascaded);
+			cascadeTime = Now() - start;
+			sprintf(path, "..//..//png//cascade_%s.png", scenes[s].name);
+			WriteImage(cascaded, path);
+		}
+
+		//ֶ˲ɱ,дȥͼһȽضϵ[0,1]
+		double rmse = 0.0;
+		if (useTrace && useCascade)
+		{
+			double sum = 0.0;
+			for (int i = 0; i < WIDTH * HEIGHT; ++i)
+			{
+				double dr = fminf(cascaded[i].r, 1.0f) - fminf(traced[i].r, 1.0f);
+				double dg = fminf(cascaded[i].g, 1.0f) - fminf(traced[i].g, 1.0f);
+				double db = fminf(cascaded[i].b, 1.0f) - fminf(traced[i].b, 1.0f);
+				sum += dr * dr + dg * dg + db * db;
+			}
+			rmse = sqrt(sum / (WIDTH * HEIGHT * RGB));
+		}
+		printf("%-18s %10.2f %10.2f %8.4f\n", scenes[s].name, traceTime, cascadeTime, rmse);
+	}
+
+	printf("Svnpng Success\n");
+	return 0;
+}
+
+void RenderTrace(Color* out)
+{
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			unsigned int seed = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+			out[y * WIDTH + x] = Sample((float)x / WIDTH, (float)y / HEIGHT, &seed);
+		}
+	}
+}
+
+void RenderCascades(Color* out)
+{
+	//һ,ÿһԼķȾ̲һѾϲõĽ
+	for (int i = CASCADE_COUNT - 1; i >= 0; --i)
+	{
+		Color* level = cascades[i & 1];
+		const Color* upper = cascades[(i + 1) & 1];
+		int w = WIDTH >> i, h = HEIGHT >> i, n = CASCADE_DIRECTION << (2 * i);
+		int uw = WIDTH >> (i + 1), uh = HEIGHT >> (i + 1);
+		float t0 = INTERVAL0 * ((1 << (2 * i)) - 1) / 3.0f;
+		float t1 = INTERVAL0 * ((4 << (2 * i)) - 1) / 3.0f;
+
+#pragma omp parallel for schedule(dynamic)
+		for (int p = 0; p < w * h; ++p)
+		{
+			int px = p % w, py = p / w;
+			//0̽صĲ(x/WIDTH,y/HEIGHT),i̽2^i x 2^iؿ
+			float x = ((px + 0.5f) * (1 << i) - 0.5f) / WIDTH;
+			float y = ((py + 0.5f) * (1 << i) - 0.5f) / HEIGHT;
+
+			//һס̽4̽˫Ȩ
+			int q[4];
+			float w4[4];
+			if (i + 1 < CASCADE_COUNT)
+			{
+				float fx = fminf(fmaxf((px + 0.5f) * 0.5f - 0.5f, 0.0f), uw - 1.001f);
+				float fy = fminf(fmaxf((py + 0.5f) * 0.5f - 0.5f, 0.0f), uh - 1.001f);
+				int ix = (int)fx, iy = (int)fy;
+				float sx = fx - ix, sy = fy - iy;
+				for (int j = 0; j < 4; ++j)
+				{
+					q[j] = (iy + (j >> 1)) * uw + ix + (j & 1);
+					w4[j] = ((j & 1) ? sx : 1.0f - sx) * ((j >> 1) ? sy : 1.0f - sy);
+				}
+			}
+
+			for (int k = 0; k < n; ++k)
+			{
+				float radians = TWO_PI * (k + 0.5f) / n;
+				Color transmittance;
+				Color c = TraceInterval(x, y, cosf(radians), sinf(radians), t0, t1, &transmittance);
+
+				//ûеס,ʣµĲһ4ӷ(4k..4k+3)ſ
+				if (i + 1 < CASCADE_COUNT && transmittance.r + transmittance.g + transmittance.b > 0.0f)
+				{
+					Color far = COLOR_BLACK;
+					for (int j = 0; j < 4; ++j)
+					{
+						const Color* child = upper + (size_t)q[j] * (n * 4) + k * 4;
+						Color sum = ColorAdd(ColorAdd(child[0], child[1]), ColorAdd(child[2], child[3]));
+						far = ColorAdd(far, ColorScale(sum, w4[j] * 0.25f));
+					}
+					c = ColorAdd(c, ColorMultiply(transmittance, far));
+				}
+				level[(size_t)p * n + k] = c;
+			}
+		}
+	}
+
+	//0ÿһ̽,4ƽصĽ
+	for (int i = 0; i < WIDTH * HEIGHT; ++i)
+	{
+		const Color* c = cascades[0] + (size_t)i * CASCADE_DIRECTION;
+		Color sum = COLOR_BLACK;
+		for (int k = 0; k < CASCADE_DIRECTION; ++k)
+		{
+			sum = ColorAdd(sum, c[k]);
+		}
+		out[i] = ColorScale(sum, 1.0f / CASCADE_DIRECTION);
+	}
+}
+
+Color TraceInterval(float ox, float oy, float dx, float dy, float t0, float t1, Color* transmittance)
+{
+	//ֻ[t0,t1]һ,ȡ;tһֱǴ̽,ʱTraceɫȫһ
+	float t = t0;
+	TraceResult start = Scene(ox + dx * t0, oy + dy * t0);
+	float sign = start.sdf > 0.0f ? 1.0f : -1.0f;
+
+	for (int i = 0; i < RAY_MARCHING_MAX_STEP && t < t1; ++i)
+	{
+		float x = ox + dx * t;
+		float y = oy + dy * t;
+		TraceResult r = Scene(x, y);
+		if (r.sdf * sign < EPSILON)
+		{
+			Color black = COLOR_BLACK;
+			*transmittance = black;
+			//״ڲʱǰѾ˹֮ǰ,ֻڵһ
+			return ColorMultiply(Shade(x, y, dx, dy, sign, r, 0), BeerLambert(r.absorption, sign < 0.0f ? t - t0 : t));
+		}
+		t += r.sdf * sign;
+	}
+
+	//û:ڽﴩҪȶ˥,ԭ͸
+	if (sign < 0.0f)
+	{
+		*transmittance = BeerLambert(start.absorption, t1 - t0);
+	}
+	else
+	{
+		Color white = COLOR_WHITE;
+		*transmittance = white;
+	}
+	Color black = COLOR_BLACK;
+	return black;
+}
+
+void WriteImage(const Color* c, const char* path)
+{
+	byte* p = image;
+	for (int i = 0; i < WIDTH * HEIGHT; ++i)
+	{
+		p[0] = (int)(fminf(c[i].r * 255.0f, 255.0f));
+		p[1] = (int)(fminf(c[i].g * 255.0f, 255.0f));
+		p[2] = (int)(fminf(c[i].b * 255.0f, 255.0f));
+		p += RGB;
+	}
+
+	FILE* fp = fopen(path, "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / LIGHT_COUNT);
+}
+
+#include "sdf.inc"
+
+Color Trace(float ox, float oy, float dx, float dy, int depth)
+{
+	float t = 1e-3f;
+	float sign = Scene(ox, oy).sdf > 0.0f ? 1.0f : -1.0f;
+
+	for (int i = 0; i < RAY_MARCHING_MAX_STEP && t < RAY_MARCHING_MAX_DISTANCE; ++i)
+	{
+		float x = ox + dx * t;
+		float y = oy + dy * t;
+		TraceResult r = Scene(x, y);
+		if (r.sdf * sign  < EPSILON) //Ϊǹⲿп,ڹ߲ʱҪǷ
+		{
+			return ColorMultiply(Shade(x, y, dx, dy, sign, r, depth), BeerLambert(r.absorption, t));
+		}
+
+		//߲ǹ״ڻ״
+		t += r.sdf * sign;
+	}
+
+	Color black = COLOR_BLACK;
+	return black;
+}
+
+Color Shade(float x, float y, float dx, float dy, float sign, TraceResult r, int depth)
+{
+	//еɫTrace,׷ٺͼ׷ٹ
+	Color sum = r.emissive;
+	//SDFõǿɷ߿,TraceĵݹҪķΧ
+	if (depth < RAY_MAX_TRACE_STEP && ((r.reflectivity > 0.0f) || (r.eta > 0.0f)))
+	{
+		float reflect = r.reflectivity;
+		float nx, ny, rx, ry;
+		Gradient(x, y, &nx, &ny);//㷨
+		//״ڲǻҪת
+		nx *= sign;
+		ny *= sign;
+		//׷
+		if (r.eta > 0.0f)
+		{
+			float eta = sign < 0.0f ? r.eta : 1.0f / r.eta;
+			//(dx,dy)
+			if (REFRACT == Refract(dx, dy, nx, ny, eta, &rx, &ry))
+			{
+				if (fresnel)
+				{
+					float cosi = -(dx * nx + dy * ny);
+					float cost = -(rx * nx + ry * ny);
+					reflect = sign < 0.0f ? Fresnel(cosi, cost, r.eta, 1.0f) : Fresnel(cosi, cost, 1.0f, r.eta);
+				}
+				Color trace = Trace(x - nx * RAY_BIAS, y - ny * RAY_BIAS, rx, ry, depth + 1);
+				sum = ColorAdd(sum, ColorScale(trace, 1.0f - reflect));
+			}
+			else
+			{
+				//ȫ,
+				reflect = 1.0f;
+			}
+		}
+		//׷ٷ
+		if (reflect > 0.0f)
+		{
+			Reflect(dx, dy, nx, ny, &rx, &ry);
+			Color trace = Trace(x + nx * RAY_BIAS, y + ny * RAY_BIAS, rx, ry, depth + 1);
+			sum = ColorAdd(sum, ColorScale(trace, reflect));
+		}
+	}
+	return sum;
+}
+
+void Reflect(float ix, float iy, float nx, float ny, float * rx, float * ry)
+{
+	float idotn2 = (ix * nx + iy * ny) * 2.0f;
+	*rx = ix - idotn2 * nx;
+	*ry = iy - idotn2 * ny;
+}
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float * rx, float * ry)
+{
+	//(nx,ny)ǵλ,(rx, ry)ǵλ
+	float idotn = ix * nx + iy * ny;
+	float k = 1.0f - eta * eta * (1.0f - idotn * idotn);
+	if (k < 0.0f)
+	{
+		return TOTAL_REFLECT;//ȫ
+	}
+
+	float a = eta * idotn + sqrtf(k);
+	*rx = eta * ix - a * nx;
+	*ry = eta * iy - a * ny;
+	return REFRACT;//
+}
+
+void Gradient(float x, float y, float * nx, float * ny)
+{
+	//ݶƫ΢,ʹýֵ,xyϷֱ𲽽delta(ȡõEpsilon),Ȼ΢
+	*nx = (Scene(x + EPSILON, y).sdf - Scene(x - EPSILON, y).sdf) * (0.5f / EPSILON);
+	*ny = (Scene(x, y + EPSILON).sdf - Scene(x, y - EPSILON).sdf) * (0.5f / EPSILON);
+}
+
+float Fresnel(float cosi, float cost, float etai, float etat)
+{
+	float rs = (etat * cosi - etai * cost) / (etat * cosi + etai * cost);
+	float rp = (etai * cosi - etat * cost) / (etai * cosi + etat * cost);
+	//ͼѧǿǹƫ,ȡsƫpƫľֵ
+	return (rs * rs + rp * rp) * 0.5f;
+}
+
+Color BeerLambert(Color a, float d)
+{
+	Color c = { expf(-a.r * d), expf(-a.g * d), expf(-a.b * d) };
+	return c;
+}
+
+TraceResult BasicScene(float x, float y)
+{
+	TraceResult r = { CircleSDF(x, y, 0.75f, 0.5f, 0.2f), 0.0f, 0.0f, { 2.0f, 2.0f, 2.0f }, COLOR_BLACK };
+	return r;
+}
+
+TraceResult SDFScene(float x, float y)
+{
+	TraceResult r = { TriangleSDF(x, y, 0.5f, 0.2f, 0.8f, 0.8f, 0.3f, 0.6f) - 0.1f, 0.0f, 0.0f, { 1.0f, 1.0f, 1.0f }, COLOR_BLACK };
+	return r;
+}
+
+TraceResult ShapeScene(float x, float y)
+{
+	TraceResult a = { CircleSDF(x, y, 0.3f, 0.5f, 0.2f), 0.0f, 0.0f, { 1.0f, 1.0f, 1.0f }, COLOR_BLACK };
+	TraceResult b = { CircleSDF(x, y, 0.4f, 0.5f, 0.2f), 0.0f, 0.0f, { 0.8f, 0.8f, 0.8f }, COLOR_BLACK };
+	return Intersec(a, b);
+}
+
+TraceResult ReflectScene(float x, float y)
+{
+	TraceResult a = { CircleSDF(x, y, 0.4f, 0.2f, 0.1f), 0.0f, 0.0f, { 2.0f, 2.0f, 2.0f }, COLOR_BLACK };
+	TraceResult b = { BoxSDF(x, y, 0.5f, 0.8f, TWO_PI / 16.0f, 0.1f, 0.1f), 0.9f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+	TraceResult c = { BoxSDF(x, y, 0.8f, 0.5f, TWO_PI / 16.0f, 0.1f, 0.1f), 0.9f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+	return Union(Union(a, b), c);
+}
+
+TraceResult RefractScene(float x, float y)
+{
+	x = fabsf(x - 0.5f) + 0.5f;
+	TraceResult a = { CapsuleSDF(x, y, 0.75f, 0.25f, 0.75f, 0.75f, 0.05f), 0.2f, 1.5f, COLOR_BLACK, COLOR_BLACK };
+	TraceResult b = { CapsuleSDF(x, y, 0.75f, 0.25f, 0.50f, 0.75f, 0.05f), 0.2f, 1.5f, COLOR_BLACK, COLOR_BLACK };
+	y = fabsf(y - 0.5f) + 0.5f;
+	TraceResult c = { CircleSDF(x, y, 1.05f, 1.05f, 0.05f), 0.0f, 0.0f, { 5.0f, 5.0f, 5.0f }, COLOR_BLACK };
+	return Union(a, Union(b, c));
+}
+
+TraceResult BeerLambertScene(float x, float y)
+{
+	TraceResult a = { CircleSDF(x, y, 0.5f, -0.2f, 0.1f), 0.0f, 0.0f, { 10.0f, 10.0f, 10.0f }, COLOR_BLACK };
+	TraceResult b = { NgonSDF(x, y, 0.5f, 0.5f, 0.25f, 5.0f), 0.0f, 1.5f, COLOR_BLACK, { 4.0f, 4.0f, 1.0f } };
+	return Union(a, b);
+}
+
+//
+//
+////DOC:
+////ȼ
+//ؿĴ  x LIGHT_COUNT x ,ҽǶȷֱʲʱ
+//۲:һԽ,ҪĿռֱԽߡǶȷֱԽ;ԽԶ෴(Ӱ)
+//ǰѹ߰гɼ,ÿһһ:
+//1.i̽2^i,4*4^i,ֻ׷[INTERVAL0*(4^i-1)/3, INTERVAL0*(4^(i+1)-1)/3]һ,
+//  ÿһܹ WIDTH*HEIGHT*4 ζ̹,ͳLIGHT_COUNT޹
+//2.ÿμڿķ,Լ͸(ס0,ڽﴩȶ˥,1)
+//3.һºϲ:kûסĲ,ȡһΧ4̽(˫)4ӷ4k..4k+3ƽ
+//4.0ÿһ̽,4ƽصɫ
+//еɫ(Է⡢䡢䡢)TraceShade,ԲʵЧ׷һ;
+//ڷ̶,û,ԶϸСĹԴһ״Ĳֵۼ
+//CascadeMain [cascade|trace|both] []Եĳһֻĳһ
@@ -0,0 +1,559 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define USE_SSE2
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (256)    //οͼ
+#define NOISY_COUNT               (16)     //
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//id,0ǿ
+#define MATERIAL_AIR              (0)
+#define MATERIAL_GLASS_A          (1)
+#define MATERIAL_GLASS_B          (2)
+#define MATERIAL_LIGHT            (3)
+
+//A-Trous˲
+#define ATROUS_ITERATION          (5)      //1,2,4,8,16,ǰ뾶Լ62
+#define SIGMA_LUMINANCE           (4.0f)   //ȲԱ׼Ϊλ,ԽԽģ
+#define SIGMA_NORMAL              (32.0f)  //߼нǵȨָ,2
+#define SIGMA_DISTANCE            (1.0f)   //SDFؼΪλ
+#define NORMAL_BAND               (0.02f)  //űȽϷ
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+	int material;
+}  TraceResult;
+
+//Ⱦ˳ĸ,ͨÿԸһƽ
+typedef struct
+{
+	float color[RGB][WIDTH * HEIGHT];
+	float variance[WIDTH * HEIGHT];  //ؾֵȵķ,ȨصĿ
+} Frame;
+
+typedef struct
+{
+	float distance[WIDTH * HEIGHT];  //ĴSDF,ߴس,ǵһǰİȫ
+	float nx[WIDTH * HEIGHT], ny[WIDTH * HEIGHT];
+	float material[WIDTH * HEIGHT];
+} Feature;
+
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+float Luminance(Color c)
+{
+	return 0.2126f * c.r + 0.7152f * c.g + 0.0722f * c.b;
+}
+
+byte image[WIDTH * HEIGHT * RGB];
+
+Frame noisy, filtered[2], reference;
+
+Feature feature;
+
+float luminanceScale[WIDTH * HEIGHT];  //Ȩص,1/(SIGMA_LUMINANCE*׼),ÿ˲ǰ
+
+const float atrousKernel[5] = { 1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+
+TraceResult Scene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, int count, unsigned int* seed, float* variance);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+void Render(Frame* frame, int count, Feature* aux);
+
+void Denoise(const Frame* input, const Feature* aux, int simd, Frame* buffer, Frame** output);
+
+void LuminanceScale(const Frame* in);
+
+void ATrousScalar(const Frame* in, const Feature* aux, int step, Frame* out, int x0, int x1, int y);
+
+void ATrousSIMD(const Frame* in, const Feature* aux, int step, Frame* out, int x0, int x1, int y);
+
+float FastExp(float x);
+
+float RMSE(const Frame* a, const Frame* b);
+
+void WriteFrame(const Frame* frame, const char* path);
+
+int main(int argc, char* argv[])
+{
+	//DenoiseMain [-reference] : ʱȾLIGHT_COUNTĲοͼ,Ƚ
+	int compare = argc > 1 && strcmp(argv[1], "-reference") == 0;
+
+	double start = Now();
+	Render(&noisy, NOISY_COUNT, &feature);
+	double render = Now() - start;
+	WriteFrame(&noisy, "..//..//png//denoise_noisy.png");
+
+	Frame* scalar;
+	start = Now();
+	Denoise(&noisy, &feature, 0, filtered, &scalar);
+	double scalarTime = Now() - start;
+
+	//汾Ľȴ浽reference,SIMD汾filteredһ
+	memcpy(&reference, scalar, sizeof(Frame));
+
+	Frame* result;
+	start = Now();
+	Denoise(&noisy, &feature, 1, filtered, &result);
+	double simdTime = Now() - start;
+
+	float maxDiff = 0.0f;
+	for (int c = 0; c < RGB; ++c)
+	{
+		for (int i = 0; i < WIDTH * HEIGHT; ++i)
+		{
+			maxDiff = fmaxf(maxDiff, fabsf(result->color[c][i] - reference.color[c][i]));
+		}
+	}
+	WriteFrame(result, "..//..//png//denoise_filtered.png");
+	printf("render %d samples: %.2fs, denoise: scalar %.1fms, simd %.1fms (max difference %g)\n", NOISY_COUNT, render, scalarTime * 1000.0, simdTime * 1000.0, maxDiff);
+
+	if (compare)
+	{
+		start = Now();
+		Render(&reference, LIGHT_COUNT, NULL);
+		printf("render %d samples: %.2fs\n", LIGHT_COUNT, Now() - start);
+		printf("rmse against reference: noisy %.4f, denoised %.4f\n", RMSE(&noisy, &reference), RMSE(result, &reference));
+		WriteFrame(&reference, "..//..//png//denoise_reference.png");
+	}
+
+	printf("Svnpng Success\n");
+	return 0;
+}
+
+void Render(Frame* frame, int count, Feature* aux)
+{
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			int i = y * WIDTH + x;
+			float u = (float)x / WIDTH, v = (float)y / HEIGHT;
+			unsigned int seed = (unsigned int)i * 9781u + (unsigned int)count * 6271u + 1u;
+
+			Color c = Sample(u, v, count, &seed, &frame->variance[i]);
+			frame->color[0][i] = c.r;
+			frame->color[1][i] = c.g;
+			frame->color[2][i] = c.b;
+
+			if (aux)
+			{
+				//Ĵֻÿض5SDF
+				TraceResult r = Scene(u, v);
+				float nx, ny;
+				Gradient(u, v, &nx, &ny);
+				float len = sqrtf(nx * nx + ny * ny);
+				aux->distance[i] = r.sdf;
+				aux->nx[i] = len > 0.0f ? nx / len : 0.0f;
+				aux->ny[i] = len > 0.0f ? ny / len : 0.0f;
+				aux->material[i] = r.sdf < 0.0f ? (float)r.material : (float)MATERIAL_AIR;
+			}
+		}
+	}
+}
+
+void Denoise(const Frame* input, const Feature* aux, int simd, Frame* buffer, Frame** output)
+{
+	//ATROUS_ITERATIONA-Trous,ÿ鷭,bufferFrameд
+	const Frame* in = input;
+	Frame* out = NULL;
+	for (int i = 0; i < ATROUS_ITERATION; ++i)
+	{
+		out = &buffer[i & 1];
+		int step = 1 << i;
+		LuminanceScale(in);
+#pragma omp parallel for schedule(dynamic)
+		for (int y = 0; y < HEIGHT; ++y)
+		{
+			if (!simd)
+			{
+				ATrousScalar(in, aux, step, out, 0, WIDTH, y);
+				continue;
+			}
+
+			//ұ߽紦Ĳ,汾,м4һ
+			int x0 = 2 * step, x1 = x0 + ((WIDTH - 4 * step) & ~3);
+			if (x1 <= x0)
+			{
+				ATrousScalar(in, aux, step, out, 0, WIDTH, y);
+				continue;
+			}
+			ATrousScalar(in, aux, step, out, 0, x0, y);
+			ATrousSIMD(in, aux, step, out, x0, x1, y);
+			ATrousScalar(in, aux, step, out, x1, WIDTH, y);
+		}
+		in = out;
+	}
+	*output = out;
+}
+
+void LuminanceScale(const Frame* in)
+{
+	//صķֻʮ,ͺܲ׼,3x3ĸ˹ģ
+	//ûйԴط0,ģĻԶھӻ
+#pragma omp parallel for
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			float sum = 0.0f, sumW = 0.0f;
+			for (int j = -1; j <= 1; ++j)
+			{
+				for (int i = -1; i <= 1; ++i)
+				{
+					int qx = x + i, qy = y + j;
+					if (qx >= 0 && qx < WIDTH && qy >= 0 && qy < HEIGHT)
+					{
+						float w = atrousKernel[i + 2] * atrousKernel[j + 2];
+						sum += in->variance[qy * WIDTH + qx] * w;
+						sumW += w;
+					}
+				}
+			}
+			luminanceScale[y * WIDTH + x] = 1.0f / (SIGMA_LUMINANCE * sqrtf(sum / sumW) + 1e-4f);
+		}
+	}
+}
+
+void ATrousScalar(const Frame* in, const Feature* aux, int step, Frame* out, int x0, int x1, int y)
+{
+	for (int x = x0; x < x1; ++x)
+	{
+		int p = y * WIDTH + x;
+		float lp = 0.2126f * in->color[0][p] + 0.7152f * in->color[1][p] + 0.0722f * in->color[2][p];
+		float sl = luminanceScale[p];
+		float sd = 1.0f / (SIGMA_DISTANCE * step / WIDTH);
+		int band = fabsf(aux->distance[p]) < NORMAL_BAND;
+
+		float sum[RGB] = { 0.0f, 0.0f, 0.0f }, sumVar = 0.0f, sumW = 0.0f;
+		for (int j = 0; j < 5; ++j)
+		{
+			int qy = y + (j - 2) * step;
+			if (qy < 0 || qy >= HEIGHT)
+			{
+				continue;
+			}
+			for (int i = 0; i < 5; ++i)
+			{
+				int qx = x + (i - 2) * step;
+				if (qx < 0 || qx >= WIDTH)
+				{
+					continue;
+				}
+				int q = qy * WIDTH + qx;
+				float lq = 0.2126f * in->color[0][q] + 0.7152f * in->color[1][q] + 0.0722f * in->color[2][q];
+
+				//ֻڱ渽,Զݶϻᷭת,Ե
+				float wn = 1.0f;
+				if (band && fabsf(aux->distance[q]) < NORMAL_BAND)
+				{
+					wn = fmaxf(aux->nx[p] * aux->nx[q] + aux->ny[p] * aux->ny[q], 0.0f);
+					for (int k = 1; k < SIGMA_NORMAL; k *= 2)
+					{
+						wn *= wn;
+					}
+				}
+
+				float w = atrousKernel[i] * atrousKernel[j] * wn *
+					(aux->material[p] == aux->material[q] ? 1.0f : 0.0f) *
+					FastExp(-fabsf(lp - lq) * sl - fabsf(aux->distance[p] - aux->distance[q]) * sd);
+
+				sum[0] += in->color[0][q] * w;
+				sum[1] += in->color[1][q] * w;
+				sum[2] += in->color[2][q] * w;
+				sumVar += in->variance[q] * w * w;
+				sumW += w;
+			}
+		}
+
+		//صȨkernel3/8*3/8,sumW0
+		out->color[0][p] = sum[0] / sumW;
+		out->color[1][p] = sum[1] / sumW;
+		out->color[2][p] = sum[2] / sumW;
+		out->variance[p] = sumVar / (sumW * sumW);
+	}
+}
+
+void ATrousSIMD(const Frame* in, const Feature* aux, int step, Frame* out, int x0, int x1, int y)
+{
+#ifdef USE_SSE2
+	//һδһڵ4,ǵ25Ҳڵ4,ֱloadu
+	//÷֤[x0,x1)вĺ겻,,ͱ汾һ
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+	const __m128 wr = _mm_set1_ps(0.2126f), wg = _mm_set1_ps(0.7152f), wb = _mm_set1_ps(0.0722f);
+	const __m128 band = _mm_set1_ps(NORMAL_BAND), absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	const __m128 sd = _mm_set1_ps(1.0f / (SIGMA_DISTANCE * step / WIDTH));
+
+	for (int x = x0; x < x1; x += 4)
+	{
+		int p = y * WIDTH + x;
+		__m128 lp = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&in->color[0][p]), wr), _mm_mul_ps(_mm_loadu_ps(&in->color[1][p]), wg)), _mm_mul_ps(_mm_loadu_ps(&in->color[2][p]), wb));
+		__m128 sl = _mm_loadu_ps(&luminanceScale[p]);
+		__m128 dp = _mm_loadu_ps(&aux->distance[p]);
+		__m128 bp = _mm_cmplt_ps(_mm_and_ps(dp, absMask), band);
+		__m128 nxp = _mm_loadu_ps(&aux->nx[p]), nyp = _mm_loadu_ps(&aux->ny[p]);
+		__m128 mp = _mm_loadu_ps(&aux->material[p]);
+
+		__m128 sr = zero, sg = zero, sb = zero, sv = zero, sw = zero;
+		for (int j = 0; j < 5; ++j)
+		{
+			int qy = y + (j - 2) * step;
+			if (qy < 0 || qy >= HEIGHT)
+			{
+				continue;
+			}
+			for (int i = 0; i < 5; ++i)
+			{
+				int q = qy * WIDTH + x + (i - 2) * step;
+				__m128 cr = _mm_loadu_ps(&in->color[0][q]), cg = _mm_loadu_ps(&in->color[1][q]), cb = _mm_loadu_ps(&in->color[2][q]);
+				__m128 lq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cr, wr), _mm_mul_ps(cg, wg)), _mm_mul_ps(cb, wb));
+				__m128 dq = _mm_loadu_ps(&aux->distance[q]);
+
+				__m128 wn = _mm_max_ps(_mm_add_ps(_mm_mul_ps(nxp, _mm_loadu_ps(&aux->nx[q])), _mm_mul_ps(nyp, _mm_loadu_ps(&aux->ny[q]))), zero);
+				for (int k = 1; k < SIGMA_NORMAL; k *= 2)
+				{
+					wn = _mm_mul_ps(wn, wn);
+				}
+				__m128 useNormal = _mm_and_ps(bp, _mm_cmplt_ps(_mm_and_ps(dq, absMask), band));
+				wn = _mm_or_ps(_mm_and_ps(useNormal, wn), _mm_andnot_ps(useNormal, one));
+
+				__m128 e = _mm_add_ps(_mm_mul_ps(_mm_and_ps(_mm_sub_ps(lp, lq), absMask), sl), _mm_mul_ps(_mm_and_ps(_mm_sub_ps(dp, dq), absMask), sd));
+				__m128 x2 = _mm_mul_ps(_mm_max_ps(_mm_sub_ps(zero, e), _mm_set1_ps(-87.0f)), _mm_set1_ps(1.44269504f));
+
+				//FastExpSSE2汾,˳ͱ汾ȫһ
+				__m128 fi = _mm_cvtepi32_ps(_mm_cvttps_epi32(x2));
+				fi = _mm_sub_ps(fi, _mm_and_ps(_mm_cmpgt_ps(fi, x2), one));
+				__m128 f = _mm_sub_ps(x2, fi);
+				__m128 poly = _mm_add_ps(_mm_mul_ps(f, _mm_set1_ps(0.0135557f)), _mm_set1_ps(0.0520323f));
+				poly = _mm_add_ps(_mm_mul_ps(poly, f), _mm_set1_ps(0.2413793f));
+				poly = _mm_add_ps(_mm_mul_ps(poly, f), _mm_set1_ps(0.6930327f));
+				poly = _mm_add_ps(_mm_mul_ps(poly, f), one);
+				__m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fi), _mm_set1_epi32(127)), 23));
+
+				__m128 w = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(atrousKernel[i] * atrousKernel[j]), wn), _mm_mul_ps(poly, scale));
+				w = _mm_and_ps(w, _mm_cmpeq_ps(mp, _mm_loadu_ps(&aux->material[q])));
+
+				sr = _mm_add_ps(sr, _mm_mul_ps(cr, w));
+				sg = _mm_add_ps(sg, _mm_mul_ps(cg, w));
+				sb = _mm_add_ps(sb, _mm_mul_ps(cb, w));
+				sv = _mm_add_ps(sv, _mm_mul_ps(_mm_loadu_ps(&in->variance[q]), _mm_mul_ps(w, w)));
+				sw = _mm_add_ps(sw, w);
+			}
+		}
+
+		_mm_storeu_ps(&out->color[0][p], _mm_div_ps(sr, sw));
+		_mm_storeu_ps(&out->color[1][p], _mm_div_ps(sg, sw));
+		_mm_storeu_ps(&out->color[2][p], _mm_div_ps(sb, sw));
+		_mm_storeu_ps(&out->variance[p], _mm_div_ps(sv, _mm_mul_ps(sw, sw)));
+	}
+#else
+	ATrousScalar(in, aux, step, out, x0, x1, y);
+#endif
+}
+
+float FastExp(float x)
+{
+	//exp(x) = 2^(x*log2(e)),ֱƴָλ,С4ζʽ,Լ1e-4
+	//ֻx<=0Ȩؼ
+	float t = fmaxf(x, -87.0f) * 1.44269504f;
+	float fi = (float)(int)t;
+	fi -= fi > t ? 1.0f : 0.0f;
+	float f = t - fi;
+	float poly = ((((0.0135557f * f + 0.0520323f) * f + 0.2413793f) * f + 0.6930327f) * f + 1.0f);
+	unsigned int bits = (unsigned int)((int)fi + 127) << 23;
+	float scale;
+	memcpy(&scale, &bits, sizeof(scale));
+	return poly * scale;
+}
+
+float RMSE(const Frame* a, const Frame* b)
+{
+	//ʾ[0,1]ΧڱȽ,ڲĴֵ
+	double sum = 0.0;
+	for (int c = 0; c < RGB; ++c)
+	{
+		for (int i = 0; i < WIDTH * HEIGHT; ++i)
+		{
+			double d = fminf(a->color[c][i], 1.0f) - fminf(b->color[c][i], 1.0f);
+			sum += d * d;
+		}
+	}
+	return (float)sqrt(sum / (WIDTH * HEIGHT * RGB));
+}
+
+void WriteFrame(const Frame* frame, const char* path)
+{
+	byte* p = image;
+	for (int i = 0; i < WIDTH * HEIGHT; ++i)
+	{
+		p[0] = (int)(fminf(frame->color[0][i] * 255.0f, 255.0f));
+		p[1] = (int)(fminf(frame->color[1][i] * 255.0f, 255.0f));
+		p[2] = (int)(fminf(frame->color[2][i] * 255.0f, 255.0f));
+		p += RGB;
+	}
+
+	FILE* fp = fopen(path, "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, int count, unsigned int* seed, float* variance)
+{
+	//˳ͳȵĶ׾,õֵķ
+	Color sum = COLOR_BLACK;
+	float sum2 = 0.0f;
+	for (int i = 0; i < count; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / count;   // 
+		Color c = Trace(x, y, cosf(radians), sinf(radians), 0);
+		float l = Luminance(c);
+		sum = ColorAdd(sum, c);
+		sum2 += l * l;
+	}
+	sum = ColorScale(sum, 1.0f / count);
+	float mean = Luminance(sum);
+	*variance = fmaxf(sum2 / count - mean * mean, 0.0f) / count;
+	return sum;
+}
+
+#include "sdf.inc"
+#include "trace.inc"
+
+TraceResult Scene(float x, float y)
+{
+	//һµĳ,ҡ¶Գ,ɫĲ
+	x = fabsf(x - 0.5f) + 0.5f;
+
+	TraceResult a = { CapsuleSDF(x, y, 0.75f, 0.25f, 0.75f, 0.75f, 0.05f), 0.2f, 1.5f, COLOR_BLACK, { 4.0f, 1.0f, 1.0f }, MATERIAL_GLASS_A };
+
+	TraceResult b = { CapsuleSDF(x, y, 0.75f, 0.25f, 0.50f, 0.75f, 0.05f), 0.2f, 1.5f, COLOR_BLACK, { 1.0f, 1.0f, 4.0f }, MATERIAL_GLASS_B };
+
+	y = fabsf(y - 0.5f) + 0.5f;
+
+	TraceResult c = { CircleSDF(x, y, 1.05f, 1.05f, 0.05f), 0.0f, 0.0f, { 5.0f, 5.0f, 5.0f }, COLOR_BLACK, MATERIAL_LIGHT };
+
+	return Union(a, Union(b, c));
+}
+
+//
+//
+////DOC:
+////
+//ٵʱӰͽɢȫ,ֻӹú(ƽɷ)
+//ȾNOISY_COUNT,ͬʱҪǮĸ,ԵֵA-TrousС˲:
+//1.ÿ5x5B3,step,stepÿ鷭,5ĸǷΧһܴĸ˹˲,ÿֻ125β
+//2.ÿȨٳϼԵֹͣ:
+//  idֱͬΪ0,⡢Դ߽綼һ
+//  Ȳر׼(3x3ģ)һ,ĵطſ,Ѿƽĵطս
+//  SDFĲؼһ
+//  㶼ڱ渽ʱȽϷ(Gradient),ϸ಻ụ͸
+//3.Ȩصƽһ˲,һȨ֮ս
+//SIMD汾һδ4,expúͱ汾ͬ˳Ķʽ,ֻ߽
+//-reference ȾLIGHT_COUNTĲοͼ,ӡߵ
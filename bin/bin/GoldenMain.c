@@ -0,0 +1,626 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (64)     //عֻҪͷֱ,ܵÿ
+#define HEIGHT                    (64)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (256)    //½,øвͬĵطʱ,صӰС
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+#define TRACE_FRESNEL             (fresnel)  //trace.inc㲻,refractҪص
+
+//ж׼,ͼȽضϵ[0,1],дȥPNGһ
+#define GOLDEN_DIR                "..//..//png//golden//"
+#define MAX_RMSE                  (0.01f)   //ͼľ
+#define MAX_FLIP                  (0.02f)   //FLIPƽֵ
+#define PIXEL_TOLERANCE           (0.05f)   //صͨľ
+#define MAX_OUTLIERS              (0.005f)  //PIXEL_TOLERANCEռô,øһ
+//ĳҪڲ,ᱻŴ,ѡʱRMSE 0.012FLIP 0.025
+#define GLASS_MAX_RMSE            (0.02f)
+#define GLASS_MAX_FLIP            (0.04f)
+#define GLASS_MAX_OUTLIERS        (0.05f)
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+//ο,ֺpngĿ¼¶ӦĲοͼһ
+typedef struct
+{
+	const char* name;
+	TraceResult (*scene)(float x, float y);
+	int fresnel;
+	int glass;
+} SceneDesc;
+
+typedef struct
+{
+	float rmse, flip, outliers;
+} Difference;
+
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+byte image[WIDTH * 3 * HEIGHT * RGB];  //ʧʱĶԱͼ:׼|ǰ|FLIP,Ų
+
+Color current[WIDTH * HEIGHT], golden[WIDTH * HEIGHT];
+
+float flip[WIDTH * HEIGHT];
+
+TraceResult (*Scene)(float x, float y);
+
+int fresnel = 1;
+
+TraceResult BasicScene(float x, float y);
+
+TraceResult SDFScene(float x, float y);
+
+TraceResult UnionScene(float x, float y);
+
+TraceResult IntersecScene(float x, float y);
+
+TraceResult SubtractABScene(float x, float y);
+
+TraceResult SubtractBAScene(float x, float y);
+
+TraceResult ReflectScene(float x, float y);
+
+TraceResult RefractScene(float x, float y);
+
+TraceResult BeerLambertScene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+void Render(Color* out);
+
+int SaveGolden(const char* path, const Color* c);
+
+int LoadGolden(const char* path, Color* c);
+
+Difference Compare(const Color* test, const Color* reference, float* error);
+
+void FlipColor(const Color* c, float* l, float* a, float* b);
+
+void FlipFeature(const float* l, float* edge, float* point);
+
+void WriteDiff(const char* path);
+
+int main(int argc, char* argv[])
+{
+	//GoldenMain [-update] [] : ĬϺͽ׼Ƚ,гͨʱ1;-updateɽ׼
+	const SceneDesc scenes[] =
+	{
+		{ "test", BasicScene, 1, 0 },
+		{ "basic_rounded_triangle", SDFScene, 1, 0 },
+		{ "A_Union_B", UnionScene, 1, 0 },
+		{ "A_Intersec_B", IntersecScene, 1, 0 },
+		{ "A_Sub_B", SubtractABScene, 1, 0 },
+		{ "B_Sub_A", SubtractBAScene, 1, 0 },
+		{ "basic_reflect", ReflectScene, 1, 0 },
+		{ "basic_refract", RefractScene, 0, 1 },
+		{ "basic_fresnel", RefractScene, 1, 1 },
+		{ "basic_beer_lambert_color", BeerLambertScene, 1, 1 },
+	};
+	int update = 0;
+	const char* only = NULL;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-update") == 0)
+		{
+			update = 1;
+		}
+		else
+		{
+			only = argv[i];
+		}
+	}
+
+	int failed = 0;
+	printf("%-26s %8s %8s %9s\n", "scene", "rmse", "flip", "outliers");
+	for (int s = 0; s < (int)(sizeof(scenes) / sizeof(scenes[0])); ++s)
+	{
+		if (only && strcmp(only, scenes[s].name) != 0)
+		{
+			continue;
+		}
+		Scene = scenes[s].scene;
+		fresnel = scenes[s].fresnel;
+		Render(current);
+
+		char path[256];
+		sprintf(path, GOLDEN_DIR "%s.pfm", scenes[s].name);
+		if (update)
+		{
+			if (!SaveGolden(path, current))
+			{
+				printf("can not write %s\n", path);
+				return 1;
+			}
+			printf("%-26s updated\n", scenes[s].name);
+			continue;
+		}
+		if (!LoadGolden(path, golden))
+		{
+			printf("%-26s missing %s, run GoldenMain -update first\n", scenes[s].name, path);
+			++failed;
+			continue;
+		}
+
+		Difference d = Compare(current, golden, flip);
+		int pass = scenes[s].glass ?
+			d.rmse <= GLASS_MAX_RMSE && d.flip <= GLASS_MAX_FLIP && d.outliers <= GLASS_MAX_OUTLIERS :
+			d.rmse <= MAX_RMSE && d.flip <= MAX_FLIP && d.outliers <= MAX_OUTLIERS;
+		printf("%-26s %8.5f %8.5f %8.3f%% %s\n", scenes[s].name, d.rmse, d.flip, d.outliers * 100.0f, pass ? "ok" : "FAILED");
+		if (!pass)
+		{
+			sprintf(path, GOLDEN_DIR "%s_diff.png", scenes[s].name);
+			WriteDiff(path);
+			printf("%-26s diff written to %s\n", "", path);
+			++failed;
+		}
+	}
+
+	if (failed)
+	{
+		printf("%d scene(s) FAILED\n", failed);
+		return 1;
+	}
+	printf("all scenes match\n");
+	return 0;
+}
+
+void Render(Color* out)
+{
+	//ÿصֻй,߳ȷʽӰ
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			unsigned int seed = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+			out[y * WIDTH + x] = Sample((float)x / WIDTH, (float)y / HEIGHT, &seed);
+		}
+	}
+}
+
+int SaveGolden(const char* path, const Color* c)
+{
+	//PFM:ıͷС˵float RGB,дϴ
+	FILE* fp = fopen(path, "wb");
+	if (!fp)
+	{
+		return 0;
+	}
+	fprintf(fp, "PF\n%d %d\n-1.0\n", WIDTH, HEIGHT);
+	for (int y = HEIGHT - 1; y >= 0; --y)
+	{
+		fwrite(&c[y * WIDTH], sizeof(Color), WIDTH, fp);
+	}
+	fclose(fp);
+	return 1;
+}
+
+int LoadGolden(const char* path, Color* c)
+{
+	FILE* fp = fopen(path, "rb");
+	if (!fp)
+	{
+		return 0;
+	}
+
+	int w = 0, h = 0;
+	float scale = 0.0f;
+	if (fscanf(fp, "PF %d %d %f", &w, &h, &scale) != 3 || w != WIDTH || h != HEIGHT || scale >= 0.0f || fgetc(fp) != '\n')
+	{
+		fclose(fp);
+		return 0;
+	}
+
+	int ok = 1;
+	for (int y = HEIGHT - 1; y >= 0 && ok; --y)
+	{
+		ok = fread(&c[y * WIDTH], sizeof(Color), WIDTH, fp) == WIDTH;
+	}
+	fclose(fp);
+	return ok;
+}
+
+float Clamp01(float v)
+{
+	return fminf(fmaxf(v, 0.0f), 1.0f);
+}
+
+Difference Compare(const Color* test, const Color* reference, float* error)
+{
+	Difference d = { 0.0f, 0.0f, 0.0f };
+	double sum = 0.0;
+	int outliers = 0;
+	for (int i = 0; i < WIDTH * HEIGHT; ++i)
+	{
+		float dr = Clamp01(test[i].r) - Clamp01(reference[i].r);
+		float dg = Clamp01(test[i].g) - Clamp01(reference[i].g);
+		float db = Clamp01(test[i].b) - Clamp01(reference[i].b);
+		sum += dr * dr + dg * dg + db * db;
+		outliers += fmaxf(fabsf(dr), fmaxf(fabsf(dg), fabsf(db))) > PIXEL_TOLERANCE;
+	}
+	d.rmse = (float)sqrt(sum / (WIDTH * HEIGHT * RGB));
+	d.outliers = (float)outliers / (WIDTH * HEIGHT);
+
+	//FLIPļ򻯰汾:ɫ(ռ˲LabHyAB)(Ե)Ȩ
+	static float tl[WIDTH * HEIGHT], ta[WIDTH * HEIGHT], tb[WIDTH * HEIGHT];
+	static float rl[WIDTH * HEIGHT], ra[WIDTH * HEIGHT], rb[WIDTH * HEIGHT];
+	static float te[WIDTH * HEIGHT], tp[WIDTH * HEIGHT], re[WIDTH * HEIGHT], rp[WIDTH * HEIGHT];
+	FlipColor(test, tl, ta, tb);
+	FlipColor(reference, rl, ra, rb);
+	FlipFeature(tl, te, tp);
+	FlipFeature(rl, re, rp);
+
+	//ɫɫ֮ľɫ,һ
+	const float greenBlue[2][3] = { { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+	float lab[2][3];
+	for (int i = 0; i < 2; ++i)
+	{
+		//ɫҪ˲,ֱӻLab
+		const float* lin = greenBlue[i];
+		float x = 0.4124f * lin[0] + 0.3576f * lin[1] + 0.1805f * lin[2];
+		float y = 0.2126f * lin[0] + 0.7152f * lin[1] + 0.0722f * lin[2];
+		float z = 0.0193f * lin[0] + 0.1192f * lin[1] + 0.9505f * lin[2];
+		float fx = cbrtf(x / 0.9505f), fy = cbrtf(y), fz = cbrtf(z / 1.089f);
+		lab[i][0] = 116.0f * fy - 16.0f;
+		lab[i][1] = 500.0f * (fx - fy);
+		lab[i][2] = 200.0f * (fy - fz);
+	}
+	float da = lab[0][1] - lab[1][1], db = lab[0][2] - lab[1][2];
+	float cmax = powf(fabsf(lab[0][0] - lab[1][0]) + sqrtf(da * da + db * db), 0.7f);
+	const float pc = 0.4f, pt = 0.95f;
+
+	double total = 0.0;
+	for (int i = 0; i < WIDTH * HEIGHT; ++i)
+	{
+		float dl = tl[i] - rl[i], da = ta[i] - ra[i], db = tb[i] - rb[i];
+		float hyab = powf(fabsf(dl) + sqrtf(da * da + db * db), 0.7f);
+
+		//Сѹ[0,pt],ѹ[pt,1]
+		float color = hyab < pc * cmax ? hyab * pt / (pc * cmax) : pt + (hyab - pc * cmax) / (cmax - pc * cmax) * (1.0f - pt);
+		color = fminf(color, 1.0f);
+
+		float feature = fmaxf(fabsf(te[i] - re[i]), fabsf(tp[i] - rp[i]));
+		feature = powf(fminf(feature / sqrtf(2.0f), 1.0f), 0.5f);
+
+		error[i] = powf(color, 1.0f - feature);
+		total += error[i];
+	}
+	d.flip = (float)(total / (WIDTH * HEIGHT));
+	return d;
+}
+
+void FlipColor(const Color* c, float* l, float* a, float* b)
+{
+	//PNGľǽضϺֵ,sRGB,ɫռYCxCz
+	static float ch[3][WIDTH * HEIGHT], tmp[WIDTH * HEIGHT];
+	for (int i = 0; i < WIDTH * HEIGHT; ++i)
+	{
+		float lin[3] = { Clamp01(c[i].r), Clamp01(c[i].g), Clamp01(c[i].b) };
+		for (int k = 0; k < 3; ++k)
+		{
+			lin[k] = lin[k] <= 0.04045f ? lin[k] / 12.92f : powf((lin[k] + 0.055f) / 1.055f, 2.4f);
+		}
+		float x = (0.4124f * lin[0] + 0.3576f * lin[1] + 0.1805f * lin[2]) / 0.9505f;
+		float y = 0.2126f * lin[0] + 0.7152f * lin[1] + 0.0722f * lin[2];
+		float z = (0.0193f * lin[0] + 0.1192f * lin[1] + 0.9505f * lin[2]) / 1.089f;
+		ch[0][i] = 116.0f * y - 16.0f;
+		ch[1][i] = 500.0f * (x - y);
+		ch[2][i] = 200.0f * (y - z);
+	}
+
+	//۶ɫȵĿռֱʱȵ,ɫͨ˵ø;ɷĸ˹,߽紦ض
+	const float sigma[3] = { 0.6f, 1.0f, 1.0f };
+	for (int k = 0; k < 3; ++k)
+	{
+		float w[7], sum = 0.0f;
+		for (int j = -3; j <= 3; ++j)
+		{
+			w[j + 3] = expf(-0.5f * j * j / (sigma[k] * sigma[k]));
+			sum += w[j + 3];
+		}
+		for (int pass = 0; pass < 2; ++pass)
+		{
+			const float* src = pass == 0 ? ch[k] : tmp;
+			float* dst = pass == 0 ? tmp : ch[k];
+			for (int y = 0; y < HEIGHT; ++y)
+			{
+				for (int x = 0; x < WIDTH; ++x)
+				{
+					float v = 0.0f;
+					for (int j = -3; j <= 3; ++j)
+					{
+						int sx = pass == 0 ? x + j : x, sy = pass == 0 ? y : y + j;
+						sx = sx < 0 ? 0 : (sx >= WIDTH ? WIDTH - 1 : sx);
+						sy = sy < 0 ? 0 : (sy >= HEIGHT ? HEIGHT - 1 : sy);
+						v += src[sy * WIDTH + sx] * w[j + 3];
+					}
+					dst[y * WIDTH + x] = v / sum;
+				}
+			}
+		}
+	}
+
+	//˲صXYZ,ٻLab
+	for (int i = 0; i < WIDTH * HEIGHT; ++i)
+	{
+		float y = (ch[0][i] + 16.0f) / 116.0f;
+		float x = ch[1][i] / 500.0f + y;
+		float z = y - ch[2][i] / 200.0f;
+		float fx = cbrtf(fmaxf(x, 0.0f)), fy = cbrtf(fmaxf(y, 0.0f)), fz = cbrtf(fmaxf(z, 0.0f));
+		l[i] = 116.0f * fy - 16.0f;
+		a[i] = 500.0f * (fx - fy);
+		b[i] = 200.0f * (fy - fz);
+	}
+}
+
+void FlipFeature(const float* l, float* edge, float* point)
+{
+	//ȹһ[0,1],һ׵(Sobel)ǱԵ,׵(˹)ǵ
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			float v[3][3];
+			for (int j = -1; j <= 1; ++j)
+			{
+				for (int i = -1; i <= 1; ++i)
+				{
+					int sx = x + i, sy = y + j;
+					sx = sx < 0 ? 0 : (sx >= WIDTH ? WIDTH - 1 : sx);
+					sy = sy < 0 ? 0 : (sy >= HEIGHT ? HEIGHT - 1 : sy);
+					v[j + 1][i + 1] = l[sy * WIDTH + sx] / 100.0f;
+				}
+			}
+			float gx = (v[0][2] + 2.0f * v[1][2] + v[2][2] - v[0][0] - 2.0f * v[1][0] - v[2][0]) * 0.125f;
+			float gy = (v[2][0] + 2.0f * v[2][1] + v[2][2] - v[0][0] - 2.0f * v[0][1] - v[0][2]) * 0.125f;
+			edge[y * WIDTH + x] = sqrtf(gx * gx + gy * gy);
+			point[y * WIDTH + x] = fabsf(v[0][1] + v[2][1] + v[1][0] + v[1][2] - 4.0f * v[1][1]) * 0.25f;
+		}
+	}
+}
+
+void WriteDiff(const char* path)
+{
+	byte* p = image;
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int part = 0; part < 3; ++part)
+		{
+			for (int x = 0; x < WIDTH; ++x)
+			{
+				int i = y * WIDTH + x;
+				if (part < 2)
+				{
+					const Color* c = part == 0 ? &golden[i] : &current[i];
+					p[0] = (int)(Clamp01(c->r) * 255.0f);
+					p[1] = (int)(Clamp01(c->g) * 255.0f);
+					p[2] = (int)(Clamp01(c->b) * 255.0f);
+				}
+				else
+				{
+					//ȶͼ:---
+					float e = Clamp01(flip[i]) * 3.0f;
+					p[0] = (int)(Clamp01(e) * 255.0f);
+					p[1] = (int)(Clamp01(e - 1.0f) * 255.0f);
+					p[2] = (int)(Clamp01(e - 2.0f) * 255.0f);
+				}
+				p += RGB;
+			}
+		}
+	}
+
+	FILE* fp = fopen(path, "wb");
+	if (fp)
+	{
+		svpng(fp, WIDTH * 3, HEIGHT, image, 0);
+		fclose(fp);
+	}
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / LIGHT_COUNT);
+}
+
+#include "sdf.inc"
+#include "trace.inc"
+
+TraceResult BasicScene(float x, float y)
+{
+	TraceResult r = { CircleSDF(x, y, 0.75f, 0.5f, 0.2f), 0.0f, 0.0f, { 2.0f, 2.0f, 2.0f }, COLOR_BLACK };
+	return r;
+}
+
+TraceResult SDFScene(float x, float y)
+{
+	TraceResult r = { TriangleSDF(x, y, 0.5f, 0.2f, 0.8f, 0.8f, 0.3f, 0.6f) - 0.1f, 0.0f, 0.0f, { 1.0f, 1.0f, 1.0f }, COLOR_BLACK };
+	return r;
+}
+
+TraceResult UnionScene(float x, float y)
+{
+	TraceResult a = { CircleSDF(x, y, 0.3f, 0.5f, 0.2f), 0.0f, 0.0f, { 1.0f, 1.0f, 1.0f }, COLOR_BLACK };
+	TraceResult b = { CircleSDF(x, y, 0.4f, 0.5f, 0.2f), 0.0f, 0.0f, { 0.8f, 0.8f, 0.8f }, COLOR_BLACK };
+	return Union(a, b);
+}
+
+TraceResult IntersecScene(float x, float y)
+{
+	TraceResult a = { CircleSDF(x, y, 0.3f, 0.5f, 0.2f), 0.0f, 0.0f, { 1.0f, 1.0f, 1.0f }, COLOR_BLACK };
+	TraceResult b = { CircleSDF(x, y, 0.4f, 0.5f, 0.2f), 0.0f, 0.0f, { 0.8f, 0.8f, 0.8f }, COLOR_BLACK };
+	return Intersec(a, b);
+}
+
+TraceResult SubtractABScene(float x, float y)
+{
+	TraceResult a = { CircleSDF(x, y, 0.3f, 0.5f, 0.2f), 0.0f, 0.0f, { 1.0f, 1.0f, 1.0f }, COLOR_BLACK };
+	TraceResult b = { CircleSDF(x, y, 0.4f, 0.5f, 0.2f), 0.0f, 0.0f, { 0.8f, 0.8f, 0.8f }, COLOR_BLACK };
+	return Subtract(a, b);
+}
+
+TraceResult SubtractBAScene(float x, float y)
+{
+	TraceResult a = { CircleSDF(x, y, 0.3f, 0.5f, 0.2f), 0.0f, 0.0f, { 1.0f, 1.0f, 1.0f }, COLOR_BLACK };
+	TraceResult b = { CircleSDF(x, y, 0.4f, 0.5f, 0.2f), 0.0f, 0.0f, { 0.8f, 0.8f, 0.8f }, COLOR_BLACK };
+	return Subtract(b, a);
+}
+
+TraceResult ReflectScene(float x, float y)
+{
+	TraceResult a = { CircleSDF(x, y, 0.4f, 0.2f, 0.1f), 0.0f, 0.0f, { 2.0f, 2.0f, 2.0f }, COLOR_BLACK };
+	TraceResult b = { BoxSDF(x, y, 0.5f, 0.8f, TWO_PI / 16.0f, 0.1f, 0.1f), 0.9f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+	TraceResult c = { BoxSDF(x, y, 0.8f, 0.5f, TWO_PI / 16.0f, 0.1f, 0.1f), 0.9f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+	return Union(Union(a, b), c);
+}
+
+TraceResult RefractScene(float x, float y)
+{
+	x = fabsf(x - 0.5f) + 0.5f;
+	TraceResult a = { CapsuleSDF(x, y, 0.75f, 0.25f, 0.75f, 0.75f, 0.05f), 0.2f, 1.5f, COLOR_BLACK, COLOR_BLACK };
+	TraceResult b = { CapsuleSDF(x, y, 0.75f, 0.25f, 0.50f, 0.75f, 0.05f), 0.2f, 1.5f, COLOR_BLACK, COLOR_BLACK };
+	y = fabsf(y - 0.5f) + 0.5f;
+	TraceResult c = { CircleSDF(x, y, 1.05f, 1.05f, 0.05f), 0.0f, 0.0f, { 5.0f, 5.0f, 5.0f }, COLOR_BLACK };
+	return Union(a, Union(b, c));
+}
+
+TraceResult BeerLambertScene(float x, float y)
+{
+	TraceResult a = { CircleSDF(x, y, 0.5f, -0.2f, 0.1f), 0.0f, 0.0f, { 10.0f, 10.0f, 10.0f }, COLOR_BLACK };
+	TraceResult b = { NgonSDF(x, y, 0.5f, 0.5f, 0.25f, 5.0f), 0.0f, 1.5f, COLOR_BLACK, { 4.0f, 4.0f, 1.0f } };
+	return Union(a, b);
+}
+
+//
+//
+////DOC:
+////׼ع
+//pngĿ¼µĲοͼǸ½ڳ,ûκζµĸĶûаͼŪ;
+//TraceSDFŻʱ,ײ֪ı˽
+//Ѹ½ڵĳ64x64Ⱦ,ÿصӹ̶,Խȷ;
+//SDFCSGTraceԼһݿ,ǰincludeĿ¼µsdf.inctrace.inc,ŻĵľǱĴ롣
+//ػķΧļ:
+//  sdf.inc:BasicMainShapeMainSDFMainReflectMainRefractMainFresnelMainõЩͼԪĳ򶼰,
+//  BinarySceneMainֱڴĳ㽺ҵľ,Ҳ;
+//  trace.inc:Scene(x, y)Ĳɫ,BeerLambert.c(̳ԭĵTrace)AnimationMain(Traceʱ)
+//  RenderServer(Ǻָ)IncrementalMain(Ҷ,¼ɼ)CascadeMainSphereTraceMainViewportMainԼTrace;
+//  ҶȽ̳½ڱԭÿһд,SDFTraceԼġ
+//  ЩԼTraceڻع,ʱҪԼԱ;BasicSceneBeerLambertSceneֻtrace.incػЩ½ڵĳ
+//1.GoldenMain -update ѽfloatpng/golden/µPFM,Ϊ׼
+//2.֮ÿθĶGoldenMain,ͽ׼Ƚ,ͨ:
+//  RMSEMAX_RMSE;
+//  FLIPƽֵMAX_FLIP:ɫȰ۵Ŀռֱ˲,LabHyAB,
+//  Ե͵ı仯Ŵ,RMSEӽ"ǲһ";
+//  PIXEL_TOLERANCEıMAX_OUTLIERS,Żʱ߻
+//  вĳGLASS_ͷһһЩı׼;
+//  ʵ-O3 -ffast-mathx87²FLIP 0.019~0.024,صFresnel0.075,RAY_MAX_TRACE_STEPĳ20.043~0.081;
+//  ͨFLIP0.006,RAY_MARCHING_MAX_STEPĳ48ʱ0.024
+//3.ͨʱ1,png/golden/д ׼|ǰ|ȶͼ ĶԱͼ
+//ȾӦñĸĶ(˳˲),ȷͼû-update½׼
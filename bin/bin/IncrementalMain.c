@@ -0,0 +1,435 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define COLOR_WHITE (0.0f)
+#define COLOR_BLACK (255.0f)
+
+//ֲػ
+#define TILE_SIZE                 (16)
+#define TILE_X                    (WIDTH / TILE_SIZE)
+#define TILE_Y                    (HEIGHT / TILE_SIZE)
+#define CELL_COUNT                (64)                          //ɼ[0,1]x[0,1]ֳCELL_COUNT x CELL_COUNT,64
+#define CELL_OUTSIDE              (CELL_COUNT * CELL_COUNT)     //[0,1]x[0,1]һλ
+#define MASK_WORDS                ((CELL_OUTSIDE + 64) / 64)
+#define NEAR_DISTANCE             (0.01f)                       //ߵͼԪô,ͼԪӰ(л߲)
+#define BOX_COUNT                 (2)
+
+typedef unsigned char byte;
+typedef struct { float sdf, emissive, reflectivity; int primitive; } TraceResult;
+typedef struct { float ox, oy, theta, sx, sy; } Box;
+
+//һtileĹ()һȾʱµļ¼
+typedef struct
+{
+	unsigned long long cells[MASK_WORDS]; //߾ĸ
+	unsigned int primitives;              //й߲߾ͼԪ,iλӦi
+} Visibility;
+
+byte image[WIDTH * HEIGHT * RGB];
+
+float radiance[WIDTH * HEIGHT]; //ۻ,ֲػʱûtileֱӱ
+
+Visibility tileVisibility[TILE_X * TILE_Y]; //һȾʱÿtile¼Ŀɼ
+
+//Ա༭ͼԪ,ӦReflectMain.c,ͼԪ1+±(0ǹԴ)
+Box boxes[BOX_COUNT] =
+{
+	{ 0.5f, 0.8f, TWO_PI / 16.0f, 0.1f, 0.1f },
+	{ 0.8f, 0.5f, TWO_PI / 16.0f, 0.1f, 0.1f },
+};
+
+TraceResult Scene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+float Lighting(float x, float y, unsigned int seed, Visibility* vis);
+
+float Random(unsigned int* seed);
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float Trace(float ox, float oy, float dx, float dy, int depth, Visibility* vis);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+void MarkSegment(unsigned long long* mask, float x0, float y0, float x1, float y1);
+
+void MarkBox(unsigned long long* mask, Box box, float margin);
+
+void RenderTile(int tile);
+
+int Render(const int* dirty);
+
+void MarkDirty(int primitive, Box after, int* dirty);
+
+void Save(const char* path);
+
+double Now();
+
+int main(int argc, char* argv[])
+{
+	static int dirty[TILE_X * TILE_Y];
+	static float before[WIDTH * HEIGHT];
+	int verify = argc > 1 && strcmp(argv[1], "-verify") == 0;
+
+	//һȾ,ͬʱ¼ÿtileĿɼ
+	double start = Now();
+	Render(NULL);
+	double fullTime = Now() - start;
+	printf("full render: %.3fs\n", fullTime);
+	Save("..//..//png//incremental_before.png");
+	memcpy(before, radiance, sizeof(radiance));
+
+	//ģ⽻༭:ѵһ(1ͼԪ)Ų
+	boxes[0].ox = 0.3f;
+
+	start = Now();
+	MarkDirty(1, boxes[0], dirty);
+	int count = Render(dirty);
+	double incrementalTime = Now() - start;
+	printf("incremental render: %d/%d tiles dirty, %.3fs\n", count, TILE_X * TILE_Y, incrementalTime);
+	Save("..//..//png//incremental_after.png");
+
+	//-verify : Ⱦһ,ÿصǹ̶,ûӦúȾһģһ
+	if (verify)
+	{
+		static float incremental[WIDTH * HEIGHT];
+		memcpy(incremental, radiance, sizeof(radiance));
+		Render(NULL);
+
+		//û༭ͼԪĹ,ҲΪͼԪýвͬ,԰ֵȽ
+		int wrong = 0;
+		float error = 0.0f;
+		for (int i = 0; i < WIDTH * HEIGHT; ++i)
+		{
+			float a = fminf(incremental[i] * COLOR_BLACK, COLOR_BLACK), b = fminf(radiance[i] * COLOR_BLACK, COLOR_BLACK);
+			wrong += (int)a != (int)b;
+			error = fmaxf(error, fabsf(a - b));
+		}
+		printf("verify: %d pixels differ from a full render, max error %.4f/255\n", wrong, error);
+
+		//༭ǰı˵tiletile,̫ĻٱȻ1¡
+		//ʱж,ٱֻӡʾ,ʧ
+		int changed = 0;
+		for (int i = 0; i < TILE_X * TILE_Y; ++i)
+		{
+			int tx = i % TILE_X, ty = i / TILE_X, differ = 0;
+			for (int y = ty * TILE_SIZE; y < (ty + 1) * TILE_SIZE && !differ; ++y)
+			{
+				for (int x = tx * TILE_SIZE; x < (tx + 1) * TILE_SIZE && !differ; ++x)
+				{
+					float a = fminf(before[y * WIDTH + x] * COLOR_BLACK, COLOR_BLACK), b = fminf(radiance[y * WIDTH + x] * COLOR_BLACK, COLOR_BLACK);
+					differ = (int)a != (int)b;
+				}
+			}
+			changed += differ;
+		}
+		printf("verify: %d/%d tiles dirty, %d actually changed, speedup %.2fx over a full render\n", count, TILE_X * TILE_Y, changed, fullTime / incrementalTime);
+		if (incrementalTime >= fullTime)
+		{
+			printf("verify: incremental render is not faster than a full render\n");
+		}
+		return wrong != 0;
+	}
+	return 0;
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+int Render(const int* dirty)
+{
+	//dirtyΪNULLʱȾȫtile
+	int count = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+:count)
+	for (int i = 0; i < TILE_X * TILE_Y; ++i)
+	{
+		if (dirty && !dirty[i])
+		{
+			continue;
+		}
+		RenderTile(i);
+		++count;
+	}
+	return count;
+}
+
+void RenderTile(int tile)
+{
+	int tx = tile % TILE_X, ty = tile / TILE_X;
+	Visibility* vis = &tileVisibility[tile];
+	memset(vis, 0, sizeof(Visibility));
+
+	for (int y = ty * TILE_SIZE; y < (ty + 1) * TILE_SIZE; ++y)
+	{
+		for (int x = tx * TILE_SIZE; x < (tx + 1) * TILE_SIZE; ++x)
+		{
+			//ֻλй,ػԸ
+			unsigned int seed = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+			radiance[y * WIDTH + x] = Lighting((float)x / WIDTH, (float)y / HEIGHT, seed, vis);
+		}
+	}
+}
+
+void MarkDirty(int primitive, Box after, int* dirty)
+{
+	//λ:tileĹй߲߾ͼԪġ
+	//λ:ͼԪ(NEAR_DISTANCE)סĸ,tileĹ߾һ
+	unsigned long long edit[MASK_WORDS];
+	memset(edit, 0, sizeof(edit));
+	MarkBox(edit, after, NEAR_DISTANCE);
+
+	for (int i = 0; i < TILE_X * TILE_Y; ++i)
+	{
+		dirty[i] = (tileVisibility[i].primitives >> primitive) & 1;
+		for (int w = 0; w < MASK_WORDS && !dirty[i]; ++w)
+		{
+			if (tileVisibility[i].cells[w] & edit[w])
+			{
+				dirty[i] = 1;
+				break;
+			}
+		}
+	}
+}
+
+void Save(const char* path)
+{
+	byte* p = image;
+	for (int i = 0; i < WIDTH * HEIGHT; ++i)
+	{
+		float color = radiance[i] * COLOR_BLACK;
+		p[0] = p[1] = p[2] = (int)(fminf(color, COLOR_BLACK));
+		p += RGB;
+	}
+
+	FILE* fp = fopen(path, "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+float Lighting(float x, float y, unsigned int seed, Visibility* vis)
+{
+	float sum = 0.0f;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(&seed)) / LIGHT_COUNT;   // 
+		sum += Trace(x, y, cosf(radians), sinf(radians), 0, vis);
+	}
+	return sum / LIGHT_COUNT;
+}
+
+void MarkCell(unsigned long long* mask, int cx, int cy)
+{
+	int bit = cy * CELL_COUNT + cx;
+	mask[bit >> 6] |= 1ull << (bit & 63);
+}
+
+void MarkSegment(unsigned long long* mask, float x0, float y0, float x1, float y1)
+{
+	//Ȱ߶βü[0,1]x[0,1],õĲּCELL_OUTSIDEλ
+	float dx = x1 - x0, dy = y1 - y0;
+	float t0 = 0.0f, t1 = 1.0f;
+	float p[4] = { -dx, dx, -dy, dy };
+	float q[4] = { x0, 1.0f - x0, y0, 1.0f - y0 };
+	for (int i = 0; i < 4; ++i)
+	{
+		if (p[i] == 0.0f)
+		{
+			if (q[i] < 0.0f)
+			{
+				t0 = 2.0f;//ƽڱ߽粢
+			}
+			continue;
+		}
+		float r = q[i] / p[i];
+		if (p[i] < 0.0f)
+		{
+			t0 = fmaxf(t0, r);
+		}
+		else
+		{
+			t1 = fminf(t1, r);
+		}
+	}
+	if (t0 > 0.0f || t1 < 1.0f)
+	{
+		mask[CELL_OUTSIDE >> 6] |= 1ull << (CELL_OUTSIDE & 63);
+	}
+	if (t0 > t1)
+	{
+		return;
+	}
+
+	//ڸDDA,߶δĸȫ
+	float ax = (x0 + dx * t0) * CELL_COUNT, ay = (y0 + dy * t0) * CELL_COUNT;
+	float bx = (x0 + dx * t1) * CELL_COUNT, by = (y0 + dy * t1) * CELL_COUNT;
+	int cx = (int)fminf(ax, CELL_COUNT - 1.0f), cy = (int)fminf(ay, CELL_COUNT - 1.0f);
+	int ex = (int)fminf(bx, CELL_COUNT - 1.0f), ey = (int)fminf(by, CELL_COUNT - 1.0f);
+	int sx = bx > ax ? 1 : -1, sy = by > ay ? 1 : -1;
+	float ix = fabsf(bx - ax) > 0.0f ? 1.0f / fabsf(bx - ax) : 1e30f;
+	float iy = fabsf(by - ay) > 0.0f ? 1.0f / fabsf(by - ay) : 1e30f;
+	float tx = (sx > 0 ? cx + 1 - ax : ax - cx) * ix;
+	float ty = (sy > 0 ? cy + 1 - ay : ay - cy) * iy;
+
+	MarkCell(mask, cx, cy);
+	for (int n = abs(ex - cx) + abs(ey - cy); n > 0; --n)
+	{
+		if (tx < ty)
+		{
+			cx += sx;
+			tx += ix;
+		}
+		else
+		{
+			cy += sy;
+			ty += iy;
+		}
+		MarkCell(mask, cx, cy);
+	}
+}
+
+void MarkBox(unsigned long long* mask, Box box, float margin)
+{
+	//תİΧȴɸ,øĵӵľжϸǷmarginĺ
+	float hx = fabsf(cosf(box.theta)) * box.sx + fabsf(sinf(box.theta)) * box.sy + margin;
+	float hy = fabsf(sinf(box.theta)) * box.sx + fabsf(cosf(box.theta)) * box.sy + margin;
+	float minx = (box.ox - hx) * CELL_COUNT, maxx = (box.ox + hx) * CELL_COUNT;
+	float miny = (box.oy - hy) * CELL_COUNT, maxy = (box.oy + hy) * CELL_COUNT;
+	float halfDiagonal = 0.70710678f / CELL_COUNT;
+
+	if (minx < 0.0f || miny < 0.0f || maxx >= CELL_COUNT || maxy >= CELL_COUNT)
+	{
+		mask[CELL_OUTSIDE >> 6] |= 1ull << (CELL_OUTSIDE & 63);
+	}
+	for (int cy = (int)fmaxf(miny, 0.0f); cy <= (int)fminf(maxy, CELL_COUNT - 1.0f); ++cy)
+	{
+		for (int cx = (int)fmaxf(minx, 0.0f); cx <= (int)fminf(maxx, CELL_COUNT - 1.0f); ++cx)
+		{
+			float x = (cx + 0.5f) / CELL_COUNT, y = (cy + 0.5f) / CELL_COUNT;
+			if (BoxSDF(x, y, box.ox, box.oy, box.theta, box.sx, box.sy) < margin + halfDiagonal)
+			{
+				MarkCell(mask, cx, cy);
+			}
+		}
+	}
+}
+
+#include "sdf.inc"
+
+float Trace(float ox, float oy, float dx, float dy, int depth, Visibility* vis)
+{
+	float t = 0.0f;
+
+	for (int i = 0; i < RAY_MARCHING_MAX_STEP && t < RAY_MARCHING_MAX_DISTANCE; ++i)
+	{
+		float x = ox + dx * t;
+		float y = oy + dy * t;
+		TraceResult r = Scene(x, y);
+		//ͼԪһĲ,ߵԱNEAR_DISTANCEʱ:Ųıн
+		if (r.sdf < NEAR_DISTANCE)
+		{
+			vis->primitives |= 1u << r.primitive;
+		}
+		if (r.sdf < EPSILON)
+		{
+			MarkSegment(vis->cells, ox, oy, x, y);
+			float sum = r.emissive;
+			//SDFõǿɷ,TraceĵݹҪķΧ
+			if (depth < RAY_MAX_TRACE_STEP && r.reflectivity > 0.0f)
+			{
+				float nx, ny, rx, ry;
+				Gradient(x, y, &nx, &ny);//㷨
+				Reflect(dx, dy, nx, ny, &rx, &ry);//㷴䷽
+				sum += r.reflectivity * Trace(x + nx * RAY_BIAS, y + ny * RAY_BIAS, rx, ry, depth + 1, vis);
+			}
+			return sum;
+		}
+		t += r.sdf;
+	}
+
+	//ûеĹһֱߵԶ,·Ž߶ϵĶᵲס
+	MarkSegment(vis->cells, ox, oy, ox + dx * t, oy + dy * t);
+	return 0.0f;
+}
+
+void Reflect(float ix, float iy, float nx, float ny, float * rx, float * ry)
+{
+	float idotn2 = (ix * nx + iy * ny) * 2.0f;
+	*rx = ix - idotn2 * nx;
+	*ry = iy - idotn2 * ny;
+}
+
+void Gradient(float x, float y, float * nx, float * ny)
+{
+	//ݶƫ΢,ʹýֵ,xyϷֱ𲽽delta(ȡõEpsilon),Ȼ΢
+	*nx = (Scene(x + EPSILON, y).sdf - Scene(x - EPSILON, y).sdf) * (0.5f / EPSILON);
+	*ny = (Scene(x, y + EPSILON).sdf - Scene(x, y - EPSILON).sdf) * (0.5f / EPSILON);
+}
+
+TraceResult Scene(float x, float y)
+{
+	TraceResult r = { CircleSDF(x, y, 0.4f,  0.2f, 0.1f), 2.0f, 0.0f, 0 };
+	for (int i = 0; i < BOX_COUNT; ++i)
+	{
+		TraceResult b = { BoxSDF(x, y, boxes[i].ox, boxes[i].oy, boxes[i].theta, boxes[i].sx, boxes[i].sy), 0.0f, 0.9f, 1 + i };
+		r = Union(r, b);
+	}
+	return r;
+}
+
+
+//DOC
+//ֲػ
+//༭ʱֻŲһͼԪ,տܱ仯ֻЩ""ͼԪλûλõ:
+//1.ȾʱĻֳTILE_SIZEtile,ÿtile:
+//  a.()й߲(ñNEAR_DISTANCE)ͼԪ
+//  b.ɼ,ÿһλӦеһ,ÿһδ㵽е(ûо͵Զ)ĸӶ1
+//2.༭,λðͼԪж:tileĹй߲߾༭ͼԪ;
+//  λðж:ͼԪNEAR_DISTANCEסĸӺtileн
+//  ȵǰÿһsdfΪ뾶Բ̶,tile,ֲػ淴Ⱦ
+//3.ֻػtile,tileۻԭ
+//ԶͼԪŲԺ,ߵĲҲб仯,еĶ,ֵһ
+//ֻλй,Կ-verify:ɾtileĽػͬ,
+//ͬʱӡtile༭ǰ˵tile(tile)Ⱦļٱ
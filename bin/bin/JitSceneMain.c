@@ -0,0 +1,925 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdarg.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (2)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//ͼԪ
+#define SHAPE_CIRCLE              (0)
+#define SHAPE_PLANE               (1)
+#define SHAPE_CAPSULE             (2)      //뾶Ϊ0߶
+#define SHAPE_BOX                 (3)
+#define SHAPE_TRIANGLE            (4)      //׼õĲռ
+#define SHAPE_NGON                (5)
+
+//ͼԪǰϷʽ
+#define OP_UNION                  (0)      //ʼһµ״,֮ǰ״
+#define OP_INTERSECT              (1)      //͵ǰ״
+#define OP_SUBTRACT               (2)      //ӵǰ״ȥ
+
+#define MAX_SHAPE                 (64)
+#define CACHE_LINE                (64)
+#define BENCH_POINTS              (1 << 20)
+#define SHAPE_TYPE_COUNT          (6)
+#define OP_COUNT                  (3)
+#define MATERIAL_COUNT            ((int)(sizeof(materials) / sizeof(materials[0])))
+#define JIT_TOLERANCE             (1e-5f)  //ɵĴͽִ
+
+//ɵԴͶ̬ڵǰĿ¼,ļԴĹϣ,ʱ´ֱӼ
+#ifdef _WIN32
+#define JIT_CACHE_PREFIX          ".\\jit_scene_"
+#define JIT_LIBRARY_SUFFIX        ".dll"
+#define JIT_COMPILER              "cl"
+#define JIT_COMMAND               "%s /nologo /O2 /LD /Fe%s %s >nul"
+#else
+#define JIT_CACHE_PREFIX          "./jit_scene_"
+#define JIT_LIBRARY_SUFFIX        ".so"
+#define JIT_COMPILER              "cc"
+//ɵĴûNaN,fminf/fmaxf/sqrtfֱչָ,Ȼÿζһlibm
+#define JIT_COMMAND               "%s -O2 -fno-math-errno -ffinite-math-only -fno-trapping-math -shared -fPIC -o %s %s -lm"
+#endif
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+//:½ڵSDFĲһһӦ
+typedef struct
+{
+	int type, op, material;
+	float p[7];
+} ShapeDesc;
+
+//׼õͼԪ:32ֽ,һ,ֵʱֻ
+//pĺͱ仯,Ǻֵ޹صĲ,PrepareScene
+typedef struct
+{
+	byte type, op, material, count;
+	float p[7];
+} Primitive;
+
+//ɵĳ,ʴmaterialsȡ
+typedef void (*JitFunc)(float x, float y, float* sdf, int* material);
+
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+byte image[WIDTH * HEIGHT * RGB];
+
+ShapeDesc shapes[MAX_SHAPE];
+int shapeCount;
+
+Primitive* primitives;  //ж
+int primitiveCount;
+
+const char* shapeNames[SHAPE_TYPE_COUNT] = { "circle", "plane", "capsule", "box", "triangle", "ngon" };
+const char* opNames[OP_COUNT] = { "union", "intersect", "subtract" };
+
+char* jitSource;
+int jitLength, jitCapacity;
+JitFunc jitScene;
+
+//,ֻȡһ
+TraceResult materials[] =
+{
+	{ 0.0f, 0.0f, 0.0f, { 8.0f, 8.0f, 8.0f }, COLOR_BLACK },        //Դ
+	{ 0.0f, 0.0f, 1.5f, COLOR_BLACK, { 4.0f, 4.0f, 1.0f } },        //
+	{ 0.0f, 0.0f, 1.5f, COLOR_BLACK, { 1.0f, 4.0f, 4.0f } },        //첣
+	{ 0.0f, 0.6f, 0.0f, COLOR_BLACK, COLOR_BLACK },                 //
+	{ 0.0f, 0.0f, 0.0f, { 1.0f, 0.6f, 0.3f }, COLOR_BLACK },        //ǽ
+};
+
+TraceResult (*Scene)(float x, float y);
+
+TraceResult PreparedScene(float x, float y);
+
+TraceResult CompiledScene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+void AddShape(int type, int op, int material, float p0, float p1, float p2, float p3, float p4, float p5, float p6);
+
+void DescribeScene();
+
+int LoadScene(const char* path);
+
+int SaveScene(const char* path);
+
+JitFunc CompileScene(int* cached);
+
+void PrepareScene();
+
+void* AlignedAlloc(size_t size, size_t align);
+
+void AlignedFree(void* p);
+
+double BenchScene(const char* name, float* checksum);
+
+int main(int argc, char* argv[])
+{
+	//JitSceneMain [ļ] [-nojit] [-dump ļ] : ûгļʱDescribeSceneĳ,-dumpѳдı
+	const char* path = NULL;
+	const char* dump = NULL;
+	int nojit = 0;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-nojit") == 0)
+		{
+			nojit = 1;
+		}
+		else if (strcmp(argv[i], "-dump") == 0 && i + 1 < argc)
+		{
+			dump = argv[++i];
+		}
+		else
+		{
+			path = argv[i];
+		}
+	}
+
+	if (path)
+	{
+		if (!LoadScene(path))
+		{
+			printf("can not load scene %s\n", path);
+			return 1;
+		}
+	}
+	else
+	{
+		DescribeScene();
+	}
+	if (dump && !SaveScene(dump))
+	{
+		printf("can not write %s\n", dump);
+		return 1;
+	}
+	PrepareScene();
+	printf("%d shapes, %d primitive slots\n", shapeCount, primitiveCount);
+
+	Scene = PreparedScene;
+	if (!nojit)
+	{
+		int cached = 0;
+		double start = Now();
+		jitScene = CompileScene(&cached);
+		if (jitScene)
+		{
+			printf("jit: %s in %.2fs\n", cached ? "cached library loaded" : "compiled", Now() - start);
+
+			//ɵĴͽִе˳һ,Ӧһ,ԲϾͲ
+			float maxDiff = 0.0f;
+			int materialDiff = 0;
+			unsigned int seed = 12345u;
+			for (int i = 0; i < BENCH_POINTS; ++i)
+			{
+				float x = Random(&seed) * 1.4f - 0.2f, y = Random(&seed) * 1.4f - 0.2f;
+				TraceResult a = PreparedScene(x, y), b = CompiledScene(x, y);
+				maxDiff = fmaxf(maxDiff, fabsf(a.sdf - b.sdf));
+				materialDiff += memcmp(&a.emissive, &b.emissive, sizeof(Color) * 2) != 0 || a.eta != b.eta || a.reflectivity != b.reflectivity;
+			}
+			printf("max sdf difference %g, %d material mismatches\n", maxDiff, materialDiff);
+
+			if (maxDiff <= JIT_TOLERANCE && materialDiff == 0)
+			{
+				float sumA, sumB;
+				Scene = PreparedScene;
+				double interpreted = BenchScene("interpret", &sumA);
+				Scene = CompiledScene;
+				double compiled = BenchScene("jit", &sumB);
+				printf("speedup %.2fx\n", interpreted / compiled);
+			}
+			else
+			{
+				printf("jit result does not match, falling back to the interpreter\n");
+				Scene = PreparedScene;
+			}
+		}
+		else
+		{
+			printf("jit unavailable, falling back to the interpreter\n");
+		}
+	}
+
+	double start = Now();
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			unsigned int s = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+			Color c = Sample((float)x / WIDTH, (float)y / HEIGHT, &s);
+			byte* p = &image[(y * WIDTH + x) * RGB];
+			p[0] = (int)(fminf(c.r * 255.0f, 255.0f));
+			p[1] = (int)(fminf(c.g * 255.0f, 255.0f));
+			p[2] = (int)(fminf(c.b * 255.0f, 255.0f));
+		}
+	}
+	printf("render (%s): %.2fs\n", Scene == CompiledScene ? "jit" : "interpret", Now() - start);
+
+	FILE* fp = fopen("..//..//png//jit_scene.png", "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+	AlignedFree(primitives);
+	free(jitSource);
+	printf("Svnpng Success\n");
+	return 0;
+}
+
+double BenchScene(const char* name, float* checksum)
+{
+	//ͬһ,ֻȽSceneĿ
+	float sum = 0.0f;
+	unsigned int seed = 777u;
+	double start = Now();
+	for (int i = 0; i < BENCH_POINTS; ++i)
+	{
+		float x = Random(&seed), y = Random(&seed);
+		sum += Scene(x, y).sdf;
+	}
+	double elapsed = Now() - start;
+	*checksum = sum;
+	printf("%-10s: %.1f ns/eval (checksum %g)\n", name, elapsed * 1e9 / BENCH_POINTS, sum);
+	return elapsed;
+}
+
+void AddShape(int type, int op, int material, float p0, float p1, float p2, float p3, float p4, float p5, float p6)
+{
+	ShapeDesc* s = &shapes[shapeCount++];
+	s->type = type;
+	s->op = op;
+	s->material = material;
+	s->p[0] = p0; s->p[1] = p1; s->p[2] = p2; s->p[3] = p3;
+	s->p[4] = p4; s->p[5] = p5; s->p[6] = p6;
+}
+
+void DescribeScene()
+{
+	//˳ͶӦSDFһ
+	AddShape(SHAPE_CIRCLE, OP_UNION, 0, 0.5f, 0.5f, 0.06f, 0, 0, 0, 0);
+	AddShape(SHAPE_PLANE, OP_UNION, 4, 0.0f, 1.1f, 0.0f, -1.0f, 0, 0, 0);
+
+	//һȦתľ
+	for (int i = 0; i < 12; ++i)
+	{
+		float a = TWO_PI * i / 12.0f;
+		AddShape(SHAPE_BOX, OP_UNION, 3, 0.5f + 0.38f * cosf(a), 0.5f + 0.38f * sinf(a), a + 0.3f, 0.05f, 0.01f, 0, 0);
+	}
+
+	AddShape(SHAPE_NGON, OP_UNION, 1, 0.5f, 0.5f, 0.22f, 5.0f, 0, 0, 0);
+	AddShape(SHAPE_CIRCLE, OP_SUBTRACT, 1, 0.5f, 0.5f, 0.16f, 0, 0, 0, 0);  //мڿ,ŹԴ
+
+	AddShape(SHAPE_TRIANGLE, OP_UNION, 2, 0.05f, 0.05f, 0.2f, 0.05f, 0.1f, 0.2f, 0);
+	AddShape(SHAPE_CAPSULE, OP_UNION, 2, 0.8f, 0.05f, 0.95f, 0.2f, 0.03f, 0, 0);
+	AddShape(SHAPE_CAPSULE, OP_UNION, 3, 0.05f, 0.95f, 0.25f, 0.98f, 0.0f, 0, 0);
+
+	//Բ͸
+	AddShape(SHAPE_CIRCLE, OP_UNION, 2, 0.78f, 0.92f, 0.1f, 0, 0, 0, 0);
+	AddShape(SHAPE_CIRCLE, OP_INTERSECT, 2, 0.92f, 0.92f, 0.1f, 0, 0, 0, 0);
+}
+
+void PrepareScene()
+{
+	//ÿͼԪֻһκֵ޹ص:Ǻ
+	primitives = (Primitive*)AlignedAlloc(sizeof(Primitive) * MAX_SHAPE * 2, CACHE_LINE);
+	memset(primitives, 0, sizeof(Primitive) * MAX_SHAPE * 2);
+	primitiveCount = 0;
+
+	for (int i = 0; i < shapeCount; ++i)
+	{
+		const ShapeDesc* s = &shapes[i];
+		Primitive* p = &primitives[primitiveCount++];
+		p->type = (byte)s->type;
+		p->op = (byte)s->op;
+		p->material = (byte)s->material;
+
+		if (s->type == SHAPE_CIRCLE)
+		{
+			//cx, cy, r
+			memcpy(p->p, s->p, sizeof(float) * 3);
+		}
+		else if (s->type == SHAPE_PLANE)
+		{
+			//px, py, nx, ny
+			memcpy(p->p, s->p, sizeof(float) * 4);
+		}
+		else if (s->type == SHAPE_CAPSULE)
+		{
+			//ax, ay, ux, uy, 1/|u|^2, radius
+			float ux = s->p[2] - s->p[0], uy = s->p[3] - s->p[1];
+			p->p[0] = s->p[0];
+			p->p[1] = s->p[1];
+			p->p[2] = ux;
+			p->p[3] = uy;
+			p->p[4] = 1.0f / (ux * ux + uy * uy);
+			p->p[5] = s->p[4];
+		}
+		else if (s->type == SHAPE_BOX)
+		{
+			//ox, oy, cos, sin, sx, sy
+			p->p[0] = s->p[0];
+			p->p[1] = s->p[1];
+			p->p[2] = cosf(s->p[2]);
+			p->p[3] = sinf(s->p[2]);
+			p->p[4] = s->p[3];
+			p->p[5] = s->p[4];
+		}
+		else if (s->type == SHAPE_TRIANGLE)
+		{
+			//һ:a, b-a, c-b;ڶ:a-c, ߳ƽĵ
+			Primitive* q = &primitives[primitiveCount++];
+			float e[6] = { s->p[2] - s->p[0], s->p[3] - s->p[1], s->p[4] - s->p[2], s->p[5] - s->p[3], s->p[0] - s->p[4], s->p[1] - s->p[5] };
+			p->p[0] = s->p[0];
+			p->p[1] = s->p[1];
+			memcpy(&p->p[2], e, sizeof(float) * 4);
+			q->p[0] = e[4];
+			q->p[1] = e[5];
+			for (int k = 0; k < 3; ++k)
+			{
+				q->p[2 + k] = 1.0f / (e[k * 2] * e[k * 2] + e[k * 2 + 1] * e[k * 2 + 1]);
+			}
+		}
+		else if (s->type == SHAPE_NGON)
+		{
+			//cx, cy, r*cos(a/2), 0ߵķ, תһߵcossin
+			//ε㵽ߵľ,ڵ㵽бֱߵֵ,
+			//תֵ,Ҫatan2/fmod/cos/sin
+			float a = TWO_PI / s->p[3];
+			p->count = (byte)s->p[3];
+			p->p[0] = s->p[0];
+			p->p[1] = s->p[1];
+			p->p[2] = s->p[2] * cosf(a * 0.5f);
+			p->p[3] = cosf(a * 0.5f);
+			p->p[4] = sinf(a * 0.5f);
+			p->p[5] = cosf(a);
+			p->p[6] = sinf(a);
+		}
+	}
+}
+
+TraceResult PreparedScene(float x, float y)
+{
+	float best = 1e30f, current = 1e30f;
+	int bestMaterial = 0, currentMaterial = 0;
+
+	for (int i = 0; i < primitiveCount; ++i)
+	{
+		const Primitive* p = &primitives[i];
+		const float* q = p->p;
+		float d;
+
+		switch (p->type)
+		{
+		case SHAPE_CIRCLE:
+		{
+			float dx = x - q[0], dy = y - q[1];
+			d = sqrtf(dx * dx + dy * dy) - q[2];
+			break;
+		}
+		case SHAPE_PLANE:
+			d = (x - q[0]) * q[2] + (y - q[1]) * q[3];
+			break;
+		case SHAPE_CAPSULE:
+		{
+			float vx = x - q[0], vy = y - q[1];
+			float t = fmaxf(fminf((vx * q[2] + vy * q[3]) * q[4], 1.0f), 0.0f);
+			float dx = vx - q[2] * t, dy = vy - q[3] * t;
+			d = sqrtf(dx * dx + dy * dy) - q[5];
+			break;
+		}
+		case SHAPE_BOX:
+		{
+			float lx = x - q[0], ly = y - q[1];
+			float dx = fabsf(lx * q[2] + ly * q[3]) - q[4];
+			float dy = fabsf(ly * q[2] - lx * q[3]) - q[5];
+			float ax = fmaxf(dx, 0.0f), ay = fmaxf(dy, 0.0f);
+			d = fminf(fmaxf(dx, dy), 0.0f) + sqrtf(ax * ax + ay * ay);
+			break;
+		}
+		case SHAPE_TRIANGLE:
+		{
+			//a->b, b->c, c->a,ǰһϱõ
+			const float* r = primitives[++i].p;
+			float ex[3] = { q[2], q[4], r[0] }, ey[3] = { q[3], q[5], r[1] };
+			float sx = q[0], sy = q[1];
+			float d2 = 1e30f;
+			int inside = 1;
+			for (int k = 0; k < 3; ++k)
+			{
+				float vx = x - sx, vy = y - sy;
+				float t = fmaxf(fminf((vx * ex[k] + vy * ey[k]) * r[2 + k], 1.0f), 0.0f);
+				float dx = vx - ex[k] * t, dy = vy - ey[k] * t;
+				d2 = fminf(d2, dx * dx + dy * dy);
+				inside &= ex[k] * vy > ey[k] * vx;
+				sx += ex[k];
+				sy += ey[k];
+			}
+			d = inside ? -sqrtf(d2) : sqrtf(d2);
+			break;
+		}
+		case SHAPE_NGON:
+		{
+			float ux = x - q[0], uy = y - q[1];
+			float nx = q[3], ny = q[4], m = -1e30f;
+			for (int k = 0; k < p->count; ++k)
+			{
+				m = fmaxf(m, ux * nx + uy * ny);
+				float t = nx * q[5] - ny * q[6];
+				ny = nx * q[6] + ny * q[5];
+				nx = t;
+			}
+			d = m - q[2];
+			break;
+		}
+		default:
+			d = 1e30f;
+			break;
+		}
+
+		if (p->op == OP_UNION)
+		{
+			if (current < best)
+			{
+				best = current;
+				bestMaterial = currentMaterial;
+			}
+			current = d;
+			currentMaterial = p->material;
+		}
+		else if (p->op == OP_INTERSECT)
+		{
+			current = fmaxf(current, d);
+		}
+		else
+		{
+			current = fmaxf(current, -d);
+		}
+	}
+
+	if (current < best)
+	{
+		best = current;
+		bestMaterial = currentMaterial;
+	}
+
+	TraceResult r = materials[bestMaterial];
+	r.sdf = best;
+	return r;
+}
+
+int FindName(const char* const* names, int count, const char* name)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		if (strcmp(names[i], name) == 0)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+int ValidShape(int type, const float* p)
+{
+	//PrepareSceneҪñ߳ƽĵ,˻ĽҺα߻õinf,JITɵ"inf.0f"Ҳ벻;
+	//εıһֽ
+	for (int k = 0; k < 7; ++k)
+	{
+		if (!isfinite(p[k]))
+		{
+			return 0;
+		}
+	}
+	if (type == SHAPE_CAPSULE)
+	{
+		float ux = p[2] - p[0], uy = p[3] - p[1];
+		return ux * ux + uy * uy > EPSILON * EPSILON;
+	}
+	if (type == SHAPE_TRIANGLE)
+	{
+		for (int k = 0; k < 3; ++k)
+		{
+			int j = (k + 1) % 3;
+			float ex = p[j * 2] - p[k * 2], ey = p[j * 2 + 1] - p[k * 2 + 1];
+			if (ex * ex + ey * ey <= EPSILON * EPSILON)
+			{
+				return 0;
+			}
+		}
+	}
+	if (type == SHAPE_NGON)
+	{
+		return p[3] >= 3.0f && p[3] <= 255.0f && p[3] == floorf(p[3]);
+	}
+	return 1;
+}
+
+int LoadScene(const char* path)
+{
+	//ÿһͼԪ:  Ϸʽ  ...,˳ͶӦSDFһ,ûдĲ0,#ͷע
+	FILE* fp = fopen(path, "r");
+	if (!fp)
+	{
+		return 0;
+	}
+
+	char line[256];
+	shapeCount = 0;
+	while (fgets(line, sizeof(line), fp))
+	{
+		char type[16], op[16];
+		int material;
+		float p[7] = { 0 };
+		int n = sscanf(line, "%15s %15s %d %f %f %f %f %f %f %f", type, op, &material, &p[0], &p[1], &p[2], &p[3], &p[4], &p[5], &p[6]);
+		if (n < 1 || type[0] == '#')
+		{
+			continue;
+		}
+
+		int t = FindName(shapeNames, SHAPE_TYPE_COUNT, type);
+		int o = n >= 2 ? FindName(opNames, OP_COUNT, op) : -1;
+		if (n < 4 || t < 0 || o < 0 || material < 0 || material >= MATERIAL_COUNT || shapeCount >= MAX_SHAPE || !ValidShape(t, p))
+		{
+			printf("bad shape: %s", line);
+			fclose(fp);
+			return 0;
+		}
+		AddShape(t, o, material, p[0], p[1], p[2], p[3], p[4], p[5], p[6]);
+	}
+	fclose(fp);
+	return shapeCount > 0;
+}
+
+int SaveScene(const char* path)
+{
+	FILE* fp = fopen(path, "w");
+	if (!fp)
+	{
+		return 0;
+	}
+
+	fprintf(fp, "#type op material params...\n");
+	for (int i = 0; i < shapeCount; ++i)
+	{
+		const ShapeDesc* s = &shapes[i];
+		fprintf(fp, "%s %s %d", shapeNames[s->type], opNames[s->op], s->material);
+		for (int k = 0; k < 7; ++k)
+		{
+			fprintf(fp, " %.9g", s->p[k]);
+		}
+		fprintf(fp, "\n");
+	}
+	fclose(fp);
+	return 1;
+}
+
+TraceResult CompiledScene(float x, float y)
+{
+	float sdf;
+	int material;
+	jitScene(x, y, &sdf, &material);
+
+	TraceResult r = materials[material];
+	r.sdf = sdf;
+	return r;
+}
+
+void Emit(const char* format, ...)
+{
+	//ɵԴȷڴ,ϣ֪ļ
+	va_list args;
+	va_start(args, format);
+	int n = vsnprintf(NULL, 0, format, args);
+	va_end(args);
+
+	if (jitLength + n + 1 > jitCapacity)
+	{
+		jitCapacity = (jitLength + n + 1) * 2;
+		jitSource = (char*)realloc(jitSource, jitCapacity);
+	}
+	va_start(args, format);
+	vsnprintf(jitSource + jitLength, n + 1, format, args);
+	va_end(args);
+	jitLength += n;
+}
+
+const char* Literal(float v)
+{
+	//9λЧԭԭfloat;ҪС,1fǺϷC
+	static char buffer[8][32];
+	static int next;
+	char* s = buffer[next++ & 7];
+	sprintf(s, "%.9g", v);
+	if (!strpbrk(s, ".e"))
+	{
+		strcat(s, ".0");
+	}
+	strcat(s, "f");
+	return s;
+}
+
+void EmitPrimitive(const Primitive* p)
+{
+	//PreparedSceneһһӦ,ֻǲֱдɳ,ѭչ
+	const float* q = p->p;
+	switch (p->type)
+	{
+	case SHAPE_CIRCLE:
+		Emit("\t{\n\t\tfloat dx = x - %s, dy = y - %s;\n", Literal(q[0]), Literal(q[1]));
+		Emit("\t\td = sqrtf(dx * dx + dy * dy) - %s;\n\t}\n", Literal(q[2]));
+		break;
+	case SHAPE_PLANE:
+		Emit("\td = (x - %s) * %s + (y - %s) * %s;\n", Literal(q[0]), Literal(q[2]), Literal(q[1]), Literal(q[3]));
+		break;
+	case SHAPE_CAPSULE:
+		Emit("\t{\n\t\tfloat vx = x - %s, vy = y - %s;\n", Literal(q[0]), Literal(q[1]));
+		Emit("\t\tfloat t = fmaxf(fminf((vx * %s + vy * %s) * %s, 1.0f), 0.0f);\n", Literal(q[2]), Literal(q[3]), Literal(q[4]));
+		Emit("\t\tfloat dx = vx - %s * t, dy = vy - %s * t;\n", Literal(q[2]), Literal(q[3]));
+		Emit("\t\td = sqrtf(dx * dx + dy * dy) - %s;\n\t}\n", Literal(q[5]));
+		break;
+	case SHAPE_BOX:
+		Emit("\t{\n\t\tfloat lx = x - %s, ly = y - %s;\n", Literal(q[0]), Literal(q[1]));
+		Emit("\t\tfloat dx = fabsf(lx * %s + ly * %s) - %s;\n", Literal(q[2]), Literal(q[3]), Literal(q[4]));
+		Emit("\t\tfloat dy = fabsf(ly * %s - lx * %s) - %s;\n", Literal(q[2]), Literal(q[3]), Literal(q[5]));
+		Emit("\t\tfloat ax = fmaxf(dx, 0.0f), ay = fmaxf(dy, 0.0f);\n");
+		Emit("\t\td = fminf(fmaxf(dx, dy), 0.0f) + sqrtf(ax * ax + ay * ay);\n\t}\n");
+		break;
+	case SHAPE_TRIANGLE:
+	{
+		const float* r = p[1].p;
+		float ex[3] = { q[2], q[4], r[0] }, ey[3] = { q[3], q[5], r[1] };
+		float sx = q[0], sy = q[1];
+		Emit("\t{\n\t\tfloat d2 = 1e30f, vx, vy, t, dx, dy;\n\t\tint inside = 1;\n");
+		for (int k = 0; k < 3; ++k)
+		{
+			Emit("\t\tvx = x - %s;\n\t\tvy = y - %s;\n", Literal(sx), Literal(sy));
+			Emit("\t\tt = fmaxf(fminf((vx * %s + vy * %s) * %s, 1.0f), 0.0f);\n", Literal(ex[k]), Literal(ey[k]), Literal(r[2 + k]));
+			Emit("\t\tdx = vx - %s * t;\n\t\tdy = vy - %s * t;\n", Literal(ex[k]), Literal(ey[k]));
+			Emit("\t\td2 = fminf(d2, dx * dx + dy * dy);\n");
+			Emit("\t\tinside &= %s * vy > %s * vx;\n", Literal(ex[k]), Literal(ey[k]));
+			sx += ex[k];
+			sy += ey[k];
+		}
+		Emit("\t\td = inside ? -sqrtf(d2) : sqrtf(d2);\n\t}\n");
+		break;
+	}
+	case SHAPE_NGON:
+	{
+		float nx = q[3], ny = q[4];
+		Emit("\t{\n\t\tfloat ux = x - %s, uy = y - %s, m = -1e30f;\n", Literal(q[0]), Literal(q[1]));
+		for (int k = 0; k < p->count; ++k)
+		{
+			Emit("\t\tm = fmaxf(m, ux * %s + uy * %s);\n", Literal(nx), Literal(ny));
+			float t = nx * q[5] - ny * q[6];
+			ny = nx * q[6] + ny * q[5];
+			nx = t;
+		}
+		Emit("\t\td = m - %s;\n\t}\n", Literal(q[2]));
+		break;
+	}
+	default:
+		Emit("\td = 1e30f;\n");
+		break;
+	}
+}
+
+void EmitScene()
+{
+	jitLength = 0;
+	Emit("#include <math.h>\n\n");
+	Emit("#ifdef _WIN32\n__declspec(dllexport)\n#endif\n");
+	Emit("void JitScene(float x, float y, float* sdf, int* material)\n{\n");
+	Emit("\tfloat best = 1e30f, current = 1e30f, d;\n\tint bestMaterial = 0, currentMaterial = 0;\n\n");
+	for (int i = 0; i < primitiveCount; ++i)
+	{
+		const Primitive* p = &primitives[i];
+		Emit("\t//%s %s\n", shapeNames[p->type], opNames[p->op]);
+		EmitPrimitive(p);
+		if (p->op == OP_UNION)
+		{
+			Emit("\tif (current < best)\n\t{\n\t\tbest = current;\n\t\tbestMaterial = currentMaterial;\n\t}\n");
+			Emit("\tcurrent = d;\n\tcurrentMaterial = %d;\n\n", p->material);
+		}
+		else
+		{
+			Emit("\tcurrent = fmaxf(current, %s);\n\n", p->op == OP_INTERSECT ? "d" : "-d");
+		}
+		i += p->type == SHAPE_TRIANGLE;
+	}
+	Emit("\tif (current < best)\n\t{\n\t\tbest = current;\n\t\tbestMaterial = currentMaterial;\n\t}\n");
+	Emit("\t*sdf = best;\n\t*material = bestMaterial;\n}\n");
+}
+
+JitFunc LoadLibraryScene(const char* path)
+{
+#ifdef _WIN32
+	HMODULE module = LoadLibraryA(path);
+	return module ? (JitFunc)GetProcAddress(module, "JitScene") : NULL;
+#else
+	void* module = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+	return module ? (JitFunc)dlsym(module, "JitScene") : NULL;
+#endif
+}
+
+JitFunc CompileScene(int* cached)
+{
+	//ûCCָ
+	const char* compiler = getenv("CC") ? getenv("CC") : JIT_COMPILER;
+	EmitScene();
+
+	//FNV-1a:Դ롢ѡһ,̬ͿֱӸ
+	const char* keys[3] = { jitSource, compiler, JIT_COMMAND };
+	unsigned long long hash = 14695981039346656037ull;
+	for (int k = 0; k < 3; ++k)
+	{
+		for (const char* c = keys[k]; *c; ++c)
+		{
+			hash = (hash ^ (unsigned char)*c) * 1099511628211ull;
+		}
+	}
+
+	char source[256], library[256], command[1024];
+	sprintf(source, JIT_CACHE_PREFIX "%016llx.c", hash);
+	sprintf(library, JIT_CACHE_PREFIX "%016llx" JIT_LIBRARY_SUFFIX, hash);
+
+	JitFunc f = LoadLibraryScene(library);
+	if (f)
+	{
+		*cached = 1;
+		return f;
+	}
+
+	FILE* fp = fopen(source, "w");
+	if (!fp)
+	{
+		return NULL;
+	}
+	fwrite(jitSource, 1, jitLength, fp);
+	fclose(fp);
+
+	sprintf(command, JIT_COMMAND, compiler, library, source);
+	if (system(command) != 0)
+	{
+		printf("jit: '%s' failed\n", command);
+		return NULL;
+	}
+	*cached = 0;
+	return LoadLibraryScene(library);
+}
+
+void* AlignedAlloc(size_t size, size_t align)
+{
+	//һ,ԭʼָڶַǰ
+	void* raw = malloc(size + align + sizeof(void*));
+	if (!raw)
+	{
+		return NULL;
+	}
+	size_t addr = ((size_t)raw + sizeof(void*) + align - 1) & ~(align - 1);
+	((void**)addr)[-1] = raw;
+	return (void*)addr;
+}
+
+void AlignedFree(void* p)
+{
+	if (p)
+	{
+		free(((void**)p)[-1]);
+	}
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / LIGHT_COUNT);
+}
+
+#include "sdf.inc"
+#include "trace.inc"
+//
+//
+////DOC:
+////JIT
+//Ԥ֮,ֵһͼԪswitchѭ,CircleSDFСͼԪֻмָ,֧ȡĿռ˴ͷ
+//ʱ,û½һдScene,ʱɴ:
+//1.LoadSceneı,ÿ" Ϸʽ  ...",ͶӦSDFһ;-dumpóдʽ
+//  Ҫֵ,˵㡢εĶ㲻غ,εı3255,ܾļ
+//2.EmitSceneԤõͼԪдC,дɳ,κεѭչ,õһûз֧תJitScene
+//3.CompileSceneԴϣ,ǰĿ¼jit_scene_<ϣ>.so/.dllֱӼ,ñ
+//  (Ĭcccl,ûCCָ)ɶ̬,dlopen/LoadLibraryȡJitScene
+//4.ɵĴPreparedScene˳ȫһ,mainȱȽߵĽ,Բϡʧܡ
+//  ûб߼-nojitʱ˻ؽִ
+//LinuxʱҪ-ldl
@@ -0,0 +1,568 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//׷(ӹԴ)
+#define PHOTON_COUNT              (1 << 21)  //ӹԴĹ
+#define PHOTON_BATCH              (1024)     //ÿһηĹ,֮䰴η߳
+#define REFERENCE_COUNT           (1024)     //-compareʱοͼÿصĹ
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+//Բ,ӹԴ׷ʱҪ֪﷢,SDF
+typedef struct
+{
+	float cx, cy, radius;
+	Color emissive;
+} Light;
+
+typedef struct
+{
+	const char* name;
+	TraceResult (*scene)(float x, float y);
+	const Light* lights;
+	int count;
+} SceneDesc;
+
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+byte image[WIDTH * HEIGHT * RGB];
+
+Color splatted[WIDTH * HEIGHT], gathered[WIDTH * HEIGHT], reference[WIDTH * HEIGHT];
+
+TraceResult (*Scene)(float x, float y);
+
+const Light refractLights[] =
+{
+	{ 1.05f, 1.05f, 0.05f, { 5.0f, 5.0f, 5.0f } },
+	{ -0.05f, 1.05f, 0.05f, { 5.0f, 5.0f, 5.0f } },
+	{ 1.05f, -0.05f, 0.05f, { 5.0f, 5.0f, 5.0f } },
+	{ -0.05f, -0.05f, 0.05f, { 5.0f, 5.0f, 5.0f } },
+};
+
+const Light beerLambertLights[] =
+{
+	{ 0.5f, -0.2f, 0.1f, { 10.0f, 10.0f, 10.0f } },
+};
+
+const Light reflectLights[] =
+{
+	{ 0.4f, 0.2f, 0.1f, { 2.0f, 2.0f, 2.0f } },
+};
+
+TraceResult RefractScene(float x, float y);
+
+TraceResult BeerLambertScene(float x, float y);
+
+TraceResult ReflectScene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, unsigned int* seed, int count);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+void RenderGather(Color* out, int count);
+
+void RenderLightTrace(Color* out, const Light* lights, int count);
+
+void TracePhoton(Color* buffer, const Light* lights, int count, float total, unsigned int* seed);
+
+void Splat(Color* buffer, float ox, float oy, float dx, float dy, float length, Color flux, Color absorption);
+
+double RMSE(const Color* a, const Color* b);
+
+void WriteImage(const Color* c, const char* path);
+
+int main(int argc, char* argv[])
+{
+	//LightTraceMain [] [-compare] : -compareʱռһ,REFERENCE_COUNTߵĲοͼȽ
+	const SceneDesc scenes[] =
+	{
+		{ "fresnel", RefractScene, refractLights, sizeof(refractLights) / sizeof(refractLights[0]) },
+		{ "beer_lambert", BeerLambertScene, beerLambertLights, sizeof(beerLambertLights) / sizeof(beerLambertLights[0]) },
+		{ "reflect", ReflectScene, reflectLights, sizeof(reflectLights) / sizeof(reflectLights[0]) },
+	};
+	const char* name = "fresnel";
+	int compare = 0;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-compare") == 0)
+		{
+			compare = 1;
+		}
+		else
+		{
+			name = argv[i];
+		}
+	}
+
+	const SceneDesc* desc = NULL;
+	for (int i = 0; i < (int)(sizeof(scenes) / sizeof(scenes[0])); ++i)
+	{
+		if (strcmp(scenes[i].name, name) == 0)
+		{
+			desc = &scenes[i];
+		}
+	}
+	if (desc == NULL)
+	{
+		printf("unknown scene %s\n", name);
+		return 1;
+	}
+	Scene = desc->scene;
+
+	char path[256];
+	double start = Now();
+	RenderLightTrace(splatted, desc->lights, desc->count);
+	double splatTime = Now() - start;
+	printf("light trace %d photons: %.2fs\n", PHOTON_COUNT, splatTime);
+	sprintf(path, "..//..//png//light_trace_%s.png", desc->name);
+	WriteImage(splatted, path);
+
+	if (compare)
+	{
+		start = Now();
+		RenderGather(gathered, LIGHT_COUNT);
+		double gatherTime = Now() - start;
+		printf("gather %d rays per pixel: %.2fs\n", LIGHT_COUNT, gatherTime);
+		sprintf(path, "..//..//png//light_trace_%s_gather.png", desc->name);
+		WriteImage(gathered, path);
+
+		start = Now();
+		RenderGather(reference, REFERENCE_COUNT);
+		printf("reference %d rays per pixel: %.2fs\n", REFERENCE_COUNT, Now() - start);
+
+		//ƽͺʱɷ,rmse^2*ԽС,ͬCPUʱԽ
+		double splatError = RMSE(splatted, reference), gatherError = RMSE(gathered, reference);
+		printf("light trace rmse %.4f, rmse^2*s %.5f\n", splatError, splatError * splatError * splatTime);
+		printf("gather      rmse %.4f, rmse^2*s %.5f\n", gatherError, gatherError * gatherError * gatherTime);
+	}
+
+	printf("Svnpng Success\n");
+	return 0;
+}
+
+void RenderGather(Color* out, int count)
+{
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			unsigned int seed = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+			out[y * WIDTH + x] = Sample((float)x / WIDTH, (float)y / HEIGHT, &seed, count);
+		}
+	}
+}
+
+void RenderLightTrace(Color* out, const Light* lights, int count)
+{
+	//ÿ߳һԼۼӻ,ĸϼӶü,ٺϲ
+#ifdef _OPENMP
+	int threads = omp_get_max_threads();
+#else
+	int threads = 1;
+#endif
+	Color* buffers = (Color*)calloc((size_t)threads * WIDTH * HEIGHT, sizeof(Color));
+
+	float total = 0.0f;
+	for (int i = 0; i < count; ++i)
+	{
+		const Color* e = &lights[i].emissive;
+		total += TWO_PI * lights[i].radius * (e->r + e->g + e->b);
+	}
+
+#pragma omp parallel for schedule(dynamic)
+	for (int batch = 0; batch < PHOTON_COUNT / PHOTON_BATCH; ++batch)
+	{
+#ifdef _OPENMP
+		Color* buffer = buffers + (size_t)omp_get_thread_num() * WIDTH * HEIGHT;
+#else
+		Color* buffer = buffers;
+#endif
+		unsigned int seed = (unsigned int)batch * 9781u + 1u;
+		for (int i = 0; i < PHOTON_BATCH; ++i)
+		{
+			TracePhoton(buffer, lights, count, total, &seed);
+		}
+	}
+
+	//ۼӵǹͨxصĳ,õͨܶ,ٳ2PIõSampleһķƽ
+	float scale = (float)WIDTH * HEIGHT / TWO_PI;
+#pragma omp parallel for
+	for (int i = 0; i < WIDTH * HEIGHT; ++i)
+	{
+		Color sum = COLOR_BLACK;
+		for (int t = 0; t < threads; ++t)
+		{
+			sum = ColorAdd(sum, buffers[(size_t)t * WIDTH * HEIGHT + i]);
+		}
+		out[i] = ColorScale(sum, scale);
+
+		//ԴڲûйӾ,TraceڹԴڲľǹԴ
+		float x = (float)(i % WIDTH) / WIDTH, y = (float)(i / WIDTH) / HEIGHT;
+		for (int k = 0; k < count; ++k)
+		{
+			if (CircleSDF(x, y, lights[k].cx, lights[k].cy, lights[k].radius) < 0.0f)
+			{
+				out[i] = lights[k].emissive;
+			}
+		}
+	}
+	free(buffers);
+}
+
+void TracePhoton(Color* buffer, const Light* lights, int count, float total, unsigned int* seed)
+{
+	//һԴ,Դÿλⷢͨ2*emissive
+	float pick = Random(seed) * total;
+	int k = 0;
+	while (k < count - 1 && pick > TWO_PI * lights[k].radius * (lights[k].emissive.r + lights[k].emissive.g + lights[k].emissive.b))
+	{
+		pick -= TWO_PI * lights[k].radius * (lights[k].emissive.r + lights[k].emissive.g + lights[k].emissive.b);
+		++k;
+	}
+	const Color* e = &lights[k].emissive;
+	Color flux = ColorScale(*e, 2.0f * total / ((e->r + e->g + e->b) * PHOTON_COUNT));
+
+	//ԲϾȡ,ҷֲ:sin(theta)[-1,1]Ͼ
+	float radians = TWO_PI * Random(seed);
+	float nx = cosf(radians), ny = sinf(radians);
+	float s = 2.0f * Random(seed) - 1.0f, c = sqrtf(1.0f - s * s);
+	float dx = nx * c - ny * s, dy = ny * c + nx * s;
+	float ox = lights[k].cx + nx * (lights[k].radius + RAY_BIAS);
+	float oy = lights[k].cy + ny * (lights[k].radius + RAY_BIAS);
+	Color absorption = COLOR_BLACK;
+
+	//TraceĵݹһһӦ:RAY_MAX_TRACE_STEPη/,ÿһζ˥
+	for (int depth = 0; depth <= RAY_MAX_TRACE_STEP; ++depth)
+	{
+		float t = 1e-3f;
+		float sign = Scene(ox, oy).sdf > 0.0f ? 1.0f : -1.0f;
+		TraceResult r;
+		int hit = 0;
+		for (int i = 0; i < RAY_MARCHING_MAX_STEP && t < RAY_MARCHING_MAX_DISTANCE; ++i)
+		{
+			r = Scene(ox + dx * t, oy + dy * t);
+			if (r.sdf * sign < EPSILON)
+			{
+				hit = 1;
+				break;
+			}
+			t += r.sdf * sign;
+		}
+		Splat(buffer, ox, oy, dx, dy, fminf(t, RAY_MARCHING_MAX_DISTANCE), flux, absorption);
+
+		//ֻֻյı,ӵΪֹ
+		if (!hit || depth == RAY_MAX_TRACE_STEP || (r.reflectivity <= 0.0f && r.eta <= 0.0f))
+		{
+			break;
+		}
+
+		float x = ox + dx * t, y = oy + dy * t;
+		float gx, gy, rx, ry;
+		flux = ColorMultiply(flux, BeerLambert(absorption, t));
+		Gradient(x, y, &gx, &gy);
+		gx *= sign;
+		gy *= sign;
+
+		//Traceﷴ䰴,ﰴͬıѡһ,ӵͨ
+		float reflect = r.reflectivity;
+		int refracted = 0;
+		if (r.eta > 0.0f)
+		{
+			float eta = sign < 0.0f ? r.eta : 1.0f / r.eta;
+			if (REFRACT == Refract(dx, dy, gx, gy, eta, &rx, &ry))
+			{
+				float cosi = -(dx * gx + dy * gy);
+				float cost = -(rx * gx + ry * gy);
+				reflect = sign < 0.0f ? Fresnel(cosi, cost, r.eta, 1.0f) : Fresnel(cosi, cost, 1.0f, r.eta);
+				refracted = Random(seed) >= reflect;
+				//Traceʱԭȥ,ûг֮;Ҫͬһͼ,ͨҪeta
+				if (refracted)
+				{
+					flux = ColorScale(flux, eta);
+				}
+			}
+			else
+			{
+				reflect = 1.0f;
+			}
+		}
+
+		if (refracted)
+		{
+			ox = x - gx * RAY_BIAS;
+			oy = y - gy * RAY_BIAS;
+		}
+		else if (Random(seed) < reflect || r.eta > 0.0f)
+		{
+			//ʱûѡһǷ;1-reflectivityĸʱ
+			Reflect(dx, dy, gx, gy, &rx, &ry);
+			ox = x + gx * RAY_BIAS;
+			oy = y + gy * RAY_BIAS;
+		}
+		else
+		{
+			break;
+		}
+		dx = rx;
+		dy = ry;
+		absorption = r.absorption;
+	}
+}
+
+void Splat(Color* buffer, float ox, float oy, float dx, float dy, float length, Color flux, Color absorption)
+{
+	//,(x,y)Ĳ(x/WIDTH,y/HEIGHT),ĸ[x-0.5,x+0.5)
+	float px = ox * WIDTH + 0.5f, py = oy * HEIGHT + 0.5f;
+	float vx = dx * WIDTH, vy = dy * HEIGHT;
+
+	//߶βüͼΧ
+	float t0 = 0.0f, t1 = length;
+	float p[2] = { px, py }, v[2] = { vx, vy }, size[2] = { (float)WIDTH, (float)HEIGHT };
+	for (int a = 0; a < 2; ++a)
+	{
+		if (fabsf(v[a]) < 1e-12f)
+		{
+			if (p[a] < 0.0f || p[a] >= size[a])
+			{
+				return;
+			}
+			continue;
+		}
+		float ta = (0.0f - p[a]) / v[a], tb = (size[a] - p[a]) / v[a];
+		t0 = fmaxf(t0, fminf(ta, tb));
+		t1 = fminf(t1, fmaxf(ta, tb));
+	}
+	if (t0 >= t1)
+	{
+		return;
+	}
+
+	//߶(DDA),ÿؼ ͨx߹ĳ
+	int ix = (int)(px + vx * t0), iy = (int)(py + vy * t0);
+	ix = ix < 0 ? 0 : (ix >= WIDTH ? WIDTH - 1 : ix);
+	iy = iy < 0 ? 0 : (iy >= HEIGHT ? HEIGHT - 1 : iy);
+	int stepX = vx > 0.0f ? 1 : -1, stepY = vy > 0.0f ? 1 : -1;
+	float deltaX = fabsf(vx) > 1e-12f ? fabsf(1.0f / vx) : 1e30f;
+	float deltaY = fabsf(vy) > 1e-12f ? fabsf(1.0f / vy) : 1e30f;
+	float nextX = fabsf(vx) > 1e-12f ? ((vx > 0.0f ? ix + 1 : ix) - px) / vx : 1e30f;
+	float nextY = fabsf(vy) > 1e-12f ? ((vy > 0.0f ? iy + 1 : iy) - py) / vy : 1e30f;
+	int absorbing = absorption.r > 0.0f || absorption.g > 0.0f || absorption.b > 0.0f;
+
+	float t = t0;
+	while (t < t1)
+	{
+		float next = fminf(fminf(nextX, nextY), t1);
+		Color c = ColorScale(flux, next - t);
+		if (absorbing)
+		{
+			c = ColorMultiply(c, BeerLambert(absorption, (t + next) * 0.5f));
+		}
+		buffer[iy * WIDTH + ix] = ColorAdd(buffer[iy * WIDTH + ix], c);
+		t = next;
+
+		if (nextX < nextY)
+		{
+			ix += stepX;
+			nextX += deltaX;
+		}
+		else
+		{
+			iy += stepY;
+			nextY += deltaY;
+		}
+		if (ix < 0 || ix >= WIDTH || iy < 0 || iy >= HEIGHT)
+		{
+			break;
+		}
+	}
+}
+
+double RMSE(const Color* a, const Color* b)
+{
+	double sum = 0.0;
+	for (int i = 0; i < WIDTH * HEIGHT; ++i)
+	{
+		double dr = fminf(a[i].r, 1.0f) - fminf(b[i].r, 1.0f);
+		double dg = fminf(a[i].g, 1.0f) - fminf(b[i].g, 1.0f);
+		double db = fminf(a[i].b, 1.0f) - fminf(b[i].b, 1.0f);
+		sum += dr * dr + dg * dg + db * db;
+	}
+	return sqrt(sum / (WIDTH * HEIGHT * RGB));
+}
+
+void WriteImage(const Color* c, const char* path)
+{
+	byte* p = image;
+	for (int i = 0; i < WIDTH * HEIGHT; ++i)
+	{
+		p[0] = (int)(fminf(c[i].r * 255.0f, 255.0f));
+		p[1] = (int)(fminf(c[i].g * 255.0f, 255.0f));
+		p[2] = (int)(fminf(c[i].b * 255.0f, 255.0f));
+		p += RGB;
+	}
+
+	FILE* fp = fopen(path, "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed, int count)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < count; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / count;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / count);
+}
+
+#include "sdf.inc"
+#include "trace.inc"
+
+TraceResult RefractScene(float x, float y)
+{
+	x = fabsf(x - 0.5f) + 0.5f;
+	TraceResult a = { CapsuleSDF(x, y, 0.75f, 0.25f, 0.75f, 0.75f, 0.05f), 0.2f, 1.5f, COLOR_BLACK, COLOR_BLACK };
+	TraceResult b = { CapsuleSDF(x, y, 0.75f, 0.25f, 0.50f, 0.75f, 0.05f), 0.2f, 1.5f, COLOR_BLACK, COLOR_BLACK };
+	y = fabsf(y - 0.5f) + 0.5f;
+	TraceResult c = { CircleSDF(x, y, 1.05f, 1.05f, 0.05f), 0.0f, 0.0f, { 5.0f, 5.0f, 5.0f }, COLOR_BLACK };
+	return Union(a, Union(b, c));
+}
+
+TraceResult BeerLambertScene(float x, float y)
+{
+	TraceResult a = { CircleSDF(x, y, 0.5f, -0.2f, 0.1f), 0.0f, 0.0f, { 10.0f, 10.0f, 10.0f }, COLOR_BLACK };
+	TraceResult b = { NgonSDF(x, y, 0.5f, 0.5f, 0.25f, 5.0f), 0.0f, 1.5f, COLOR_BLACK, { 4.0f, 4.0f, 1.0f } };
+	return Union(a, b);
+}
+
+TraceResult ReflectScene(float x, float y)
+{
+	TraceResult a = { CircleSDF(x, y, 0.4f, 0.2f, 0.1f), 0.0f, 0.0f, { 2.0f, 2.0f, 2.0f }, COLOR_BLACK };
+	TraceResult b = { BoxSDF(x, y, 0.5f, 0.8f, TWO_PI / 16.0f, 0.1f, 0.1f), 0.9f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+	TraceResult c = { BoxSDF(x, y, 0.8f, 0.5f, TWO_PI / 16.0f, 0.1f, 0.1f), 0.9f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+	return Union(Union(a, b), c);
+}
+
+//
+//
+////DOC:
+////ӹԴĹ׷
+//SampleǴռ,ɢ(⾭۵)ֻǡóǸ򶶶Ĺ߲ſõ,
+//Ҫȥ
+//ӹԴ:
+//1.һԴ,ԲϾȡ,ҷֲȡ䷽
+//2.;ÿض ͨx߹ĳ(ά"·ȹ"),߶ζй,
+//  ֻǶ˵,ܿ
+//3.򵽲/ʱFresnelķѡ,ӵͨ,Traceﰴһ;
+//  RAY_MAX_TRACE_STEP,ÿΰabsorption˥,ҲTraceһ
+//4.ۼӵĽõͨܶ,ٳ2PISampleķƽֵ,ַĽֱӱȽ
+//߳ʱÿ߳дԼĻ,ϲ,֮䲻Ҫκͬ
+//ԴҪ(Light),ΪSDFֻܻش"״Զ",ش"﷢"
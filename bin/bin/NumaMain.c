@@ -0,0 +1,590 @@
+#ifdef __linux__
+#define _GNU_SOURCE  //sched_setaffinityCPU_SET
+#endif
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef __linux__
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//NUMA
+#define MAX_NODES                 (16)
+#define MAX_CPUS                  (256)
+#define TILE_SIZE                 (32)     //WIDTHHEIGHTı
+#define TILE_X                    (WIDTH / TILE_SIZE)
+#define TILE_Y                    (HEIGHT / TILE_SIZE)
+#define TILE_COUNT                (TILE_X * TILE_Y)
+#define TILE_PIXELS               (TILE_SIZE * TILE_SIZE)
+#define PAGE_SIZE                 (4096)
+#define SCENE_BYTES               ((sizeof(SceneData) + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE)  //ռҳ,ͱݹҳ
+#define TILE_BYTES                (sizeof(Color) * WIDTH * HEIGHT)  //һtile12288ֽ,3ҳ,ҳ߽翪ʼʱûҳtile
+
+//
+#define CIRCLE_COUNT              (13)
+#define MATERIAL_LIGHT            (0)
+#define MATERIAL_GLASS            (1)
+#define MATERIAL_COUNT            (2)
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+typedef struct { float cx, cy, radius; int material; } Circle;
+
+//ֻ,ÿڵһ
+typedef struct
+{
+	TraceResult materials[MATERIAL_COUNT];
+	Circle circles[CIRCLE_COUNT];
+} SceneData;
+
+typedef struct
+{
+	int cpuCount;
+	int cpus[MAX_CPUS];
+} NumaNode;
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+byte image[WIDTH * HEIGHT * RGB];
+
+NumaNode nodes[MAX_NODES];
+int nodeCount;
+
+#ifdef __linux__
+cpu_set_t processMask;  //ʱʹõCPU,󶨵ָ߳
+#endif
+
+SceneData sharedScene;
+SceneData* nodeScenes[MAX_NODES];
+int nodeSceneReady[MAX_NODES];
+
+//Scene()ĳ,ÿָ߳ԼڵϵǷ
+const SceneData* localScene;
+#pragma omp threadprivate(localScene)
+
+Color* tiles[TILE_COUNT];    //ÿtileɫ,TILE_PIXELS
+int nextTile[MAX_NODES + 1]; //ÿڵһҪȡtile,ڵkӵ[tileBegin[k], tileBegin[k + 1])
+int tileBegin[MAX_NODES + 1];
+
+TraceResult Scene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+int ParseCpuList(const char* text, int* cpus, int max);
+
+void DetectTopology();
+
+void PinThread(int cpu);
+
+void BuildScene(SceneData* scene);
+
+void* AllocPages(size_t size);
+
+void FreePages(void* p, size_t size);
+
+void AllocTiles();
+
+void RenderTile(int tile, Color* out);
+
+int NextTile(int node, int usedNodes);
+
+double RenderNaive(int threads);
+
+double RenderNuma(int usedNodes);
+
+void ToImage();
+
+int main(int argc, char* argv[])
+{
+	//NumaMain [-bench] : -benchֱǰ1..nodeCountڵCPU,ȽϲNUMAͰڵõʱ
+	DetectTopology();
+	BuildScene(&sharedScene);
+
+	for (int k = 0; k < nodeCount; ++k)
+	{
+		printf("node %d: %d cpus\n", k, nodes[k].cpuCount);
+	}
+
+	if (argc > 1 && strcmp(argv[1], "-bench") == 0)
+	{
+		int threads = 0;
+		for (int n = 1; n <= nodeCount; ++n)
+		{
+			threads += nodes[n - 1].cpuCount;
+			double naive = RenderNaive(threads);
+			double numa = RenderNuma(n);
+			printf("%d nodes %3d threads: naive %.3fs, numa %.3fs, speedup %.2fx\n", n, threads, naive, numa, naive / numa);
+		}
+	}
+	else
+	{
+		printf("render: %.3fs\n", RenderNuma(nodeCount));
+	}
+
+	ToImage();
+	for (int k = 0; k < nodeCount; ++k)
+	{
+		FreePages(nodeScenes[k], SCENE_BYTES);
+	}
+	FreePages(tiles[0], TILE_BYTES);
+	FILE* fp = fopen("..//..//png//numa.png", "wb");
+	if (fp)
+	{
+		svpng(fp, WIDTH, HEIGHT, image, 0);
+		fclose(fp);
+	}
+	return 0;
+}
+
+int ParseCpuList(const char* text, int* cpus, int max)
+{
+	//sysfscpulistʽ: "0-3,8-11"
+	int count = 0;
+	const char* p = text;
+	while (*p >= '0' && *p <= '9')
+	{
+		char* end;
+		int first = (int)strtol(p, &end, 10), last = first;
+		if (*end == '-')
+		{
+			last = (int)strtol(end + 1, &end, 10);
+		}
+		for (int cpu = first; cpu <= last && count < max; ++cpu)
+		{
+			cpus[count++] = cpu;
+		}
+		p = *end == ',' ? end + 1 : end;
+	}
+	return count;
+}
+
+void DetectTopology()
+{
+	//Linux¶/sys/devices/system/node/node*/cpulist,ֻʹõCPU,ûCPUĽڵ(ֻڴ);
+	//ƽ̨͵һڵ,߳
+	nodeCount = 0;
+#ifdef __linux__
+	sched_getaffinity(0, sizeof(processMask), &processMask);
+	for (int n = 0; n < MAX_NODES * 4 && nodeCount < MAX_NODES; ++n)
+	{
+		char path[64], line[4096];
+		sprintf(path, "/sys/devices/system/node/node%d/cpulist", n);
+		FILE* fp = fopen(path, "r");
+		if (!fp)
+		{
+			continue;
+		}
+		int cpus[MAX_CPUS];
+		int count = fgets(line, sizeof(line), fp) ? ParseCpuList(line, cpus, MAX_CPUS) : 0;
+		fclose(fp);
+
+		NumaNode* node = &nodes[nodeCount];
+		node->cpuCount = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			if (cpus[i] < CPU_SETSIZE && CPU_ISSET(cpus[i], &processMask))
+			{
+				node->cpus[node->cpuCount++] = cpus[i];
+			}
+		}
+		nodeCount += node->cpuCount > 0;
+	}
+#endif
+	if (nodeCount == 0)
+	{
+#ifdef _OPENMP
+		int count = omp_get_num_procs();
+#else
+		int count = 1;
+#endif
+		nodeCount = 1;
+		nodes[0].cpuCount = count < MAX_CPUS ? count : MAX_CPUS;
+		for (int i = 0; i < nodes[0].cpuCount; ++i)
+		{
+			nodes[0].cpus[i] = -1;
+		}
+	}
+}
+
+void PinThread(int cpu)
+{
+	//cpuС0ʱָɽԭCPU,OpenMP̳߳ػһ
+#ifdef __linux__
+	if (cpu < 0)
+	{
+		sched_setaffinity(0, sizeof(processMask), &processMask);
+	}
+	else
+	{
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		sched_setaffinity(0, sizeof(set), &set);
+	}
+#else
+	(void)cpu;
+#endif
+}
+
+void BuildScene(SceneData* scene)
+{
+	TraceResult light = { 0.0f, 0.0f, 0.0f, { 6.0f, 5.0f, 4.0f }, COLOR_BLACK };
+	TraceResult glass = { 0.0f, 0.0f, 1.5f, COLOR_BLACK, { 1.0f, 3.0f, 4.0f } };
+	scene->materials[MATERIAL_LIGHT] = light;
+	scene->materials[MATERIAL_GLASS] = glass;
+
+	//мһԴ,һȦ
+	Circle center = { 0.5f, 0.5f, 0.08f, MATERIAL_LIGHT };
+	scene->circles[0] = center;
+	for (int i = 1; i < CIRCLE_COUNT; ++i)
+	{
+		float a = TWO_PI * i / (CIRCLE_COUNT - 1);
+		Circle c = { 0.5f + 0.3f * cosf(a), 0.5f + 0.3f * sinf(a), 0.05f, MATERIAL_GLASS };
+		scene->circles[i] = c;
+	}
+}
+
+void* AllocPages(size_t size)
+{
+	//ÿζϵͳҪȫµġҳڴ,ҳڵһдʱŷ,д߳ڵĽڵ;
+	//mallocͷźٷͬСʱûһ߳Ѿҳ,ߺͱݼͬһҳ
+#if defined(__linux__)
+	void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	return p == MAP_FAILED ? NULL : p;
+#elif defined(_WIN32)
+	return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+	return malloc(size);
+#endif
+}
+
+void FreePages(void* p, size_t size)
+{
+	if (!p)
+	{
+		return;
+	}
+#if defined(__linux__)
+	munmap(p, size);
+#elif defined(_WIN32)
+	(void)size;
+	VirtualFree(p, 0, MEM_RELEASE);
+#else
+	(void)size;
+	free(p);
+#endif
+}
+
+void AllocTiles()
+{
+	//ÿȾһµĻ,˭дҳĸڵ
+	FreePages(tiles[0], TILE_BYTES);
+	Color* buffer = (Color*)AllocPages(TILE_BYTES);
+	if (!buffer)
+	{
+		printf("out of memory\n");
+		exit(1);
+	}
+	for (int i = 0; i < TILE_COUNT; ++i)
+	{
+		tiles[i] = buffer + (size_t)i * TILE_PIXELS;
+	}
+}
+
+void RenderTile(int tile, Color* out)
+{
+	int x0 = tile % TILE_X * TILE_SIZE, y0 = tile / TILE_X * TILE_SIZE;
+	for (int y = y0; y < y0 + TILE_SIZE; ++y)
+	{
+		for (int x = x0; x < x0 + TILE_SIZE; ++x)
+		{
+			unsigned int s = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+			out[(y - y0) * TILE_SIZE + x - x0] = Sample((float)x / WIDTH, (float)y / HEIGHT, &s);
+		}
+	}
+}
+
+int NextTile(int node, int usedNodes)
+{
+	//ȡԼڵtile,ȡٴڵ͵,ֻ󼸸tileдԶڴ
+	int tile = -1;
+#pragma omp critical(tileQueue)
+	for (int k = 0; k < usedNodes && tile < 0; ++k)
+	{
+		int n = (node + k) % usedNodes;
+		if (nextTile[n] < tileBegin[n + 1])
+		{
+			tile = nextTile[n]++;
+		}
+	}
+	return tile;
+}
+
+double RenderNaive(int threads)
+{
+	//:̷߳䲢黺,ҳȫ߳ڵĽڵ,̹߳һݳ,
+	double start = Now();
+	AllocTiles();
+	memset(tiles[0], 0, TILE_BYTES);
+
+#pragma omp parallel num_threads(threads)
+	{
+		localScene = &sharedScene;
+#pragma omp for schedule(dynamic)
+		for (int i = 0; i < TILE_COUNT; ++i)
+		{
+			RenderTile(i, tiles[i]);
+		}
+	}
+	return Now() - start;
+}
+
+double RenderNuma(int usedNodes)
+{
+	//t̰߳󶨵ڵ˳еĵtCPU
+	int cpuOf[MAX_CPUS], nodeOf[MAX_CPUS], localIndex[MAX_CPUS];
+	int threads = 0;
+	for (int k = 0; k < usedNodes; ++k)
+	{
+		for (int i = 0; i < nodes[k].cpuCount && threads < MAX_CPUS; ++i)
+		{
+			cpuOf[threads] = nodes[k].cpus[i];
+			nodeOf[threads] = k;
+			localIndex[threads++] = i;
+		}
+	}
+
+	double start = Now();
+
+	//tileطָڵ;Ȳ,ҳڵһдʱŷ䵽д߳ڵĽڵ
+	AllocTiles();
+	for (int k = 0; k <= usedNodes; ++k)
+	{
+		tileBegin[k] = nextTile[k] = TILE_COUNT * k / usedNodes;
+	}
+	for (int k = 0; k < usedNodes; ++k)
+	{
+		FreePages(nodeScenes[k], SCENE_BYTES);
+		nodeScenes[k] = NULL;
+		nodeSceneReady[k] = 0;
+	}
+
+#ifdef _OPENMP
+	omp_set_dynamic(0);
+#endif
+#pragma omp parallel num_threads(threads)
+	{
+#ifdef _OPENMP
+		int t = omp_get_thread_num();
+#else
+		int t = 0;
+#endif
+		int node = nodeOf[t];
+		PinThread(cpuOf[t]);
+
+		//ڵȵ̷߳䲢Ƴ(Ѿ,first-touchҳڱڵ),󵽵̶߳һ;
+		//ʧܾ˻عõĳ
+#pragma omp critical(sceneCopy)
+		if (!nodeSceneReady[node])
+		{
+			nodeScenes[node] = (SceneData*)AllocPages(SCENE_BYTES);
+			if (nodeScenes[node])
+			{
+				memcpy(nodeScenes[node], &sharedScene, sizeof(SceneData));
+			}
+			nodeSceneReady[node] = 1;
+		}
+		localScene = nodeScenes[node] ? nodeScenes[node] : &sharedScene;
+
+		//first-touch:ڵ߳Ȱѱڵtile,ԺȾʱڴ
+		int stride = nodes[node].cpuCount;
+		for (int i = tileBegin[node] + localIndex[t]; i < tileBegin[node + 1]; i += stride)
+		{
+			memset(tiles[i], 0, sizeof(Color) * TILE_PIXELS);
+		}
+#pragma omp barrier
+
+		for (int i = NextTile(node, usedNodes); i >= 0; i = NextTile(node, usedNodes))
+		{
+			RenderTile(i, tiles[i]);
+		}
+		PinThread(-1);
+	}
+	return Now() - start;
+}
+
+void ToImage()
+{
+#pragma omp parallel for
+	for (int i = 0; i < TILE_COUNT; ++i)
+	{
+		int x0 = i % TILE_X * TILE_SIZE, y0 = i / TILE_X * TILE_SIZE;
+		for (int j = 0; j < TILE_PIXELS; ++j)
+		{
+			Color c = tiles[i][j];
+			byte* p = &image[((y0 + j / TILE_SIZE) * WIDTH + x0 + j % TILE_SIZE) * RGB];
+			p[0] = (int)(fminf(c.r * 255.0f, 255.0f));
+			p[1] = (int)(fminf(c.g * 255.0f, 255.0f));
+			p[2] = (int)(fminf(c.b * 255.0f, 255.0f));
+		}
+	}
+}
+
+TraceResult Scene(float x, float y)
+{
+	const SceneData* scene = localScene;
+	int nearest = 0;
+	float sdf = 1e30f;
+	for (int i = 0; i < CIRCLE_COUNT; ++i)
+	{
+		const Circle* c = &scene->circles[i];
+		float d = CircleSDF(x, y, c->cx, c->cy, c->radius);
+		if (d < sdf)
+		{
+			sdf = d;
+			nearest = i;
+		}
+	}
+	TraceResult r = scene->materials[scene->circles[nearest].material];
+	r.sdf = sdf;
+	return r;
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / LIGHT_COUNT);
+}
+
+#include "sdf.inc"
+#include "trace.inc"
+//
+//
+////DOC:
+////NUMA֪̰߳󶨺first-touch
+//·ÿCPUԼڴ,һ۵ڴҪ߻,ӳٺʹ;
+//LinuxĬϰҳ䵽һд߳ڵĽڵ,̷߳䲢黺ȫһڵ,
+//۵߳дÿtileԶ˷
+//1./sys/devices/system/node/node*/cpulistõÿڵCPU,sched_getaffinityĽȡ
+//2.t߳sched_setaffinity󶨵ڵ˳еĵtCPU,ǰָԭCPU
+//3.tileطָڵ,ÿȾmmap(WindowsVirtualAlloc)ȫµҳ,Ȳ,ɱڵ߳(first-touch),ҳڱڵ;
+//  һtile3ҳ,ҳڵ㡣malloc/free:ͷŵĿᱻһͬСmallocû,ҳһĽڵ
+//4.ÿڵһtile,߳ȡڵ,ȡȥĽڵ͵,ȻǾ
+//5.ֻÿڵ㸴һ,ɱڵϰ󶨺õ߳mmapҳд,threadprivatelocalSceneָ򱾽ڵǷ
+//-benchֱǰ12...ڵCPU,ͲκδȾȽʱ;
+//ֻһڵ߲Linuxʱһ,ֻ֤ȷ
@@ -0,0 +1,535 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+//svpngĬÿֽڵһfputc,ﻻдڴ,̲߳ļ,д̽д߳һfwrite
+//fileΪʱֽfputc,ԭĴȽ
+typedef struct
+{
+	unsigned char* data;
+	size_t size, capacity;
+	FILE* file;
+} PngBuffer;
+
+void PngPut(PngBuffer* png, unsigned char u);
+
+#define SVPNG_OUTPUT PngBuffer* png
+#define SVPNG_PUT(u) PngPut(png, (unsigned char)(u))
+#include "svpng.inc"
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//ˮ
+#define FRAME_COUNT               (24)
+#define FRAME_TIME                (1.0f / 24.0f)
+#define FRAME_SLOTS               (3)      //ͬʱˮ֡:һ֡Ⱦ,һ֡ڱ,һ֡д
+#define PNG_RESERVE               (WIDTH * HEIGHT * RGB + HEIGHT * 6 + 64)  //svpngѹ,Сǹ̶
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+//һ֡۴Ⱦ߳߳д߳,дصж,۵;֡ڴ
+typedef struct
+{
+	int frame;
+	Color hdr[WIDTH * HEIGHT];
+	byte ldr[WIDTH * HEIGHT * RGB];
+	PngBuffer png;
+	double renderTime, encodeTime, writeTime;
+} FrameSlot;
+
+#ifdef _WIN32
+typedef SRWLOCK Mutex;
+typedef CONDITION_VARIABLE Condition;
+typedef HANDLE Thread;
+#define THREAD_RETURN DWORD WINAPI
+typedef DWORD (WINAPI *ThreadFunc)(void*);
+#else
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t Condition;
+typedef pthread_t Thread;
+#define THREAD_RETURN void*
+typedef void* (*ThreadFunc)(void*);
+#endif
+
+//н,ŵ֡۵±,-1ʾûк֡
+typedef struct
+{
+	int items[FRAME_SLOTS + 1];
+	int head, count;
+	Mutex lock;
+	Condition notEmpty, notFull;
+} Queue;
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+FrameSlot slots[FRAME_SLOTS];
+
+Queue freeQueue, encodeQueue, writeQueue;
+
+float sceneTime;  //ֻȾ̶߳д,һ֡ȾŸ
+
+TraceResult Scene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+void QueueInit(Queue* q);
+
+void QueuePush(Queue* q, int item);
+
+int QueuePop(Queue* q);
+
+void StartThread(Thread* t, ThreadFunc func, void* arg);
+
+void JoinThread(Thread t);
+
+void RenderFrame(FrameSlot* slot);
+
+void ToneMap(FrameSlot* slot);
+
+void EncodeFrame(FrameSlot* slot);
+
+int WriteFrame(FrameSlot* slot);
+
+THREAD_RETURN EncodeStage(void* arg);
+
+THREAD_RETURN WriteStage(void* arg);
+
+double RunSerial(double* stageTime);
+
+double RunPipelined(double* stageTime);
+
+int main(int argc, char* argv[])
+{
+	//PipelineMain [-serial | -compare] : -serialԭһ֡Ⱦֽڱд;-compareֶһ
+	int serial = 0, pipelined = 1;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-serial") == 0)
+		{
+			serial = 1;
+			pipelined = 0;
+		}
+		else if (strcmp(argv[i], "-compare") == 0)
+		{
+			serial = 1;
+			pipelined = 1;
+		}
+	}
+
+	double stage[3];
+	if (serial)
+	{
+		double total = RunSerial(stage);
+		printf("serial    : %d frames %.2fs (render %.2fs, tonemap+encode+write %.2fs), %.1f fps\n",
+			FRAME_COUNT, total, stage[0], stage[1] + stage[2], FRAME_COUNT / total);
+	}
+	if (pipelined)
+	{
+		double total = RunPipelined(stage);
+		printf("pipelined : %d frames %.2fs (render %.2fs, tonemap+encode %.2fs, write %.2fs), %.1f fps\n",
+			FRAME_COUNT, total, stage[0], stage[1], stage[2], FRAME_COUNT / total);
+	}
+	return 0;
+}
+
+void PngPut(PngBuffer* png, unsigned char u)
+{
+	if (png->file)
+	{
+		fputc(u, png->file);
+		return;
+	}
+	if (png->size == png->capacity)
+	{
+		png->capacity = png->capacity ? png->capacity * 2 : PNG_RESERVE;
+		png->data = (unsigned char*)realloc(png->data, png->capacity);
+	}
+	png->data[png->size++] = u;
+}
+
+void QueueInit(Queue* q)
+{
+	q->head = q->count = 0;
+#ifdef _WIN32
+	InitializeSRWLock(&q->lock);
+	InitializeConditionVariable(&q->notEmpty);
+	InitializeConditionVariable(&q->notFull);
+#else
+	pthread_mutex_init(&q->lock, NULL);
+	pthread_cond_init(&q->notEmpty, NULL);
+	pthread_cond_init(&q->notFull, NULL);
+#endif
+}
+
+void QueuePush(Queue* q, int item)
+{
+	//˵λû,,;֡ᳬFRAME_SLOTS
+#ifdef _WIN32
+	AcquireSRWLockExclusive(&q->lock);
+	while (q->count == FRAME_SLOTS + 1)
+	{
+		SleepConditionVariableSRW(&q->notFull, &q->lock, INFINITE, 0);
+	}
+	q->items[(q->head + q->count++) % (FRAME_SLOTS + 1)] = item;
+	ReleaseSRWLockExclusive(&q->lock);
+	WakeConditionVariable(&q->notEmpty);
+#else
+	pthread_mutex_lock(&q->lock);
+	while (q->count == FRAME_SLOTS + 1)
+	{
+		pthread_cond_wait(&q->notFull, &q->lock);
+	}
+	q->items[(q->head + q->count++) % (FRAME_SLOTS + 1)] = item;
+	pthread_mutex_unlock(&q->lock);
+	pthread_cond_signal(&q->notEmpty);
+#endif
+}
+
+int QueuePop(Queue* q)
+{
+	int item;
+#ifdef _WIN32
+	AcquireSRWLockExclusive(&q->lock);
+	while (q->count == 0)
+	{
+		SleepConditionVariableSRW(&q->notEmpty, &q->lock, INFINITE, 0);
+	}
+	item = q->items[q->head];
+	q->head = (q->head + 1) % (FRAME_SLOTS + 1);
+	--q->count;
+	ReleaseSRWLockExclusive(&q->lock);
+	WakeConditionVariable(&q->notFull);
+#else
+	pthread_mutex_lock(&q->lock);
+	while (q->count == 0)
+	{
+		pthread_cond_wait(&q->notEmpty, &q->lock);
+	}
+	item = q->items[q->head];
+	q->head = (q->head + 1) % (FRAME_SLOTS + 1);
+	--q->count;
+	pthread_mutex_unlock(&q->lock);
+	pthread_cond_signal(&q->notFull);
+#endif
+	return item;
+}
+
+void StartThread(Thread* t, ThreadFunc func, void* arg)
+{
+#ifdef _WIN32
+	*t = CreateThread(NULL, 0, func, arg, 0, NULL);
+#else
+	pthread_create(t, NULL, func, arg);
+#endif
+}
+
+void JoinThread(Thread t)
+{
+#ifdef _WIN32
+	WaitForSingleObject(t, INFINITE);
+	CloseHandle(t);
+#else
+	pthread_join(t, NULL);
+#endif
+}
+
+void RenderFrame(FrameSlot* slot)
+{
+	double start = Now();
+	sceneTime = slot->frame * FRAME_TIME;
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			unsigned int s = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+			slot->hdr[y * WIDTH + x] = Sample((float)x / WIDTH, (float)y / HEIGHT, &s);
+		}
+	}
+	slot->renderTime = Now() - start;
+}
+
+void ToneMap(FrameSlot* slot)
+{
+	for (int i = 0; i < WIDTH * HEIGHT; ++i)
+	{
+		Color c = slot->hdr[i];
+		byte* p = &slot->ldr[i * RGB];
+		p[0] = (int)(fminf(c.r * 255.0f, 255.0f));
+		p[1] = (int)(fminf(c.g * 255.0f, 255.0f));
+		p[2] = (int)(fminf(c.b * 255.0f, 255.0f));
+	}
+}
+
+void EncodeFrame(FrameSlot* slot)
+{
+	//ڲﷴʹ,һ֮֡ٷڴ
+	double start = Now();
+	ToneMap(slot);
+	slot->png.size = 0;
+	slot->png.file = NULL;
+	svpng(&slot->png, WIDTH, HEIGHT, slot->ldr, 0);
+	slot->encodeTime = Now() - start;
+}
+
+int WriteFrame(FrameSlot* slot)
+{
+	double start = Now();
+	char path[64];
+	sprintf(path, "..//..//png//pipeline_%03d.png", slot->frame);
+	FILE* fp = fopen(path, "wb");
+	if (!fp)
+	{
+		return 0;
+	}
+	fwrite(slot->png.data, 1, slot->png.size, fp);
+	int ok = ferror(fp) == 0;
+	fclose(fp);
+	slot->writeTime = Now() - start;
+	return ok;
+}
+
+THREAD_RETURN EncodeStage(void* arg)
+{
+	double* busy = (double*)arg;
+	for (;;)
+	{
+		int i = QueuePop(&encodeQueue);
+		if (i >= 0)
+		{
+			EncodeFrame(&slots[i]);
+			*busy += slots[i].encodeTime;
+		}
+		QueuePush(&writeQueue, i);
+		if (i < 0)
+		{
+			return 0;
+		}
+	}
+}
+
+THREAD_RETURN WriteStage(void* arg)
+{
+	double* busy = (double*)arg;
+	for (;;)
+	{
+		int i = QueuePop(&writeQueue);
+		if (i < 0)
+		{
+			return 0;
+		}
+		if (!WriteFrame(&slots[i]))
+		{
+			printf("write frame %d failed\n", slots[i].frame);
+		}
+		*busy += slots[i].writeTime;
+		QueuePush(&freeQueue, i);
+	}
+}
+
+double RunSerial(double* stageTime)
+{
+	//ÿ֡Ⱦضϳ8λsvpngֽfputcд,һſʼһ
+	FrameSlot* slot = &slots[0];
+	stageTime[0] = stageTime[1] = stageTime[2] = 0.0;
+	double start = Now();
+	for (int frame = 0; frame < FRAME_COUNT; ++frame)
+	{
+		slot->frame = frame;
+		RenderFrame(slot);
+		stageTime[0] += slot->renderTime;
+
+		double t = Now();
+		char path[64];
+		sprintf(path, "..//..//png//pipeline_%03d.png", frame);
+		PngBuffer png = { NULL, 0, 0, fopen(path, "wb") };
+		if (png.file)
+		{
+			ToneMap(slot);
+			svpng(&png, WIDTH, HEIGHT, slot->ldr, 0);
+			fclose(png.file);
+		}
+		stageTime[1] += Now() - t;
+	}
+	return Now() - start;
+}
+
+double RunPipelined(double* stageTime)
+{
+	//Ⱦ߳,OpenMPճк;̺߳д̴߳󲿷ʱڵȶ,
+	//N+1֡ȾͬʱN֡ڱ롢N-1֡д,ʱӽֻȾʱ
+	QueueInit(&freeQueue);
+	QueueInit(&encodeQueue);
+	QueueInit(&writeQueue);
+	for (int i = 0; i < FRAME_SLOTS; ++i)
+	{
+		QueuePush(&freeQueue, i);
+	}
+
+	stageTime[0] = stageTime[1] = stageTime[2] = 0.0;
+	double start = Now();
+	Thread encoder, writer;
+	StartThread(&encoder, EncodeStage, &stageTime[1]);
+	StartThread(&writer, WriteStage, &stageTime[2]);
+
+	for (int frame = 0; frame < FRAME_COUNT; ++frame)
+	{
+		int i = QueuePop(&freeQueue);
+		slots[i].frame = frame;
+		RenderFrame(&slots[i]);
+		stageTime[0] += slots[i].renderTime;
+		QueuePush(&encodeQueue, i);
+	}
+	QueuePush(&encodeQueue, -1);
+
+	JoinThread(encoder);
+	JoinThread(writer);
+	return Now() - start;
+}
+
+TraceResult Scene(float x, float y)
+{
+	//Դת,⾵ת,ÿһ֡Ĺ·һ,ûһ֡
+	float angle = TWO_PI * sceneTime;
+	float lx = 0.5f + 0.3f * cosf(angle), ly = 0.5f + 0.3f * sinf(angle);
+	TraceResult light = { CircleSDF(x, y, lx, ly, 0.06f), 0.0f, 0.0f, { 6.0f, 5.0f, 4.0f }, COLOR_BLACK };
+	TraceResult prism = { BoxSDF(x, y, 0.5f, 0.5f, angle * 0.25f, 0.1f, 0.05f), 0.0f, 1.5f, COLOR_BLACK, { 1.0f, 3.0f, 4.0f } };
+	TraceResult mirror = { BoxSDF(x, y, 0.85f, 0.85f, 0.8f, 0.1f, 0.01f), 0.9f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+	return Union(Union(light, prism), mirror);
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / LIGHT_COUNT);
+}
+
+#include "sdf.inc"
+#include "trace.inc"
+//
+//
+////DOC:
+////Ⱦ롢дˮ
+//֡ʱ,ԭȾһ֡,svpngһֽһֽڵfputcдȥ,дȾһ֡;
+//дʱֻһ߳ڸɻ,ĺ˶
+//1.:Ⱦ(߳,OpenMP)ضϳ8λPNG(߳)дļ(д߳)
+//2.svpngSVPNG_OUTPUTSVPNG_PUTinclude֮ǰض,дڴ滺,
+//  ̲߳IO,д߳õһfwrite
+//3.֮нд֡۵±,һFRAME_SLOTS,;ʱȾ߳ڿжϵ,ڴ治;
+//  һ-1ȥ,߳˳
+//4.PNGʹ,ȶԺٷڴ
+//5.д̲һ֡Ⱦ,ֻҪǱȾ,ʱͽӽȾʱ;-compareӡʱ
+//WindowsSRWLOCKCONDITION_VARIABLECreateThread,ƽ̨pthread
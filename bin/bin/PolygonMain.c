@@ -0,0 +1,634 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//εļ
+#define CELL_EDGES                (4)      //ӱ߳ȡƽ߳ô౶,ĸԼô
+#define MAX_GRID                  (512)    //ÿô
+#define MAX_SEARCH_RING           (6)      //ҼȦ
+
+//
+#define GEAR_TEETH                (40)
+#define GEAR_TOOTH_POINTS         (100)    //ÿݵĶ
+#define GEAR_HOLE_POINTS          (400)
+#define SPIRAL_POINTS             (2000)
+#define BENCH_POINTS              (200000)
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+//,ж(Ƿ),㻷ж;
+//halfWidth0ʱÿǲպϵ,ȥ߿,û
+typedef struct
+{
+	int edgeCount;
+	float *ax, *ay, *ex, *ey, *invLength2;   //ߵ㡢ƽĵ
+	float halfWidth;
+	float minX, minY, cellSize;
+	int gridX, gridY;
+	int *cellStart, *cellIndex;              //iıcellIndex[cellStart[i]...cellStart[i+1]-1]
+	int *cellWinding;                        //ĵĻ
+	int *emptyRings;                         //бߵĸӸ˼Ȧ,⼸Ȧ
+} Polygon;
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+byte image[WIDTH * HEIGHT * RGB];
+
+Polygon gear, spiral;
+
+TraceResult Scene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+void BuildPolygon(Polygon* p, const float* points, const int* contourSizes, int contourCount, float halfWidth);
+
+void FreePolygon(Polygon* p);
+
+float PolygonSDF(const Polygon* p, float x, float y);
+
+float PolygonSDFBrute(const Polygon* p, float x, float y);
+
+void MakeGear(Polygon* p, float cx, float cy, float r, float tooth, float hole);
+
+void MakeSpiral(Polygon* p, float cx, float cy, float r0, float r1, float turns, float halfWidth);
+
+int main()
+{
+	double start = Now();
+	MakeGear(&gear, 0.5f, 0.52f, 0.22f, 0.025f, 0.07f);
+	MakeSpiral(&spiral, 0.17f, 0.17f, 0.015f, 0.12f, 4.0f, 0.003f);
+	printf("gear: %d edges, grid %dx%d; spiral: %d edges, grid %dx%d; build %.3fs\n",
+		gear.edgeCount, gear.gridX, gear.gridY, spiral.edgeCount, spiral.gridX, spiral.gridY, Now() - start);
+
+	//汾ľMAX_SEARCH_RINGȦʱ½,Ӧúһ,Ҳһ
+	const Polygon* polygons[2] = { &gear, &spiral };
+	for (int k = 0; k < 2; ++k)
+	{
+		const Polygon* p = polygons[k];
+		int signMismatch = 0, overEstimate = 0, exact = 0;
+		float minRatio = 1.0f;
+		unsigned int seed = 12345u;
+		for (int i = 0; i < BENCH_POINTS; ++i)
+		{
+			float x = Random(&seed) * 1.4f - 0.2f, y = Random(&seed) * 1.4f - 0.2f;
+			float a = PolygonSDF(p, x, y), b = PolygonSDFBrute(p, x, y);
+			signMismatch += (a < 0.0f) != (b < 0.0f);
+			overEstimate += fabsf(a) > fabsf(b) + 1e-5f;
+			exact += fabsf(a - b) <= 1e-5f;
+			minRatio = fminf(minRatio, fabsf(b) > 1e-2f ? a / b : 1.0f);
+		}
+
+		float sumA = 0.0f, sumB = 0.0f;
+		seed = 12345u;
+		double t0 = Now();
+		for (int i = 0; i < BENCH_POINTS; ++i)
+		{
+			float x = Random(&seed) * 1.4f - 0.2f, y = Random(&seed) * 1.4f - 0.2f;
+			sumA += PolygonSDF(p, x, y);
+		}
+		double t1 = Now();
+		seed = 12345u;
+		for (int i = 0; i < BENCH_POINTS; ++i)
+		{
+			float x = Random(&seed) * 1.4f - 0.2f, y = Random(&seed) * 1.4f - 0.2f;
+			sumB += PolygonSDFBrute(p, x, y);
+		}
+		double t2 = Now();
+		printf("%s: %d sign mismatches, %d overestimates, %.1f%% exact, lower bounds >= %.2f of the distance\n",
+			k == 0 ? "gear" : "spiral", signMismatch, overEstimate, 100.0 * exact / BENCH_POINTS, minRatio);
+		printf("  grid %.1f ns, brute %.1f ns, speedup %.1fx (%g %g)\n",
+			(t1 - t0) * 1e9 / BENCH_POINTS, (t2 - t1) * 1e9 / BENCH_POINTS, (t2 - t1) / (t1 - t0), sumA, sumB);
+	}
+
+	start = Now();
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			unsigned int s = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+			Color c = Sample((float)x / WIDTH, (float)y / HEIGHT, &s);
+			byte* p = &image[(y * WIDTH + x) * RGB];
+			p[0] = (int)(fminf(c.r * 255.0f, 255.0f));
+			p[1] = (int)(fminf(c.g * 255.0f, 255.0f));
+			p[2] = (int)(fminf(c.b * 255.0f, 255.0f));
+		}
+	}
+	printf("render: %.2fs\n", Now() - start);
+
+	FILE* fp = fopen("..//..//png//polygon.png", "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+	FreePolygon(&gear);
+	FreePolygon(&spiral);
+	printf("Svnpng Success\n");
+	return 0;
+}
+
+void EdgeCells(const Polygon* p, int k, int* x0, int* y0, int* x1, int* y1)
+{
+	//ߵİΧиǵĸ
+	float bx = p->ax[k] + p->ex[k], by = p->ay[k] + p->ey[k];
+	*x0 = (int)((fminf(p->ax[k], bx) - p->minX) / p->cellSize);
+	*y0 = (int)((fminf(p->ay[k], by) - p->minY) / p->cellSize);
+	*x1 = (int)((fmaxf(p->ax[k], bx) - p->minX) / p->cellSize);
+	*y1 = (int)((fmaxf(p->ay[k], by) - p->minY) / p->cellSize);
+	*x1 = *x1 < p->gridX ? *x1 : p->gridX - 1;
+	*y1 = *y1 < p->gridY ? *y1 : p->gridY - 1;
+}
+
+int CompareCrossing(const void* a, const void* b)
+{
+	float x = ((const float*)a)[0], y = ((const float*)b)[0];
+	return x < y ? -1 : x > y ? 1 : 0;
+}
+
+void BuildPolygon(Polygon* p, const float* points, const int* contourSizes, int contourCount, float halfWidth)
+{
+	//պϵһصһ,߲
+	int closed = halfWidth <= 0.0f;
+	int n = 0;
+	for (int c = 0; c < contourCount; ++c)
+	{
+		n += closed ? contourSizes[c] : contourSizes[c] - 1;
+	}
+	p->edgeCount = n;
+	p->halfWidth = halfWidth;
+	p->ax = (float*)malloc(sizeof(float) * n);
+	p->ay = (float*)malloc(sizeof(float) * n);
+	p->ex = (float*)malloc(sizeof(float) * n);
+	p->ey = (float*)malloc(sizeof(float) * n);
+	p->invLength2 = (float*)malloc(sizeof(float) * n);
+
+	int k = 0;
+	float length = 0.0f;
+	float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+	for (int c = 0; c < contourCount; ++c)
+	{
+		int count = contourSizes[c];
+		for (int i = 0; i < (closed ? count : count - 1); ++i, ++k)
+		{
+			const float* a = &points[2 * i];
+			const float* b = &points[2 * ((i + 1) % count)];
+			p->ax[k] = a[0];
+			p->ay[k] = a[1];
+			p->ex[k] = b[0] - a[0];
+			p->ey[k] = b[1] - a[1];
+			float length2 = p->ex[k] * p->ex[k] + p->ey[k] * p->ey[k];
+			p->invLength2[k] = length2 > 0.0f ? 1.0f / length2 : 0.0f;
+			length += sqrtf(length2);
+			minX = fminf(minX, a[0]);
+			minY = fminf(minY, a[1]);
+			maxX = fmaxf(maxX, a[0]);
+			maxY = fmaxf(maxY, a[1]);
+		}
+		if (!closed)
+		{
+			//ߵһ㲻κһߵ
+			const float* last = &points[2 * (count - 1)];
+			minX = fminf(minX, last[0]);
+			minY = fminf(minY, last[1]);
+			maxX = fmaxf(maxX, last[0]);
+			maxY = fmaxf(maxY, last[1]);
+		}
+		points += 2 * count;
+	}
+
+	//ס״,߿Ҳ,ĵһ״
+	p->minX = minX - halfWidth;
+	p->minY = minY - halfWidth;
+	float width = maxX - minX + 2.0f * halfWidth, height = maxY - minY + 2.0f * halfWidth;
+	p->cellSize = fmaxf(CELL_EDGES * length / n, fmaxf(width, height) / MAX_GRID);
+	p->gridX = (int)(width / p->cellSize) + 1;
+	p->gridY = (int)(height / p->cellSize) + 1;
+
+	//ÿм,ǰ׺͵õ,һ
+	int cellCount = p->gridX * p->gridY;
+	p->cellStart = (int*)calloc(cellCount + 1, sizeof(int));
+	for (k = 0; k < n; ++k)
+	{
+		int x0, y0, x1, y1;
+		EdgeCells(p, k, &x0, &y0, &x1, &y1);
+		for (int y = y0; y <= y1; ++y)
+		{
+			for (int x = x0; x <= x1; ++x)
+			{
+				++p->cellStart[y * p->gridX + x + 1];
+			}
+		}
+	}
+	for (int i = 0; i < cellCount; ++i)
+	{
+		p->cellStart[i + 1] += p->cellStart[i];
+	}
+	p->cellIndex = (int*)malloc(sizeof(int) * p->cellStart[cellCount]);
+	int* fill = (int*)malloc(sizeof(int) * cellCount);
+	memcpy(fill, p->cellStart, sizeof(int) * cellCount);
+	for (k = 0; k < n; ++k)
+	{
+		int x0, y0, x1, y1;
+		EdgeCells(p, k, &x0, &y0, &x1, &y1);
+		for (int y = y0; y <= y1; ++y)
+		{
+			for (int x = x0; x <= x1; ++x)
+			{
+				p->cellIndex[fill[y * p->gridX + x]++] = k;
+			}
+		}
+	}
+	free(fill);
+
+	//ÿӵбߵĸӵбѩ,ɨǾȷ
+	p->emptyRings = (int*)malloc(sizeof(int) * cellCount);
+	for (int i = 0; i < cellCount; ++i)
+	{
+		p->emptyRings[i] = p->cellStart[i] < p->cellStart[i + 1] ? 0 : p->gridX + p->gridY;
+	}
+	for (int y = 0; y < p->gridY; ++y)
+	{
+		for (int x = 0; x < p->gridX; ++x)
+		{
+			int* d = &p->emptyRings[y * p->gridX + x];
+			for (int dx = -1; dx <= 1; ++dx)
+			{
+				if (y > 0 && x + dx >= 0 && x + dx < p->gridX && d[dx - p->gridX] + 1 < *d)
+				{
+					*d = d[dx - p->gridX] + 1;
+				}
+			}
+			if (x > 0 && d[-1] + 1 < *d)
+			{
+				*d = d[-1] + 1;
+			}
+		}
+	}
+	for (int y = p->gridY - 1; y >= 0; --y)
+	{
+		for (int x = p->gridX - 1; x >= 0; --x)
+		{
+			int* d = &p->emptyRings[y * p->gridX + x];
+			for (int dx = -1; dx <= 1; ++dx)
+			{
+				if (y < p->gridY - 1 && x + dx >= 0 && x + dx < p->gridX && d[dx + p->gridX] + 1 < *d)
+				{
+					*d = d[dx + p->gridX] + 1;
+				}
+			}
+			if (x < p->gridX - 1 && d[1] + 1 < *d)
+			{
+				*d = d[1] + 1;
+			}
+		}
+	}
+
+	//ĵĻ:ÿһĵˮƽߺб,ۼӴķ
+	p->cellWinding = (int*)calloc(cellCount, sizeof(int));
+	if (!closed)
+	{
+		return;
+	}
+	float* crossing = (float*)malloc(sizeof(float) * 2 * n);
+	for (int y = 0; y < p->gridY; ++y)
+	{
+		float cy = p->minY + (y + 0.5f) * p->cellSize;
+		int count = 0;
+		for (k = 0; k < n; ++k)
+		{
+			float ay = p->ay[k], by = p->ay[k] + p->ey[k];
+			if ((ay <= cy) != (by <= cy))
+			{
+				crossing[2 * count] = p->ax[k] + (cy - ay) * p->ex[k] / p->ey[k];
+				crossing[2 * count + 1] = p->ey[k] > 0.0f ? 1.0f : -1.0f;
+				++count;
+			}
+		}
+		qsort(crossing, count, sizeof(float) * 2, CompareCrossing);
+
+		int winding = 0;
+		for (int x = p->gridX - 1; x >= 0; --x)
+		{
+			float cx = p->minX + (x + 0.5f) * p->cellSize;
+			while (count > 0 && crossing[2 * (count - 1)] > cx)
+			{
+				--count;
+				winding += (int)crossing[2 * count + 1];
+			}
+			p->cellWinding[y * p->gridX + x] = winding;
+		}
+	}
+	free(crossing);
+}
+
+void FreePolygon(Polygon* p)
+{
+	free(p->ax);
+	free(p->ay);
+	free(p->ex);
+	free(p->ey);
+	free(p->invLength2);
+	free(p->cellStart);
+	free(p->cellIndex);
+	free(p->cellWinding);
+	free(p->emptyRings);
+}
+
+float PolygonSDF(const Polygon* p, float x, float y)
+{
+	//ĵĸӿʼ
+	float ox = fmaxf(fmaxf(p->minX - x, x - (p->minX + p->gridX * p->cellSize)), 0.0f);
+	float oy = fmaxf(fmaxf(p->minY - y, y - (p->minY + p->gridY * p->cellSize)), 0.0f);
+	int cx = (int)floorf((x - p->minX) / p->cellSize), cy = (int)floorf((y - p->minY) / p->cellSize);
+	cx = cx < 0 ? 0 : cx >= p->gridX ? p->gridX - 1 : cx;
+	cy = cy < 0 ? 0 : cy >= p->gridY ? p->gridY - 1 : cy;
+	int cell = cy * p->gridX + cx;
+
+	//񳬹һʱһ״,:ͶӰ,ߵľƽ
+	//СڵͶӰľƽͶӰ㵽ߵľƽ,ǿյȦ
+	float outside2 = ox * ox + oy * oy;
+	if (outside2 > p->cellSize * p->cellSize)
+	{
+		float empty = (p->emptyRings[cell] > 0 ? p->emptyRings[cell] - 1 : 0) * p->cellSize;
+		return sqrtf(outside2 + empty * empty) - p->halfWidth;
+	}
+
+	//ı:漸ȦӶǿյ,ֱӴӵһȦбߵĸӿʼ;
+	//Զʱյ⼸Ȧһ½,Ȧĸ̫,ֵ
+	float best = 1e30f;
+	int first = p->emptyRings[cell], ring;
+	for (ring = first; ring < MAX_SEARCH_RING; ++ring)
+	{
+		for (int j = cy - ring; j <= cy + ring; ++j)
+		{
+			if (j < 0 || j >= p->gridY)
+			{
+				continue;
+			}
+			//һкһжһȦ,мֻ˵ĸ
+			int step = j == cy - ring || j == cy + ring ? 1 : 2 * ring;
+			for (int i = cx - ring; i <= cx + ring; i += step)
+			{
+				if (i < 0 || i >= p->gridX)
+				{
+					continue;
+				}
+				int c = j * p->gridX + i;
+				for (int e = p->cellStart[c]; e < p->cellStart[c + 1]; ++e)
+				{
+					int k = p->cellIndex[e];
+					float vx = x - p->ax[k], vy = y - p->ay[k];
+					float t = fmaxf(fminf((vx * p->ex[k] + vy * p->ey[k]) * p->invLength2[k], 1.0f), 0.0f);
+					float dx = vx - p->ex[k] * t, dy = vy - p->ey[k] * t;
+					best = fminf(best, dx * dx + dy * dy);
+				}
+			}
+		}
+		if (best <= (ring * p->cellSize) * (ring * p->cellSize))
+		{
+			break;
+		}
+	}
+	best = sqrtf(best);
+	//˻ûͣ,ûҹĸring-1,½
+	if (ring >= MAX_SEARCH_RING)
+	{
+		best = fminf(best, (ring - 1) * p->cellSize);
+	}
+
+	if (p->halfWidth > 0.0f)
+	{
+		return best - p->halfWidth;
+	}
+	if (ox > 0.0f || oy > 0.0f)
+	{
+		return best;
+	}
+
+	//:Ӹˮƽߵ(x, cy),ֱߵ(x, y),·,ֻӵı߻ཻ;
+	//ˮƽߺֱߵཻжϺͽʱһð뿪,ʱظ
+	float centerX = p->minX + (cx + 0.5f) * p->cellSize, centerY = p->minY + (cy + 0.5f) * p->cellSize;
+	int winding = p->cellWinding[cell];
+	for (int e = p->cellStart[cell]; e < p->cellStart[cell + 1]; ++e)
+	{
+		int k = p->cellIndex[e];
+		float ax = p->ax[k], ay = p->ay[k], bx = ax + p->ex[k], by = ay + p->ey[k];
+		//ҵ:ı+1,-1
+		if ((ay <= centerY) != (by <= centerY))
+		{
+			float cross = ax + (centerY - ay) * p->ex[k] / p->ey[k];
+			winding += ((cross > x) - (cross > centerX)) * (p->ey[k] > 0.0f ? 1 : -1);
+		}
+		//ϵ:ı+1,-1
+		if ((ax <= x) != (bx <= x))
+		{
+			float cross = ay + (x - ax) * p->ey[k] / p->ex[k];
+			winding += ((cross > y) - (cross > centerY)) * (p->ex[k] < 0.0f ? 1 : -1);
+		}
+	}
+	return winding != 0 ? -best : best;
+}
+
+float PolygonSDFBrute(const Polygon* p, float x, float y)
+{
+	//,ҵ,汾Ա
+	float best = 1e30f;
+	int winding = 0;
+	for (int k = 0; k < p->edgeCount; ++k)
+	{
+		float vx = x - p->ax[k], vy = y - p->ay[k];
+		float t = fmaxf(fminf((vx * p->ex[k] + vy * p->ey[k]) * p->invLength2[k], 1.0f), 0.0f);
+		float dx = vx - p->ex[k] * t, dy = vy - p->ey[k] * t;
+		best = fminf(best, dx * dx + dy * dy);
+
+		float ay = p->ay[k], by = ay + p->ey[k];
+		if ((ay <= y) != (by <= y) && p->ax[k] + (y - ay) * p->ex[k] / p->ey[k] > x)
+		{
+			winding += p->ey[k] > 0.0f ? 1 : -1;
+		}
+	}
+	best = sqrtf(best);
+	if (p->halfWidth > 0.0f)
+	{
+		return best - p->halfWidth;
+	}
+	return winding != 0 ? -best : best;
+}
+
+void MakeGear(Polygon* p, float cx, float cy, float r, float tooth, float hole)
+{
+	//ʱ,ƽ;мĶ˳ʱ,Ϊ0
+	int outer = GEAR_TEETH * GEAR_TOOTH_POINTS;
+	float* points = (float*)malloc(sizeof(float) * 2 * (outer + GEAR_HOLE_POINTS));
+	for (int i = 0; i < outer; ++i)
+	{
+		float angle = TWO_PI * i / outer;
+		float bump = fmaxf(fminf(2.0f * cosf(GEAR_TEETH * angle), 1.0f), -1.0f);
+		float radius = r + tooth * bump;
+		points[2 * i] = cx + radius * cosf(angle);
+		points[2 * i + 1] = cy + radius * sinf(angle);
+	}
+	for (int i = 0; i < GEAR_HOLE_POINTS; ++i)
+	{
+		float angle = -TWO_PI * i / GEAR_HOLE_POINTS;
+		points[2 * (outer + i)] = cx + hole * cosf(angle);
+		points[2 * (outer + i) + 1] = cy + hole * sinf(angle);
+	}
+	int sizes[2] = { outer, GEAR_HOLE_POINTS };
+	BuildPolygon(p, points, sizes, 2, 0.0f);
+	free(points);
+}
+
+void MakeSpiral(Polygon* p, float cx, float cy, float r0, float r1, float turns, float halfWidth)
+{
+	float* points = (float*)malloc(sizeof(float) * 2 * SPIRAL_POINTS);
+	for (int i = 0; i < SPIRAL_POINTS; ++i)
+	{
+		float t = (float)i / (SPIRAL_POINTS - 1);
+		float angle = TWO_PI * turns * t, radius = r0 + (r1 - r0) * t;
+		points[2 * i] = cx + radius * cosf(angle);
+		points[2 * i + 1] = cy + radius * sinf(angle);
+	}
+	int size = SPIRAL_POINTS;
+	BuildPolygon(p, points, &size, 1, halfWidth);
+	free(points);
+}
+
+TraceResult Scene(float x, float y)
+{
+	TraceResult light = { CircleSDF(x, y, 0.85f, 0.85f, 0.06f), 0.0f, 0.0f, { 1.0f, 2.0f, 6.0f }, COLOR_BLACK };
+	TraceResult wire = { PolygonSDF(&spiral, x, y), 0.0f, 0.0f, { 6.0f, 3.0f, 1.0f }, COLOR_BLACK };
+	TraceResult glass = { PolygonSDF(&gear, x, y), 0.0f, 1.5f, COLOR_BLACK, { 0.5f, 1.5f, 2.0f } };
+	return Union(Union(light, wire), glass);
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / LIGHT_COUNT);
+}
+
+#include "sdf.inc"
+#include "trace.inc"
+//
+//
+////DOC:
+////
+//ԭֻκ,ӵֻһͼԪ,һò
+//Polygonǧߡ(Ƿ),ⰴ㻷ж;halfWidth0ʱпȵ
+//1.һ,ӱ߳ƽ߳CELL_EDGES,ÿߵǼΧиǵĸ
+//2.ı:BinarySceneMainһӵڵĸһȦһȦ;ÿԤбߵĸӸ˼Ȧ,
+//  յļȦֱ;MAX_SEARCH_RINGȦûͣ¾ͷûҹĸӵľΪ½,
+//  ԶĵյȦ½,һӶÿ
+//3.:ʱÿһиĵˮƽбߵĽ,ۼ,õÿĵĻ;
+//  ֵʱӸһˮƽֱߵֵ,·,ֻı߻ཻ,
+//  ЩĹ׾ֵĻ,ͱߵ޹
+//4.PolygonSDFBrute߼,main϶Ա⡢,Ƚߵٶ
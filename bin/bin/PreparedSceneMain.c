@@ -0,0 +1,572 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (2)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//ͼԪ
+#define SHAPE_CIRCLE              (0)
+#define SHAPE_PLANE               (1)
+#define SHAPE_CAPSULE             (2)      //뾶Ϊ0߶
+#define SHAPE_BOX                 (3)
+#define SHAPE_TRIANGLE            (4)      //׼õĲռ
+#define SHAPE_NGON                (5)
+
+//ͼԪǰϷʽ
+#define OP_UNION                  (0)      //ʼһµ״,֮ǰ״
+#define OP_INTERSECT              (1)      //͵ǰ״
+#define OP_SUBTRACT               (2)      //ӵǰ״ȥ
+
+#define MAX_SHAPE                 (64)
+#define CACHE_LINE                (64)
+#define BENCH_POINTS              (1 << 20)
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+//:½ڵSDFĲһһӦ
+typedef struct
+{
+	int type, op, material;
+	float p[7];
+} ShapeDesc;
+
+//׼õͼԪ:32ֽ,һ,ֵʱֻ
+//pĺͱ仯,Ǻֵ޹صĲ,PrepareScene
+typedef struct
+{
+	byte type, op, material, count;
+	float p[7];
+} Primitive;
+
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+byte image[WIDTH * HEIGHT * RGB];
+
+ShapeDesc shapes[MAX_SHAPE];
+int shapeCount;
+
+Primitive* primitives;  //ж
+int primitiveCount;
+
+//,ֻȡһ
+TraceResult materials[] =
+{
+	{ 0.0f, 0.0f, 0.0f, { 8.0f, 8.0f, 8.0f }, COLOR_BLACK },        //Դ
+	{ 0.0f, 0.0f, 1.5f, COLOR_BLACK, { 4.0f, 4.0f, 1.0f } },        //
+	{ 0.0f, 0.0f, 1.5f, COLOR_BLACK, { 1.0f, 4.0f, 4.0f } },        //첣
+	{ 0.0f, 0.6f, 0.0f, COLOR_BLACK, COLOR_BLACK },                 //
+	{ 0.0f, 0.0f, 0.0f, { 1.0f, 0.6f, 0.3f }, COLOR_BLACK },        //ǽ
+};
+
+TraceResult (*Scene)(float x, float y);
+
+TraceResult ReferenceScene(float x, float y);
+
+TraceResult PreparedScene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+void AddShape(int type, int op, int material, float p0, float p1, float p2, float p3, float p4, float p5, float p6);
+
+void DescribeScene();
+
+void PrepareScene();
+
+void* AlignedAlloc(size_t size, size_t align);
+
+void AlignedFree(void* p);
+
+double BenchScene(const char* name, float* checksum);
+
+int main()
+{
+	DescribeScene();
+	PrepareScene();
+	printf("%d shapes, %d primitive slots, %d bytes\n", shapeCount, primitiveCount, (int)(primitiveCount * sizeof(Primitive)));
+
+	//ֵʽĽҪһ
+	float maxDiff = 0.0f;
+	int materialDiff = 0;
+	unsigned int seed = 12345u;
+	for (int i = 0; i < BENCH_POINTS; ++i)
+	{
+		float x = Random(&seed) * 1.4f - 0.2f, y = Random(&seed) * 1.4f - 0.2f;
+		TraceResult a = ReferenceScene(x, y), b = PreparedScene(x, y);
+		maxDiff = fmaxf(maxDiff, fabsf(a.sdf - b.sdf));
+		materialDiff += memcmp(&a.emissive, &b.emissive, sizeof(Color) * 2) != 0 || a.eta != b.eta || a.reflectivity != b.reflectivity;
+	}
+	printf("max sdf difference %g, %d material mismatches\n", maxDiff, materialDiff);
+
+	float sumA, sumB;
+	Scene = ReferenceScene;
+	double reference = BenchScene("reference", &sumA);
+	Scene = PreparedScene;
+	double prepared = BenchScene("prepared", &sumB);
+	printf("speedup %.2fx\n", reference / prepared);
+
+	double start = Now();
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			unsigned int s = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+			Color c = Sample((float)x / WIDTH, (float)y / HEIGHT, &s);
+			byte* p = &image[(y * WIDTH + x) * RGB];
+			p[0] = (int)(fminf(c.r * 255.0f, 255.0f));
+			p[1] = (int)(fminf(c.g * 255.0f, 255.0f));
+			p[2] = (int)(fminf(c.b * 255.0f, 255.0f));
+		}
+	}
+	printf("render: %.2fs\n", Now() - start);
+
+	FILE* fp = fopen("..//..//png//prepared_scene.png", "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+	AlignedFree(primitives);
+	printf("Svnpng Success\n");
+	return 0;
+}
+
+double BenchScene(const char* name, float* checksum)
+{
+	//ͬһ,ֻȽSceneĿ
+	float sum = 0.0f;
+	unsigned int seed = 777u;
+	double start = Now();
+	for (int i = 0; i < BENCH_POINTS; ++i)
+	{
+		float x = Random(&seed), y = Random(&seed);
+		sum += Scene(x, y).sdf;
+	}
+	double elapsed = Now() - start;
+	*checksum = sum;
+	printf("%-10s: %.1f ns/eval (checksum %g)\n", name, elapsed * 1e9 / BENCH_POINTS, sum);
+	return elapsed;
+}
+
+void AddShape(int type, int op, int material, float p0, float p1, float p2, float p3, float p4, float p5, float p6)
+{
+	ShapeDesc* s = &shapes[shapeCount++];
+	s->type = type;
+	s->op = op;
+	s->material = material;
+	s->p[0] = p0; s->p[1] = p1; s->p[2] = p2; s->p[3] = p3;
+	s->p[4] = p4; s->p[5] = p5; s->p[6] = p6;
+}
+
+void DescribeScene()
+{
+	//˳ͶӦSDFһ
+	AddShape(SHAPE_CIRCLE, OP_UNION, 0, 0.5f, 0.5f, 0.06f, 0, 0, 0, 0);
+	AddShape(SHAPE_PLANE, OP_UNION, 4, 0.0f, 1.1f, 0.0f, -1.0f, 0, 0, 0);
+
+	//һȦתľ
+	for (int i = 0; i < 12; ++i)
+	{
+		float a = TWO_PI * i / 12.0f;
+		AddShape(SHAPE_BOX, OP_UNION, 3, 0.5f + 0.38f * cosf(a), 0.5f + 0.38f * sinf(a), a + 0.3f, 0.05f, 0.01f, 0, 0);
+	}
+
+	AddShape(SHAPE_NGON, OP_UNION, 1, 0.5f, 0.5f, 0.22f, 5.0f, 0, 0, 0);
+	AddShape(SHAPE_CIRCLE, OP_SUBTRACT, 1, 0.5f, 0.5f, 0.16f, 0, 0, 0, 0);  //мڿ,ŹԴ
+
+	AddShape(SHAPE_TRIANGLE, OP_UNION, 2, 0.05f, 0.05f, 0.2f, 0.05f, 0.1f, 0.2f, 0);
+	AddShape(SHAPE_CAPSULE, OP_UNION, 2, 0.8f, 0.05f, 0.95f, 0.2f, 0.03f, 0, 0);
+	AddShape(SHAPE_CAPSULE, OP_UNION, 3, 0.05f, 0.95f, 0.25f, 0.98f, 0.0f, 0, 0);
+
+	//Բ͸
+	AddShape(SHAPE_CIRCLE, OP_UNION, 2, 0.78f, 0.92f, 0.1f, 0, 0, 0, 0);
+	AddShape(SHAPE_CIRCLE, OP_INTERSECT, 2, 0.92f, 0.92f, 0.1f, 0, 0, 0, 0);
+}
+
+void PrepareScene()
+{
+	//ÿͼԪֻһκֵ޹ص:Ǻ
+	primitives = (Primitive*)AlignedAlloc(sizeof(Primitive) * MAX_SHAPE * 2, CACHE_LINE);
+	memset(primitives, 0, sizeof(Primitive) * MAX_SHAPE * 2);
+	primitiveCount = 0;
+
+	for (int i = 0; i < shapeCount; ++i)
+	{
+		const ShapeDesc* s = &shapes[i];
+		Primitive* p = &primitives[primitiveCount++];
+		p->type = (byte)s->type;
+		p->op = (byte)s->op;
+		p->material = (byte)s->material;
+
+		if (s->type == SHAPE_CIRCLE)
+		{
+			//cx, cy, r
+			memcpy(p->p, s->p, sizeof(float) * 3);
+		}
+		else if (s->type == SHAPE_PLANE)
+		{
+			//px, py, nx, ny
+			memcpy(p->p, s->p, sizeof(float) * 4);
+		}
+		else if (s->type == SHAPE_CAPSULE)
+		{
+			//ax, ay, ux, uy, 1/|u|^2, radius
+			float ux = s->p[2] - s->p[0], uy = s->p[3] - s->p[1];
+			p->p[0] = s->p[0];
+			p->p[1] = s->p[1];
+			p->p[2] = ux;
+			p->p[3] = uy;
+			p->p[4] = 1.0f / (ux * ux + uy * uy);
+			p->p[5] = s->p[4];
+		}
+		else if (s->type == SHAPE_BOX)
+		{
+			//ox, oy, cos, sin, sx, sy
+			p->p[0] = s->p[0];
+			p->p[1] = s->p[1];
+			p->p[2] = cosf(s->p[2]);
+			p->p[3] = sinf(s->p[2]);
+			p->p[4] = s->p[3];
+			p->p[5] = s->p[4];
+		}
+		else if (s->type == SHAPE_TRIANGLE)
+		{
+			//һ:a, b-a, c-b;ڶ:a-c, ߳ƽĵ
+			Primitive* q = &primitives[primitiveCount++];
+			float e[6] = { s->p[2] - s->p[0], s->p[3] - s->p[1], s->p[4] - s->p[2], s->p[5] - s->p[3], s->p[0] - s->p[4], s->p[1] - s->p[5] };
+			p->p[0] = s->p[0];
+			p->p[1] = s->p[1];
+			memcpy(&p->p[2], e, sizeof(float) * 4);
+			q->p[0] = e[4];
+			q->p[1] = e[5];
+			for (int k = 0; k < 3; ++k)
+			{
+				q->p[2 + k] = 1.0f / (e[k * 2] * e[k * 2] + e[k * 2 + 1] * e[k * 2 + 1]);
+			}
+		}
+		else if (s->type == SHAPE_NGON)
+		{
+			//cx, cy, r*cos(a/2), 0ߵķ, תһߵcossin
+			//ε㵽ߵľ,ڵ㵽бֱߵֵ,
+			//תֵ,Ҫatan2/fmod/cos/sin
+			float a = TWO_PI / s->p[3];
+			p->count = (byte)s->p[3];
+			p->p[0] = s->p[0];
+			p->p[1] = s->p[1];
+			p->p[2] = s->p[2] * cosf(a * 0.5f);
+			p->p[3] = cosf(a * 0.5f);
+			p->p[4] = sinf(a * 0.5f);
+			p->p[5] = cosf(a);
+			p->p[6] = sinf(a);
+		}
+	}
+}
+
+TraceResult PreparedScene(float x, float y)
+{
+	float best = 1e30f, current = 1e30f;
+	int bestMaterial = 0, currentMaterial = 0;
+
+	for (int i = 0; i < primitiveCount; ++i)
+	{
+		const Primitive* p = &primitives[i];
+		const float* q = p->p;
+		float d;
+
+		switch (p->type)
+		{
+		case SHAPE_CIRCLE:
+		{
+			float dx = x - q[0], dy = y - q[1];
+			d = sqrtf(dx * dx + dy * dy) - q[2];
+			break;
+		}
+		case SHAPE_PLANE:
+			d = (x - q[0]) * q[2] + (y - q[1]) * q[3];
+			break;
+		case SHAPE_CAPSULE:
+		{
+			float vx = x - q[0], vy = y - q[1];
+			float t = fmaxf(fminf((vx * q[2] + vy * q[3]) * q[4], 1.0f), 0.0f);
+			float dx = vx - q[2] * t, dy = vy - q[3] * t;
+			d = sqrtf(dx * dx + dy * dy) - q[5];
+			break;
+		}
+		case SHAPE_BOX:
+		{
+			float lx = x - q[0], ly = y - q[1];
+			float dx = fabsf(lx * q[2] + ly * q[3]) - q[4];
+			float dy = fabsf(ly * q[2] - lx * q[3]) - q[5];
+			float ax = fmaxf(dx, 0.0f), ay = fmaxf(dy, 0.0f);
+			d = fminf(fmaxf(dx, dy), 0.0f) + sqrtf(ax * ax + ay * ay);
+			break;
+		}
+		case SHAPE_TRIANGLE:
+		{
+			//a->b, b->c, c->a,ǰһϱõ
+			const float* r = primitives[++i].p;
+			float ex[3] = { q[2], q[4], r[0] }, ey[3] = { q[3], q[5], r[1] };
+			float sx = q[0], sy = q[1];
+			float d2 = 1e30f;
+			int inside = 1;
+			for (int k = 0; k < 3; ++k)
+			{
+				float vx = x - sx, vy = y - sy;
+				float t = fmaxf(fminf((vx * ex[k] + vy * ey[k]) * r[2 + k], 1.0f), 0.0f);
+				float dx = vx - ex[k] * t, dy = vy - ey[k] * t;
+				d2 = fminf(d2, dx * dx + dy * dy);
+				inside &= ex[k] * vy > ey[k] * vx;
+				sx += ex[k];
+				sy += ey[k];
+			}
+			d = inside ? -sqrtf(d2) : sqrtf(d2);
+			break;
+		}
+		case SHAPE_NGON:
+		{
+			float ux = x - q[0], uy = y - q[1];
+			float nx = q[3], ny = q[4], m = -1e30f;
+			for (int k = 0; k < p->count; ++k)
+			{
+				m = fmaxf(m, ux * nx + uy * ny);
+				float t = nx * q[5] - ny * q[6];
+				ny = nx * q[6] + ny * q[5];
+				nx = t;
+			}
+			d = m - q[2];
+			break;
+		}
+		default:
+			d = 1e30f;
+			break;
+		}
+
+		if (p->op == OP_UNION)
+		{
+			if (current < best)
+			{
+				best = current;
+				bestMaterial = currentMaterial;
+			}
+			current = d;
+			currentMaterial = p->material;
+		}
+		else if (p->op == OP_INTERSECT)
+		{
+			current = fmaxf(current, d);
+		}
+		else
+		{
+			current = fmaxf(current, -d);
+		}
+	}
+
+	if (current < best)
+	{
+		best = current;
+		bestMaterial = currentMaterial;
+	}
+
+	TraceResult r = materials[bestMaterial];
+	r.sdf = best;
+	return r;
+}
+
+TraceResult ReferenceScene(float x, float y)
+{
+	//ԭSDF,½дSceneȼ
+	TraceResult result = { 1e30f, 0.0f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+	TraceResult current = result;
+
+	for (int i = 0; i < shapeCount; ++i)
+	{
+		const ShapeDesc* s = &shapes[i];
+		const float* p = s->p;
+		TraceResult r = materials[s->material];
+
+		if (s->type == SHAPE_CIRCLE)
+		{
+			r.sdf = CircleSDF(x, y, p[0], p[1], p[2]);
+		}
+		else if (s->type == SHAPE_PLANE)
+		{
+			r.sdf = PlaneSDF(x, y, p[0], p[1], p[2], p[3]);
+		}
+		else if (s->type == SHAPE_CAPSULE)
+		{
+			r.sdf = CapsuleSDF(x, y, p[0], p[1], p[2], p[3], p[4]);
+		}
+		else if (s->type == SHAPE_BOX)
+		{
+			r.sdf = BoxSDF(x, y, p[0], p[1], p[2], p[3], p[4]);
+		}
+		else if (s->type == SHAPE_TRIANGLE)
+		{
+			r.sdf = TriangleSDF(x, y, p[0], p[1], p[2], p[3], p[4], p[5]);
+		}
+		else
+		{
+			r.sdf = NgonSDF(x, y, p[0], p[1], p[2], p[3]);
+		}
+
+		if (s->op == OP_UNION)
+		{
+			result = i > 0 ? Union(result, current) : result;
+			current = r;
+		}
+		else
+		{
+			current = s->op == OP_INTERSECT ? Intersec(current, r) : Subtract(current, r);
+		}
+	}
+	return Union(result, current);
+}
+
+void* AlignedAlloc(size_t size, size_t align)
+{
+	//һ,ԭʼָڶַǰ
+	void* raw = malloc(size + align + sizeof(void*));
+	if (!raw)
+	{
+		return NULL;
+	}
+	size_t addr = ((size_t)raw + sizeof(void*) + align - 1) & ~(align - 1);
+	((void**)addr)[-1] = raw;
+	return (void*)addr;
+}
+
+void AlignedFree(void* p)
+{
+	if (p)
+	{
+		free(((void**)p)[-1]);
+	}
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / LIGHT_COUNT);
+}
+
+#include "sdf.inc"
+#include "trace.inc"
+//
+//
+////DOC:
+////Ԥ
+//½ڵSceneÿֵԭʼ:BoxSDFÿcosf/sinf,NgonSDFÿTWO_PI/nͰǵcos/sin,
+//SegmentSDFÿ1/(ux*ux+uy*uy),ЩֻͼԪй,һ֡Ҫظ
+//ѳֳ:
+//1.DescribeSceneúSDFͬĲ,OP_UNIONʼһ״,OP_INTERSECT/OP_SUBTRACT޸ĵǰ״
+//2.PrepareSceneÿͼԪĲ,32ֽڵPrimitive,鰴ж,һзͼԪ
+//  δͳƽĵ,ռ
+//  θд"ֱֵ",תõ,ֵʱһԽû
+//3.PreparedSceneֵֻйص,ʷ,ֻȡһ
+//ReferenceSceneͬԭĺ,mainȽߵĽ,ٱȽϵֵĺʱ
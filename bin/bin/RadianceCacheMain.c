@@ -0,0 +1,355 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//̽
+#define PROBE_GRID                (64)     //PROBE_GRID x PROBE_GRID̽,[0,1]x[0,1]
+#define PROBE_DIRECTION           (LIGHT_COUNT) //ÿ̽ķ,صĹһ,һһӦ
+#define PROBE_SAMPLE              (4)      //ÿڶ׷ٵĹ
+#define MAX_PARALLAX              (0.1f)   //̽뵽صƫ/о,ӲͲܽø̽
+#define MIN_WEIGHT                (0.5f)   //һϿ̽˫Ȩ֮͵ֱ׷
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+//һ̽:ÿƽ,Լһеľ
+typedef struct
+{
+	Color radiance[PROBE_DIRECTION];
+	float distance[PROBE_DIRECTION];
+	float sdf;  //̽λõSDF,ж֮̽Ƿɼ
+} Probe;
+
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+byte image[WIDTH * HEIGHT * RGB];
+
+Color cached[WIDTH * HEIGHT], reference[WIDTH * HEIGHT];
+
+Probe probes[PROBE_GRID * PROBE_GRID];
+
+TraceResult Scene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+float HitDistance(float ox, float oy, float dx, float dy);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+void BuildProbes();
+
+Color CachedSample(float x, float y, unsigned int* seed, int* traced);
+
+void WriteImage(const Color* c, const char* path);
+
+int main(int argc, char* argv[])
+{
+	//RadianceCacheMain [-reference] : ʱȾһ,Ƚͺʱ
+	int compare = argc > 1 && strcmp(argv[1], "-reference") == 0;
+
+	double start = Now();
+	BuildProbes();
+	printf("build %d probes x %d directions: %.2fs\n", PROBE_GRID * PROBE_GRID, PROBE_DIRECTION, Now() - start);
+
+	//ʱֻ̽һ,֮ÿһֻ֡вֵ׷
+	long long traced = 0;
+	start = Now();
+#pragma omp parallel for schedule(dynamic) reduction(+:traced)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			unsigned int seed = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+			int n = 0;
+			cached[y * WIDTH + x] = CachedSample((float)x / WIDTH, (float)y / HEIGHT, &seed, &n);
+			traced += n;
+		}
+	}
+	printf("cached render: %.2fs, %.1f%% of directions traced directly\n", Now() - start, 100.0 * traced / ((double)WIDTH * HEIGHT * PROBE_DIRECTION));
+	WriteImage(cached, "..//..//png//radiance_cache.png");
+
+	if (compare)
+	{
+		start = Now();
+#pragma omp parallel for schedule(dynamic)
+		for (int y = 0; y < HEIGHT; ++y)
+		{
+			for (int x = 0; x < WIDTH; ++x)
+			{
+				unsigned int seed = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+				reference[y * WIDTH + x] = Sample((float)x / WIDTH, (float)y / HEIGHT, &seed);
+			}
+		}
+		printf("reference render: %.2fs\n", Now() - start);
+
+		double sum = 0.0;
+		for (int i = 0; i < WIDTH * HEIGHT; ++i)
+		{
+			double dr = fminf(cached[i].r, 1.0f) - fminf(reference[i].r, 1.0f);
+			double dg = fminf(cached[i].g, 1.0f) - fminf(reference[i].g, 1.0f);
+			double db = fminf(cached[i].b, 1.0f) - fminf(reference[i].b, 1.0f);
+			sum += dr * dr + dg * dg + db * db;
+		}
+		printf("rmse against reference: %.4f\n", sqrt(sum / (WIDTH * HEIGHT * RGB)));
+		WriteImage(reference, "..//..//png//radiance_reference.png");
+	}
+
+	printf("Svnpng Success\n");
+	return 0;
+}
+
+void BuildProbes()
+{
+#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < PROBE_GRID * PROBE_GRID; ++i)
+	{
+		Probe* p = &probes[i];
+		float px = (i % PROBE_GRID + 0.5f) / PROBE_GRID, py = (i / PROBE_GRID + 0.5f) / PROBE_GRID;
+		unsigned int seed = (unsigned int)i * 7919u + 1u;
+		p->sdf = Scene(px, py).sdf;
+
+		for (int k = 0; k < PROBE_DIRECTION; ++k)
+		{
+			//kڶ׷PROBE_SAMPLEȡƽ,оȡķ
+			Color sum = COLOR_BLACK;
+			for (int s = 0; s < PROBE_SAMPLE; ++s)
+			{
+				float radians = TWO_PI * (k + (s + Random(&seed)) / PROBE_SAMPLE) / PROBE_DIRECTION;
+				sum = ColorAdd(sum, Trace(px, py, cosf(radians), sinf(radians), 0));
+			}
+			float radians = TWO_PI * (k + 0.5f) / PROBE_DIRECTION;
+			p->radiance[k] = ColorScale(sum, 1.0f / PROBE_SAMPLE);
+			p->distance[k] = HitDistance(px, py, cosf(radians), sinf(radians));
+		}
+	}
+}
+
+Color CachedSample(float x, float y, unsigned int* seed, int* traced)
+{
+	//Χ4̽˫Ȩ
+	float fx = fminf(fmaxf(x * PROBE_GRID - 0.5f, 0.0f), PROBE_GRID - 1.001f);
+	float fy = fminf(fmaxf(y * PROBE_GRID - 0.5f, 0.0f), PROBE_GRID - 1.001f);
+	int ix = (int)fx, iy = (int)fy;
+	float sx = fx - ix, sy = fy - iy;
+	float sdf = Scene(x, y).sdf;
+
+	const Probe* p[4];
+	float w[4], offset[4];
+	for (int j = 0; j < 4; ++j)
+	{
+		int px = ix + (j & 1), py = iy + (j >> 1);
+		p[j] = &probes[py * PROBE_GRID + px];
+		w[j] = ((j & 1) ? sx : 1.0f - sx) * ((j >> 1) ? sy : 1.0f - sy);
+
+		//SDFԲཻ˵֮߶ûڵ,̽뿴Ǳ
+		float dx = (px + 0.5f) / PROBE_GRID - x, dy = (py + 0.5f) / PROBE_GRID - y;
+		offset[j] = sqrtf(dx * dx + dy * dy);
+		if (p[j]->sdf * sdf <= 0.0f || offset[j] > fabsf(p[j]->sdf) + fabsf(sdf))
+		{
+			w[j] = 0.0f;
+		}
+	}
+
+	Color sum = COLOR_BLACK;
+	for (int k = 0; k < PROBE_DIRECTION; ++k)
+	{
+		//еԽԶ,غ֮̽ƫɵĽǶԽС,MAX_PARALLAX̽벻
+		Color c = COLOR_BLACK;
+		float total = 0.0f;
+		for (int j = 0; j < 4; ++j)
+		{
+			if (w[j] > 0.0f && offset[j] < MAX_PARALLAX * p[j]->distance[k])
+			{
+				c = ColorAdd(c, ColorScale(p[j]->radiance[k], w[j]));
+				total += w[j];
+			}
+		}
+
+		if (total >= MIN_WEIGHT)
+		{
+			sum = ColorAdd(sum, ColorScale(c, 1.0f / total));
+			continue;
+		}
+
+		//޷֤,ʵʵ׷
+		float radians = TWO_PI * (k + Random(seed)) / PROBE_DIRECTION;
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+		++*traced;
+	}
+	return ColorScale(sum, 1.0f / PROBE_DIRECTION);
+}
+
+float HitDistance(float ox, float oy, float dx, float dy)
+{
+	//ֻһ,о,ûз
+	float t = 1e-3f;
+	float sign = Scene(ox, oy).sdf > 0.0f ? 1.0f : -1.0f;
+	for (int i = 0; i < RAY_MARCHING_MAX_STEP && t < RAY_MARCHING_MAX_DISTANCE; ++i)
+	{
+		float d = Scene(ox + dx * t, oy + dy * t).sdf * sign;
+		if (d < EPSILON)
+		{
+			return t;
+		}
+		t += d;
+	}
+	return RAY_MARCHING_MAX_DISTANCE;
+}
+
+void WriteImage(const Color* c, const char* path)
+{
+	byte* p = image;
+	for (int i = 0; i < WIDTH * HEIGHT; ++i)
+	{
+		p[0] = (int)(fminf(c[i].r * 255.0f, 255.0f));
+		p[1] = (int)(fminf(c[i].g * 255.0f, 255.0f));
+		p[2] = (int)(fminf(c[i].b * 255.0f, 255.0f));
+		p += RGB;
+	}
+
+	FILE* fp = fopen(path, "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / LIGHT_COUNT);
+}
+
+#include "sdf.inc"
+#include "trace.inc"
+
+TraceResult Scene(float x, float y)
+{
+	TraceResult a = { CircleSDF(x, y, 0.5f, -0.2f, 0.1f), 0.0f, 0.0f,{ 10.0f, 10.0f, 10.0f }, COLOR_BLACK };
+	//babsorptionrgb(4,4,1),ʾrg,ʾɫɫ
+	TraceResult b = { NgonSDF(x, y, 0.5f, 0.5f, 0.25f, 5.0f), 0.0f, 1.5f, COLOR_BLACK,  { 4.0f, 4.0f, 1.0f } };
+
+
+	return Union(a, b);
+}
+
+//
+//
+////DOC:
+////Ȼ
+//̬,ĳķֻλáй,ÿضҪͷ׷LIGHT_COUNT,
+//صĽһ
+//ԤϷ̽:
+//1.ÿ̽ÿ׷PROBE_SAMPLE,ƽȺ͸÷һеľ
+//2.ȡΧ4̽,ֵ,ÿǿɿص:
+//  غ̽SDFԲཻ(мڵ)״,̽벻
+//  ص̽ƫƺо֮ȾӲĽǶ,MAX_PARALLAX̽ϲ
+//  ̽ȨزMIN_WEIGHTʱ,ֱ׷
+//3.Զ״ԴĴƬȫԲֵ,ԵԶ˻׷
+//̽ͼֱ޹,ͼԽʡԽ;ʱֻ̽Ҫһ
@@ -0,0 +1,227 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define SOCKET_PATH               "/tmp/light2d.sock"
+#define LINE_LENGTH               (512)
+
+#define RENDER_ERROR              (0)
+#define RENDER_ACCEPTED           (1)
+#define RENDER_FRAME              (2)
+#define RENDER_DONE               (3)
+#define RENDER_CANCELLED          (4)
+
+typedef unsigned char byte;
+
+//˻شһϢ
+typedef struct
+{
+	int type, id;
+	int samples, width, height;  //RENDER_FRAMEʱЧ
+	byte* image;                 //RENDER_FRAMEʱrgb24,RenderWaitһεͷ;ڴ治ʱΪNULL
+	char text[LINE_LENGTH];      //ԭʼϢ
+} RenderEvent;
+
+//ͻ˽ӿ
+int RenderConnect(const char* path);
+
+int RenderSubmit(int fd, int id, const char* scene, int width, int height, int samples, int priority, const char* output);
+
+int RenderCancel(int fd, int id);
+
+int RenderWait(int fd, RenderEvent* e);
+
+int ReadAll(int fd, void* data, int size);
+
+int WriteAll(int fd, const void* data, int size);
+
+int main(int argc, char* argv[])
+{
+	//RenderClient <scene> <width> <height> <samples> <output> [] [ȼ] [socket·]
+	//1ʱύһС,ļ%d滻id
+	if (argc < 6)
+	{
+		printf("usage: RenderClient <scene> <width> <height> <samples> <output> [count] [priority] [socket]\n");
+		return 1;
+	}
+	int count = argc > 6 ? atoi(argv[6]) : 1;
+	int priority = argc > 7 ? atoi(argv[7]) : 0;
+	int fd = RenderConnect(argc > 8 ? argv[8] : SOCKET_PATH);
+	if (fd < 0)
+	{
+		perror("RenderClient");
+		return 1;
+	}
+
+	for (int id = 0; id < count; ++id)
+	{
+		char output[256];
+		const char* p = strstr(argv[5], "%d");
+		if (p)
+		{
+			snprintf(output, sizeof(output), "%.*s%d%s", (int)(p - argv[5]), argv[5], id, p + 2);
+		}
+		else
+		{
+			snprintf(output, sizeof(output), "%s", argv[5]);
+		}
+		RenderSubmit(fd, id, argv[1], atoi(argv[2]), atoi(argv[3]), atoi(argv[4]), priority, output);
+	}
+
+	RenderEvent e;
+	memset(&e, 0, sizeof(e));
+	int remaining = count, failed = 0;
+	while (remaining > 0 && RenderWait(fd, &e))
+	{
+		if (e.type == RENDER_FRAME)
+		{
+			printf("job %d: %d samples\n", e.id, e.samples);
+		}
+		else if (e.type != RENDER_ACCEPTED)
+		{
+			printf("%s", e.text);
+			failed += e.type != RENDER_DONE;
+			--remaining;
+		}
+	}
+	free(e.image);
+	close(fd);
+	return failed != 0 || remaining != 0;
+}
+
+int RenderConnect(const char* path)
+{
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+	if (fd >= 0 && connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+	{
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+int RenderSubmit(int fd, int id, const char* scene, int width, int height, int samples, int priority, const char* output)
+{
+	//outputΪ"-"ʱֻشдļ
+	char line[LINE_LENGTH];
+	int n = snprintf(line, sizeof(line), "RENDER %d %s %d %d %d %d %s\n", id, scene, width, height, samples, priority, output);
+	return WriteAll(fd, line, n);
+}
+
+int RenderCancel(int fd, int id)
+{
+	char line[64];
+	int n = sprintf(line, "CANCEL %d\n", id);
+	return WriteAll(fd, line, n);
+}
+
+int RenderWait(int fd, RenderEvent* e)
+{
+	//һϢ,ӶϿʱ0
+	free(e->image);
+	e->image = NULL;
+	e->id = -1;
+
+	int n = 0;
+	while (n < LINE_LENGTH - 1)
+	{
+		if (!ReadAll(fd, &e->text[n], 1))
+		{
+			return 0;
+		}
+		if (e->text[n++] == '\n')
+		{
+			break;
+		}
+	}
+	e->text[n] = '\0';
+
+	int size;
+	if (sscanf(e->text, "FRAME %d %d %d %d %d", &e->id, &e->samples, &e->width, &e->height, &size) == 5)
+	{
+		e->type = RENDER_FRAME;
+		e->image = size > 0 ? (byte*)malloc(size) : NULL;
+		if (e->image)
+		{
+			return ReadAll(fd, e->image, size);
+		}
+
+		//ڴ治ʱһ֡ݶ,image,ϺϢճ
+		byte skip[4096];
+		while (size > 0)
+		{
+			int n = size < (int)sizeof(skip) ? size : (int)sizeof(skip);
+			if (!ReadAll(fd, skip, n))
+			{
+				return 0;
+			}
+			size -= n;
+		}
+		return 1;
+	}
+
+	e->type = RENDER_ERROR;
+	if (sscanf(e->text, "ACCEPTED %d", &e->id) == 1)
+	{
+		e->type = RENDER_ACCEPTED;
+	}
+	else if (sscanf(e->text, "DONE %d", &e->id) == 1)
+	{
+		e->type = RENDER_DONE;
+	}
+	else if (sscanf(e->text, "CANCELLED %d", &e->id) == 1)
+	{
+		e->type = RENDER_CANCELLED;
+	}
+	else
+	{
+		sscanf(e->text, "ERROR %d", &e->id);
+	}
+	return 1;
+}
+
+int ReadAll(int fd, void* data, int size)
+{
+	byte* p = (byte*)data;
+	while (size > 0)
+	{
+		int n = (int)read(fd, p, size);
+		if (n <= 0)
+		{
+			return 0;
+		}
+		p += n;
+		size -= n;
+	}
+	return 1;
+}
+
+int WriteAll(int fd, const void* data, int size)
+{
+	const byte* p = (const byte*)data;
+	while (size > 0)
+	{
+		int n = (int)write(fd, p, size);
+		if (n <= 0)
+		{
+			return 0;
+		}
+		p += n;
+		size -= n;
+	}
+	return 1;
+}
+
+
+//DOC
+//RenderServerĿͻ
+//RenderConnect/RenderSubmit/RenderCancel/RenderWaitĸȫӿ,߿ֱӿȥ
+//һϿͬʱύܶ,idɿͻԼ,شϢid
+//RenderWaitõFRAMEǽ,鷭,Ԥ,ҪĻֱӺ,DONE
@@ -0,0 +1,786 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define EPSILON                   (1e-6f)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//
+#define SOCKET_PATH               "/tmp/light2d.sock"
+#define MAX_WIDTH                 (8192)
+#define MAX_SAMPLE                (65536)
+#define FIRST_PASS_SAMPLE         (4)     //һֻ׷ô,ͻһԤ
+#define BAND_HEIGHT               (16)    //һȾ
+#define LINE_LENGTH               (512)
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+typedef TraceResult(*SceneFunc)(float x, float y);
+
+//һͻ,ش
+typedef struct Connection
+{
+	int fd;
+	int refs;                 //̺߳δһ
+	pthread_mutex_t lock;     //֤һϢͷд
+} Connection;
+
+//һȾ,齥Ⱦ,ÿһдָ̳߳
+typedef struct Job
+{
+	int id, priority;
+	unsigned long long order; //ͬȼ
+	SceneFunc scene;
+	int width, height, samples;
+	char output[256];         //"-"ʾֻشдļ
+	Connection* conn;
+
+	Color* accum;             //ۻķ֮
+	int done;                 //Ѿɵ
+	int passSample;           //һÿص
+	int nextBand, bandDone, bandCount, inflight;
+	int cancelled;
+
+	struct Job* next;
+} Job;
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+pthread_mutex_t queueLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t queueCond = PTHREAD_COND_INITIALIZER;
+Job* jobs = NULL;
+unsigned long long jobOrder = 0;
+
+TraceResult BasicScene(float x, float y);
+
+TraceResult TriangleScene(float x, float y);
+
+TraceResult IntersecScene(float x, float y);
+
+TraceResult ReflectScene(float x, float y);
+
+TraceResult FresnelScene(float x, float y);
+
+TraceResult BeerLambertScene(float x, float y);
+
+//ͨѡĳ,ӦpngĿ¼µĲοͼ
+struct { const char* name; SceneFunc scene; } scenes[] =
+{
+	{ "basic",        BasicScene },
+	{ "triangle",     TriangleScene },
+	{ "intersec",     IntersecScene },
+	{ "reflect",      ReflectScene },
+	{ "fresnel",      FresnelScene },
+	{ "beer_lambert", BeerLambertScene },
+};
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(SceneFunc scene, float x, float y, int count, unsigned int seed);
+
+float Random(unsigned int* seed);
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(SceneFunc scene, float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(SceneFunc scene, float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+void* Worker(void* arg);
+
+void* Serve(void* arg);
+
+Job* PickJob();
+
+void RemoveJob(Job* job);
+
+void FreeJob(Job* job);
+
+void Retire(Job* job);
+
+byte* Quantize(const Job* job);
+
+void Release(Connection* conn);
+
+int Send(Connection* conn, const char* line, const void* data, int size);
+
+void Submit(Connection* conn, const char* line);
+
+void Cancel(Connection* conn, int id);
+
+int main(int argc, char* argv[])
+{
+	//RenderServer [socket·] [߳]
+	const char* path = argc > 1 ? argv[1] : SOCKET_PATH;
+	long threads = argc > 2 ? atol(argv[2]) : sysconf(_SC_NPROCESSORS_ONLN);
+	if (threads < 1)
+	{
+		threads = 1;
+	}
+
+	signal(SIGPIPE, SIG_IGN);//ͻǰϿʱдsocketҪѷɱ
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+	unlink(path);
+	if (fd < 0 || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0)
+	{
+		perror("RenderServer");
+		return 1;
+	}
+
+	//ӹһ̳߳
+	for (long i = 0; i < threads; ++i)
+	{
+		pthread_t t;
+		pthread_create(&t, NULL, Worker, NULL);
+		pthread_detach(t);
+	}
+	printf("RenderServer listening on %s with %ld threads\n", path, threads);
+	fflush(stdout);
+
+	for (;;)
+	{
+		int client = accept(fd, NULL, NULL);
+		if (client < 0)
+		{
+			continue;
+		}
+
+		Connection* conn = (Connection*)calloc(1, sizeof(Connection));
+		if (!conn)
+		{
+			close(client);
+			continue;
+		}
+		conn->fd = client;
+		conn->refs = 1;
+		pthread_mutex_init(&conn->lock, NULL);
+
+		pthread_t t;
+		pthread_create(&t, NULL, Serve, conn);
+		pthread_detach(t);
+	}
+}
+
+void* Serve(void* arg)
+{
+	//ÿһ߳,н
+	//RENDER <id> <scene> <width> <height> <samples> <priority> <output>
+	//CANCEL <id>
+	Connection* conn = (Connection*)arg;
+	char buffer[LINE_LENGTH];
+	int length = 0;
+
+	for (;;)
+	{
+		int n = (int)read(conn->fd, buffer + length, sizeof(buffer) - 1 - length);
+		if (n <= 0)
+		{
+			break;
+		}
+		length += n;
+		buffer[length] = '\0';
+
+		char* line = buffer;
+		char* end;
+		while ((end = strchr(line, '\n')) != NULL)
+		{
+			*end = '\0';
+			int id;
+			if (strncmp(line, "RENDER ", 7) == 0)
+			{
+				Submit(conn, line + 7);
+			}
+			else if (sscanf(line, "CANCEL %d", &id) == 1)
+			{
+				Cancel(conn, id);
+			}
+			else if (*line)
+			{
+				Send(conn, "ERROR -1 unknown command\n", NULL, 0);
+			}
+			line = end + 1;
+		}
+
+		//ûжİŲͷ,һ̫Ͷ
+		length = (int)(buffer + length - line);
+		memmove(buffer, line, length);
+		if (length == sizeof(buffer) - 1)
+		{
+			length = 0;
+		}
+	}
+
+	//ӶϿ,ȡе
+	Cancel(conn, -1);
+
+	Release(conn);
+	return NULL;
+}
+
+void Submit(Connection* conn, const char* line)
+{
+	char name[64], reply[LINE_LENGTH];
+	Job* job = (Job*)calloc(1, sizeof(Job));
+	if (!job)
+	{
+		Send(conn, "ERROR -1 out of memory\n", NULL, 0);
+		return;
+	}
+	if (sscanf(line, "%d %63s %d %d %d %d %255s", &job->id, name, &job->width, &job->height, &job->samples, &job->priority, job->output) != 7)
+	{
+		Send(conn, "ERROR -1 bad RENDER command\n", NULL, 0);
+		free(job);
+		return;
+	}
+
+	for (int i = 0; i < (int)(sizeof(scenes) / sizeof(scenes[0])); ++i)
+	{
+		if (strcmp(scenes[i].name, name) == 0)
+		{
+			job->scene = scenes[i].scene;
+		}
+	}
+	if (!job->scene || job->width <= 0 || job->height <= 0 || job->width > MAX_WIDTH || job->height > MAX_WIDTH || job->samples <= 0 || job->samples > MAX_SAMPLE)
+	{
+		sprintf(reply, "ERROR %d bad scene or size\n", job->id);
+		Send(conn, reply, NULL, 0);
+		free(job);
+		return;
+	}
+
+	job->accum = (Color*)calloc((size_t)job->width * job->height, sizeof(Color));
+	if (!job->accum)
+	{
+		sprintf(reply, "ERROR %d out of memory\n", job->id);
+		Send(conn, reply, NULL, 0);
+		free(job);
+		return;
+	}
+	job->passSample = job->samples < FIRST_PASS_SAMPLE ? job->samples : FIRST_PASS_SAMPLE;
+	job->bandCount = (job->height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+	job->conn = conn;
+
+	pthread_mutex_lock(&queueLock);
+	++conn->refs;
+	job->order = jobOrder++;
+	job->next = jobs;
+	jobs = job;
+	pthread_cond_broadcast(&queueCond);
+	pthread_mutex_unlock(&queueLock);
+
+	sprintf(reply, "ACCEPTED %d\n", job->id);
+	Send(conn, reply, NULL, 0);
+}
+
+void Cancel(Connection* conn, int id)
+{
+	//idΪ-1ʱȡӵȫ;Ⱦһдɹ߳ͷ
+	Job* finished = NULL;
+	pthread_mutex_lock(&queueLock);
+	for (Job* job = jobs, *next; job; job = next)
+	{
+		next = job->next;
+		if (job->conn != conn || (id != -1 && job->id != id))
+		{
+			continue;
+		}
+		job->cancelled = 1;
+		if (job->inflight == 0)
+		{
+			RemoveJob(job);
+			job->next = finished;
+			finished = job;
+		}
+	}
+	pthread_mutex_unlock(&queueLock);
+
+	while (finished)
+	{
+		Job* next = finished->next;
+		Retire(finished);
+		finished = next;
+	}
+}
+
+Job* PickJob()
+{
+	//ȼߵ,ͬȼύ;Ѿȡһдֳȥ˵
+	Job* best = NULL;
+	for (Job* job = jobs; job; job = job->next)
+	{
+		if (job->cancelled || job->nextBand >= job->bandCount)
+		{
+			continue;
+		}
+		if (!best || job->priority > best->priority || (job->priority == best->priority && job->order < best->order))
+		{
+			best = job;
+		}
+	}
+	return best;
+}
+
+void RemoveJob(Job* job)
+{
+	Job** p = &jobs;
+	while (*p != job)
+	{
+		p = &(*p)->next;
+	}
+	*p = job->next;
+}
+
+void FreeJob(Job* job)
+{
+	Connection* conn = job->conn;
+	free(job->accum);
+	free(job);
+	Release(conn);
+}
+
+void Release(Connection* conn)
+{
+	pthread_mutex_lock(&queueLock);
+	int refs = --conn->refs;
+	pthread_mutex_unlock(&queueLock);
+	if (refs == 0)
+	{
+		close(conn->fd);
+		pthread_mutex_destroy(&conn->lock);
+		free(conn);
+	}
+}
+
+int Send(Connection* conn, const char* line, const void* data, int size)
+{
+	pthread_mutex_lock(&conn->lock);
+	int ok = 1;
+	const char* p = line;
+	int n = (int)strlen(line);
+	for (int pass = 0; pass < 2 && ok; ++pass)
+	{
+		while (n > 0)
+		{
+			int w = (int)write(conn->fd, p, n);
+			if (w <= 0)
+			{
+				ok = 0;
+				break;
+			}
+			p += w;
+			n -= w;
+		}
+		p = (const char*)data;
+		n = size;
+	}
+	pthread_mutex_unlock(&conn->lock);
+	return ok;
+}
+
+void* Worker(void* arg)
+{
+	(void)arg;
+	for (;;)
+	{
+		pthread_mutex_lock(&queueLock);
+		Job* job;
+		while ((job = PickJob()) == NULL)
+		{
+			pthread_cond_wait(&queueCond, &queueLock);
+		}
+		int band = job->nextBand++;
+		int done = job->done, count = job->passSample;
+		++job->inflight;
+		pthread_mutex_unlock(&queueLock);
+
+		//Ⱦһд,һӵۻ;ÿһӲͬ,ۻȼһ׷ٸ
+		int y1 = (band + 1) * BAND_HEIGHT < job->height ? (band + 1) * BAND_HEIGHT : job->height;
+		for (int y = band * BAND_HEIGHT; y < y1; ++y)
+		{
+			for (int x = 0; x < job->width; ++x)
+			{
+				unsigned int seed = (unsigned int)(y * job->width + x) * 9781u + (unsigned int)done * 6271u + 1u;
+				Color c = Sample(job->scene, (float)x / job->width, (float)y / job->height, count, seed);
+				Color* a = &job->accum[y * job->width + x];
+				*a = ColorAdd(*a, ColorScale(c, (float)count));
+			}
+		}
+
+		pthread_mutex_lock(&queueLock);
+		--job->inflight;
+		++job->bandDone;
+		//úͼǷȡͬһٽ,֤ȡֻͷһ
+		int retire = job->cancelled && job->inflight == 0;
+		if (retire)
+		{
+			RemoveJob(job);
+		}
+		int finished = 0, frame = 0, snapshot = 0;
+		if (!job->cancelled && job->bandDone == job->bandCount)
+		{
+			//һnextBandͣbandCount,PickJobٷֳд,ԺaccumҲ,
+			//,̲߳õ;һȿջشٿʼ
+			job->done += job->passSample;
+			frame = job->done;
+			finished = job->done >= job->samples;
+			if (finished)
+			{
+				RemoveJob(job);
+			}
+			else
+			{
+				++job->inflight;//شڼ,ȡͷŵ
+			}
+			snapshot = 1;
+		}
+		pthread_mutex_unlock(&queueLock);
+
+		char reply[LINE_LENGTH];
+		byte* image = snapshot ? Quantize(job) : NULL;
+		if (image)
+		{
+			//FRAME <id> <> <> <> <ֽ>,rgb24
+			int size = job->width * job->height * RGB;
+			sprintf(reply, "FRAME %d %d %d %d %d\n", job->id, frame, job->width, job->height, size);
+			Send(job->conn, reply, image, size);
+		}
+		if (finished)
+		{
+			if (!image)
+			{
+				sprintf(reply, "ERROR %d out of memory\n", job->id);
+			}
+			else if (strcmp(job->output, "-") != 0)
+			{
+				FILE* fp = fopen(job->output, "wb");
+				if (fp)
+				{
+					svpng(fp, job->width, job->height, image, 0);
+					fclose(fp);
+				}
+				sprintf(reply, fp ? "DONE %d %s\n" : "ERROR %d cannot write %s\n", job->id, job->output);
+			}
+			else
+			{
+				sprintf(reply, "DONE %d -\n", job->id);
+			}
+			Send(job->conn, reply, NULL, 0);
+			FreeJob(job);
+		}
+		else if (snapshot)
+		{
+			//ջش(ڴ治ʱش)ٿʼһ,
+			pthread_mutex_lock(&queueLock);
+			--job->inflight;
+			job->passSample = job->done < job->samples - job->done ? job->done : job->samples - job->done;
+			job->nextBand = job->bandDone = 0;
+			pthread_cond_broadcast(&queueCond);
+			retire = job->cancelled && job->inflight == 0;
+			if (retire)
+			{
+				RemoveJob(job);
+			}
+			pthread_mutex_unlock(&queueLock);
+		}
+		if (retire)
+		{
+			Retire(job);
+		}
+		free(image);
+	}
+	return NULL;
+}
+
+void Retire(Job* job)
+{
+	//ȡһ뿪֪߳ͨͻ˲ͷ
+	char reply[64];
+	sprintf(reply, "CANCELLED %d\n", job->id);
+	Send(job->conn, reply, NULL, 0);
+	FreeJob(job);
+}
+
+byte* Quantize(const Job* job)
+{
+	//,ʱһ黹ûпʼ,û߳accum;ڴ治ʱNULL
+	byte* image = (byte*)malloc((size_t)job->width * job->height * RGB);
+	if (!image)
+	{
+		return NULL;
+	}
+	float scale = 255.0f / job->done;
+	for (int i = 0; i < job->width * job->height; ++i)
+	{
+		Color c = job->accum[i];
+		image[i * RGB + 0] = (int)(fminf(c.r * scale, 255.0f));
+		image[i * RGB + 1] = (int)(fminf(c.g * scale, 255.0f));
+		image[i * RGB + 2] = (int)(fminf(c.b * scale, 255.0f));
+	}
+	return image;
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+Color Sample(SceneFunc scene, float x, float y, int count, unsigned int seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < count; ++i)
+	{
+		float radians = TWO_PI * (i + Random(&seed)) / count;   // 
+		sum = ColorAdd(sum, Trace(scene, x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / count);
+}
+
+#include "sdf.inc"
+
+Color Trace(SceneFunc scene, float ox, float oy, float dx, float dy, int depth)
+{
+	float t = 1e-3f;
+	float sign = scene(ox, oy).sdf > 0.0f ? 1.0f : -1.0f;
+
+	for (int i = 0; i < RAY_MARCHING_MAX_STEP && t < RAY_MARCHING_MAX_DISTANCE; ++i)
+	{
+		float x = ox + dx * t;
+		float y = oy + dy * t;
+		TraceResult r = scene(x, y);
+		if (r.sdf * sign  < EPSILON) //Ϊǹⲿп,ڹ߲ʱҪǷ
+		{
+			Color sum = r.emissive;
+			//SDFõǿɷ߿,TraceĵݹҪķΧ
+			if (depth < RAY_MAX_TRACE_STEP && ((r.reflectivity > 0.0f) || (r.eta > 0.0f)))
+			{
+				float reflect = r.reflectivity;
+				float nx, ny, rx, ry;
+				Gradient(scene, x, y, &nx, &ny);//㷨
+				//״ڲǻҪת
+				nx *= sign;
+				ny *= sign;
+				//׷
+				if (r.eta > 0.0f)
+				{
+					float eta = sign < 0.0f ? r.eta : 1.0f / r.eta;
+					//(dx,dy)
+					if (REFRACT == Refract(dx, dy, nx, ny, eta, &rx, &ry))
+					{
+						float cosi = -(dx * nx + dy * ny);
+						float cost = -(rx * nx + ry * ny);
+						reflect = sign < 0.0f ? Fresnel(cosi, cost, r.eta, 1.0f) : Fresnel(cosi, cost, 1.0f, r.eta);
+						Color trace = Trace(scene, x - nx * RAY_BIAS, y - ny * RAY_BIAS, rx, ry, depth + 1);
+						sum = ColorAdd(sum, ColorScale(trace, 1.0f - reflect));
+					}
+					else
+					{
+						//ȫ,
+						reflect = 1.0f;
+					}
+				}
+				//׷ٷ
+				if (reflect > 0.0f)
+				{
+					Reflect(dx, dy, nx, ny, &rx, &ry);
+					Color trace = Trace(scene, x + nx * RAY_BIAS, y + ny * RAY_BIAS, rx, ry, depth + 1);
+					sum = ColorAdd(sum, ColorScale(trace, reflect));
+				}
+			}
+			return ColorMultiply(sum, BeerLambert(r.absorption, t));
+		}
+
+		//߲ǹ״ڻ״
+		t += r.sdf * sign;
+	}
+
+	Color black = COLOR_BLACK;
+	return black;
+}
+
+void Reflect(float ix, float iy, float nx, float ny, float * rx, float * ry)
+{
+	float idotn2 = (ix * nx + iy * ny) * 2.0f;
+	*rx = ix - idotn2 * nx;
+	*ry = iy - idotn2 * ny;
+}
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float * rx, float * ry)
+{
+	//(nx,ny)ǵλ,(rx, ry)ǵλ
+	float idotn = ix * nx + iy * ny;
+	float k = 1.0f - eta * eta * (1.0f - idotn * idotn);
+	if (k < 0.0f)
+	{
+		return TOTAL_REFLECT;//ȫ
+	}
+
+	float a = eta * idotn + sqrtf(k);
+	*rx = eta * ix - a * nx;
+	*ry = eta * iy - a * ny;
+	return REFRACT;//
+}
+
+void Gradient(SceneFunc scene, float x, float y, float * nx, float * ny)
+{
+	//ݶƫ΢,ʹýֵ,xyϷֱ𲽽delta(ȡõEpsilon),Ȼ΢
+	*nx = (scene(x + EPSILON, y).sdf - scene(x - EPSILON, y).sdf) * (0.5f / EPSILON);
+	*ny = (scene(x, y + EPSILON).sdf - scene(x, y - EPSILON).sdf) * (0.5f / EPSILON);
+}
+
+float Fresnel(float cosi, float cost, float etai, float etat)
+{
+	float rs = (etat * cosi - etai * cost) / (etat * cosi + etai * cost);
+	float rp = (etai * cosi - etat * cost) / (etai * cosi + etat * cost);
+	//ͼѧǿǹƫ,ȡsƫpƫľֵ
+	return (rs * rs + rp * rp) * 0.5f;
+}
+
+Color BeerLambert(Color a, float d)
+{
+	Color c = { expf(-a.r * d), expf(-a.g * d), expf(-a.b * d) };
+	return c;
+}
+
+TraceResult BasicScene(float x, float y)
+{
+	//BasicMain.c
+	TraceResult r = { CircleSDF(x, y, 0.75f, 0.5f, 0.2f), 0.0f, 0.0f, { 2.0f, 2.0f, 2.0f }, COLOR_BLACK };
+	return r;
+}
+
+TraceResult TriangleScene(float x, float y)
+{
+	//SDFMain.c
+	TraceResult r = { TriangleSDF(x, y, 0.5f, 0.2f, 0.8f, 0.8f, 0.3f, 0.6f) - 0.1f, 0.0f, 0.0f, { 1.0f, 1.0f, 1.0f }, COLOR_BLACK };
+	return r;
+}
+
+TraceResult IntersecScene(float x, float y)
+{
+	//ShapeMain.c
+	TraceResult r1 = { CircleSDF(x, y, 0.3f, 0.5f, 0.20f), 0.0f, 0.0f, { 1.0f, 1.0f, 1.0f }, COLOR_BLACK };
+	TraceResult r2 = { CircleSDF(x, y, 0.4f, 0.5f, 0.20f), 0.0f, 0.0f, { 0.8f, 0.8f, 0.8f }, COLOR_BLACK };
+	return Intersec(r1, r2);
+}
+
+TraceResult ReflectScene(float x, float y)
+{
+	//ReflectMain.c
+	TraceResult a = { CircleSDF(x, y, 0.4f, 0.2f, 0.1f), 0.0f, 0.0f, { 2.0f, 2.0f, 2.0f }, COLOR_BLACK };
+	TraceResult b = { BoxSDF(x, y, 0.5f, 0.8f, TWO_PI / 16.0f, 0.1f, 0.1f), 0.9f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+	TraceResult c = { BoxSDF(x, y, 0.8f, 0.5f, TWO_PI / 16.0f, 0.1f, 0.1f), 0.9f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+	return Union(Union(a, b), c);
+}
+
+TraceResult FresnelScene(float x, float y)
+{
+	//RefractMain.cFresnelMain.c
+	x = fabsf(x - 0.5f) + 0.5f;
+	TraceResult a = { CapsuleSDF(x, y, 0.75f, 0.25f, 0.75f, 0.75f, 0.05f), 0.2f, 1.5f, COLOR_BLACK, COLOR_BLACK };
+	TraceResult b = { CapsuleSDF(x, y, 0.75f, 0.25f, 0.50f, 0.75f, 0.05f), 0.2f, 1.5f, COLOR_BLACK, COLOR_BLACK };
+	y = fabsf(y - 0.5f) + 0.5f;
+	TraceResult c = { CircleSDF(x, y, 1.05f, 1.05f, 0.05f), 0.0f, 0.0f, { 5.0f, 5.0f, 5.0f }, COLOR_BLACK };
+	return Union(a, Union(b, c));
+}
+
+TraceResult BeerLambertScene(float x, float y)
+{
+	//BeerLambert.c
+	TraceResult a = { CircleSDF(x, y, 0.5f, -0.2f, 0.1f), 0.0f, 0.0f, { 10.0f, 10.0f, 10.0f }, COLOR_BLACK };
+	TraceResult b = { NgonSDF(x, y, 0.5f, 0.5f, 0.25f, 5.0f), 0.0f, 1.5f, COLOR_BLACK, { 4.0f, 4.0f, 1.0f } };
+	return Union(a, b);
+}
+//
+//
+////DOC:
+////פȾ
+//ÿȾҪһ,·дڴ,ȾǧСʱܿɹ
+//RenderServerפں̨,ͨUnixsocket,ӹһ̳߳:
+//1.Эһһ
+//  RENDER <id> <scene> <width> <height> <samples> <priority> <output>   outputΪ"-"ʱֻشдļ
+//  CANCEL <id>
+//  ˻ظ ACCEPTED / FRAME / DONE / CANCELLED / ERROR,FRAMEкrgb24
+//2.񰴱齥Ⱦ,һFIRST_PASS_SAMPLE,֮ÿ,ÿشһ֡
+//  һ֡ڶ,ʱһ黹ûзֳд,accum;ճȾ
+//3.ÿһ鰴BAND_HEIGHTвС,߳ÿδȼߵһд,
+//  Ըȼύһдܿʼ
+//4.ȡٷд,Ⱦдͷ;ӶϿʱȡȫ
+//UnixsocketpthreadPOSIXӿ,ֻLinux/macOSϱ
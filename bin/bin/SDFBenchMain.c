@@ -0,0 +1,754 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define USE_SSE2
+#endif
+
+#define EPSILON                   (1e-6f)
+#define TWO_PI                    (6.28318530718f)
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+
+#define POINT_COUNT               (1 << 16)  //Եĸ,xyһ512KB,ŵýL2
+#define MIN_TIME                  (0.05)     //ÿβô
+#define REPEAT                    (5)        //ÿ,ȡһ
+#define CSG_MAX_DEPTH             (16)
+#define LEAF_RADIUS               (0.12f)
+#define REGRESSION_TOLERANCE      (0.1f)     //-compareʱȻ׼10%˻
+
+#define BENCH_SCHEMA              "light2d-sdf-bench"
+#define BENCH_SCHEMA_VERSION      (1)
+
+#if defined(_MSC_VER)
+#define COMPILER_NAME             "msvc"
+#elif defined(__clang__)
+#define COMPILER_NAME             "clang " __clang_version__
+#elif defined(__GNUC__)
+#define COMPILER_NAME             "gcc " __VERSION__
+#else
+#define COMPILER_NAME             "unknown"
+#endif
+
+//״,ͳ÷һ,SIMD湲
+#define CIRCLE                    0.3f, 0.3f, 0.1f
+#define PLANE                     0.0f, 0.95f, 0.0f, -1.0f
+#define SEGMENT                   0.6f, 0.2f, 0.9f, 0.3f
+#define CAPSULE                   0.1f, 0.6f, 0.3f, 0.8f, 0.05f
+#define BOX                       0.7f, 0.5f, 0.3f, 0.1f, 0.05f
+#define TRIANGLE                  0.4f, 0.6f, 0.55f, 0.65f, 0.45f, 0.8f
+#define NGON                      0.8f, 0.8f, 0.1f, 5.0f
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+//һδn,mCSGĲ,depthmֻCSG
+typedef void (*BatchFunc)(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+typedef struct
+{
+	const char* name;
+	const char* kind;
+	int depth;
+	BatchFunc scalar, simd;  //simdûSSE2ʱNULL
+} BenchDesc;
+
+typedef struct
+{
+	char name[64], kind[16], impl[16];
+	int depth;
+	float nsPerEval;
+} BenchRecord;
+
+float px[POINT_COUNT], py[POINT_COUNT];
+
+float result[POINT_COUNT], reference[POINT_COUNT], material[POINT_COUNT];
+
+float leafX[CSG_MAX_DEPTH + 1], leafY[CSG_MAX_DEPTH + 1];
+
+BenchRecord baseline[256];
+
+int baselineCount;
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+void GeneratePoints();
+
+double Measure(BatchFunc f, int depth);
+
+int LoadBaseline(const char* path);
+
+const BenchRecord* FindBaseline(const char* name, int depth, const char* impl);
+
+void CircleScalar(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void PlaneScalar(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void SegmentScalar(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void CapsuleScalar(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void BoxScalar(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void TriangleScalar(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void NgonScalar(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void UnionScalar(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void IntersecScalar(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void SubtractScalar(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+#ifdef USE_SSE2
+void CircleSIMD(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void PlaneSIMD(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void SegmentSIMD(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void CapsuleSIMD(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void BoxSIMD(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void TriangleSIMD(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void NgonSIMD(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void UnionSIMD(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void IntersecSIMD(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+void SubtractSIMD(const float* x, const float* y, float* d, float* m, int n, int depth);
+
+#define SIMD(f) f
+#else
+#define SIMD(f) NULL
+#endif
+
+int main(int argc, char* argv[])
+{
+	//SDFBenchMain [json] [-compare ׼json] : Ȼ׼REGRESSION_TOLERANCEʱ1
+	const BenchDesc benches[] =
+	{
+		{ "CircleSDF", "primitive", 0, CircleScalar, SIMD(CircleSIMD) },
+		{ "PlaneSDF", "primitive", 0, PlaneScalar, SIMD(PlaneSIMD) },
+		{ "SegmentSDF", "primitive", 0, SegmentScalar, SIMD(SegmentSIMD) },
+		{ "CapsuleSDF", "primitive", 0, CapsuleScalar, SIMD(CapsuleSIMD) },
+		{ "BoxSDF", "primitive", 0, BoxScalar, SIMD(BoxSIMD) },
+		{ "TriangleSDF", "primitive", 0, TriangleScalar, SIMD(TriangleSIMD) },
+		{ "NgonSDF", "primitive", 0, NgonScalar, SIMD(NgonSIMD) },
+		{ "Union", "csg", 1, UnionScalar, SIMD(UnionSIMD) },
+		{ "Union", "csg", 4, UnionScalar, SIMD(UnionSIMD) },
+		{ "Union", "csg", 16, UnionScalar, SIMD(UnionSIMD) },
+		{ "Intersec", "csg", 1, IntersecScalar, SIMD(IntersecSIMD) },
+		{ "Intersec", "csg", 4, IntersecScalar, SIMD(IntersecSIMD) },
+		{ "Intersec", "csg", 16, IntersecScalar, SIMD(IntersecSIMD) },
+		{ "Subtract", "csg", 1, SubtractScalar, SIMD(SubtractSIMD) },
+		{ "Subtract", "csg", 4, SubtractScalar, SIMD(SubtractSIMD) },
+		{ "Subtract", "csg", 16, SubtractScalar, SIMD(SubtractSIMD) },
+	};
+	const int benchCount = (int)(sizeof(benches) / sizeof(benches[0]));
+	const char* output = "sdf_bench.json";
+	const char* compare = NULL;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-compare") == 0 && i + 1 < argc)
+		{
+			compare = argv[++i];
+		}
+		else
+		{
+			output = argv[i];
+		}
+	}
+	if (compare && !LoadBaseline(compare))
+	{
+		printf("can not read %s\n", compare);
+		return 1;
+	}
+
+	FILE* fp = fopen(output, "w");
+	if (!fp)
+	{
+		printf("can not write %s\n", output);
+		return 1;
+	}
+
+	GeneratePoints();
+	for (int i = 0; i <= CSG_MAX_DEPTH; ++i)
+	{
+		float radians = TWO_PI * i / (CSG_MAX_DEPTH + 1);
+		leafX[i] = 0.5f + 0.3f * cosf(radians);
+		leafY[i] = 0.5f + 0.3f * sinf(radians);
+	}
+
+	fprintf(fp, "{\n");
+	fprintf(fp, "  \"schema\": \"%s\",\n", BENCH_SCHEMA);
+	fprintf(fp, "  \"version\": %d,\n", BENCH_SCHEMA_VERSION);
+	fprintf(fp, "  \"compiler\": \"%s\",\n", COMPILER_NAME);
+#ifdef USE_SSE2
+	fprintf(fp, "  \"simd\": \"sse2\",\n");
+#else
+	fprintf(fp, "  \"simd\": \"none\",\n");
+#endif
+	fprintf(fp, "  \"points\": %d,\n", POINT_COUNT);
+	fprintf(fp, "  \"repeat\": %d,\n", REPEAT);
+	fprintf(fp, "  \"results\": [\n");
+
+	int regressed = 0, first = 1;
+	printf("%-12s %5s %-6s %10s %12s %8s %10s\n", "name", "depth", "impl", "ns/eval", "Mevals/s", "inside", "max error");
+	for (int b = 0; b < benchCount; ++b)
+	{
+		for (int s = 0; s < 2; ++s)
+		{
+			BatchFunc f = s == 0 ? benches[b].scalar : benches[b].simd;
+			const char* impl = s == 0 ? "scalar" : "sse2";
+			if (!f)
+			{
+				continue;
+			}
+
+			double ns = Measure(f, benches[b].depth);
+			int inside = 0;
+			float maxError = 0.0f;
+			if (s == 0)
+			{
+				memcpy(reference, result, sizeof(result));
+			}
+			for (int i = 0; i < POINT_COUNT; ++i)
+			{
+				inside += reference[i] < 0.0f;
+				maxError = fmaxf(maxError, fabsf(result[i] - reference[i]));
+			}
+
+			fprintf(fp, "%s    { \"name\": \"%s\", \"kind\": \"%s\", \"depth\": %d, \"impl\": \"%s\", \"ns_per_eval\": %.4f, \"evals_per_sec\": %.0f, \"inside\": %.4f, \"max_error\": %.3g }",
+				first ? "" : ",\n", benches[b].name, benches[b].kind, benches[b].depth, impl, ns, 1e9 / ns, (float)inside / POINT_COUNT, maxError);
+			first = 0;
+			printf("%-12s %5d %-6s %10.3f %12.1f %7.2f%% %10.3g", benches[b].name, benches[b].depth, impl, ns, 1e3 / ns, 100.0f * inside / POINT_COUNT, maxError);
+
+			const BenchRecord* base = compare ? FindBaseline(benches[b].name, benches[b].depth, impl) : NULL;
+			if (base)
+			{
+				float ratio = (float)ns / base->nsPerEval;
+				int slower = ratio > 1.0f + REGRESSION_TOLERANCE;
+				printf("  %+6.1f%%%s", (ratio - 1.0f) * 100.0f, slower ? " REGRESSED" : "");
+				regressed += slower;
+			}
+			printf("\n");
+		}
+	}
+	fprintf(fp, "\n  ]\n}\n");
+	fclose(fp);
+	printf("results written to %s\n", output);
+
+	if (regressed)
+	{
+		printf("%d benchmark(s) REGRESSED\n", regressed);
+		return 1;
+	}
+	return 0;
+}
+
+float Random(unsigned int* seed)
+{
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+float SceneSDF(float x, float y)
+{
+	float d = fminf(CircleSDF(x, y, CIRCLE), PlaneSDF(x, y, PLANE));
+	d = fminf(d, SegmentSDF(x, y, SEGMENT));
+	d = fminf(d, CapsuleSDF(x, y, CAPSULE));
+	d = fminf(d, BoxSDF(x, y, BOX));
+	d = fminf(d, TriangleSDF(x, y, TRIANGLE));
+	return fminf(d, NgonSDF(x, y, NGON));
+}
+
+void GeneratePoints()
+{
+	//Եȡ߲ʱֵλ:󲿷״ϺͿհ״,ٲ״,ķֲ
+	unsigned int seed = 9781u;
+	int count = 0;
+	while (count < POINT_COUNT)
+	{
+		float ox = Random(&seed), oy = Random(&seed);
+		float radians = TWO_PI * Random(&seed);
+		float dx = cosf(radians), dy = sinf(radians);
+		float t = 0.0f;
+		for (int i = 0; i < RAY_MARCHING_MAX_STEP && t < RAY_MARCHING_MAX_DISTANCE && count < POINT_COUNT; ++i)
+		{
+			float x = ox + dx * t, y = oy + dy * t;
+			float sd = SceneSDF(x, y);
+			px[count] = x;
+			py[count] = y;
+			++count;
+			//״ʱȥһ
+			if (fabsf(sd) < EPSILON)
+			{
+				break;
+			}
+			t += fabsf(sd);
+		}
+	}
+}
+
+double Measure(BatchFunc f, int depth)
+{
+	double best = 1e30;
+	for (int r = 0; r < REPEAT; ++r)
+	{
+		int runs = 0;
+		double start = Now(), elapsed;
+		do
+		{
+			f(px, py, result, material, POINT_COUNT, depth);
+			++runs;
+			elapsed = Now() - start;
+		} while (elapsed < MIN_TIME);
+		best = fmin(best, elapsed / runs);
+	}
+	return best * 1e9 / POINT_COUNT;
+}
+
+int LoadBaseline(const char* path)
+{
+	//ֻԼдĸʽ:ÿһ,ֶ˳̶
+	FILE* fp = fopen(path, "r");
+	if (!fp)
+	{
+		return 0;
+	}
+	char line[512];
+	baselineCount = 0;
+	while (fgets(line, sizeof(line), fp) && baselineCount < (int)(sizeof(baseline) / sizeof(baseline[0])))
+	{
+		BenchRecord* r = &baseline[baselineCount];
+		if (sscanf(line, " { \"name\": \"%63[^\"]\", \"kind\": \"%15[^\"]\", \"depth\": %d, \"impl\": \"%15[^\"]\", \"ns_per_eval\": %f",
+			r->name, r->kind, &r->depth, r->impl, &r->nsPerEval) == 5)
+		{
+			++baselineCount;
+		}
+	}
+	fclose(fp);
+	return 1;
+}
+
+const BenchRecord* FindBaseline(const char* name, int depth, const char* impl)
+{
+	for (int i = 0; i < baselineCount; ++i)
+	{
+		if (strcmp(baseline[i].name, name) == 0 && baseline[i].depth == depth && strcmp(baseline[i].impl, impl) == 0)
+		{
+			return &baseline[i];
+		}
+	}
+	return NULL;
+}
+
+void CircleScalar(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	(void)m;
+	(void)depth;
+	for (int i = 0; i < n; ++i)
+	{
+		d[i] = CircleSDF(x[i], y[i], CIRCLE);
+	}
+}
+
+void PlaneScalar(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	(void)m;
+	(void)depth;
+	for (int i = 0; i < n; ++i)
+	{
+		d[i] = PlaneSDF(x[i], y[i], PLANE);
+	}
+}
+
+void SegmentScalar(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	(void)m;
+	(void)depth;
+	for (int i = 0; i < n; ++i)
+	{
+		d[i] = SegmentSDF(x[i], y[i], SEGMENT);
+	}
+}
+
+void CapsuleScalar(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	(void)m;
+	(void)depth;
+	for (int i = 0; i < n; ++i)
+	{
+		d[i] = CapsuleSDF(x[i], y[i], CAPSULE);
+	}
+}
+
+void BoxScalar(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	(void)m;
+	(void)depth;
+	for (int i = 0; i < n; ++i)
+	{
+		d[i] = BoxSDF(x[i], y[i], BOX);
+	}
+}
+
+void TriangleScalar(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	(void)m;
+	(void)depth;
+	for (int i = 0; i < n; ++i)
+	{
+		d[i] = TriangleSDF(x[i], y[i], TRIANGLE);
+	}
+}
+
+void NgonScalar(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	(void)m;
+	(void)depth;
+	for (int i = 0; i < n; ++i)
+	{
+		d[i] = NgonSDF(x[i], y[i], NGON);
+	}
+}
+
+//CSGҶһȦڵĻصԲ,depthdepth+1ҶӴ۵
+TraceResult Leaf(float x, float y, int k)
+{
+	TraceResult r = { CircleSDF(x, y, leafX[k], leafY[k], LEAF_RADIUS), 0.0f, 0.0f, { (float)k, 1.0f, 1.0f }, COLOR_BLACK };
+	return r;
+}
+
+void UnionScalar(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		TraceResult r = Leaf(x[i], y[i], 0);
+		for (int k = 1; k <= depth; ++k)
+		{
+			r = Union(r, Leaf(x[i], y[i], k));
+		}
+		d[i] = r.sdf;
+		m[i] = r.emissive.r;
+	}
+}
+
+void IntersecScalar(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		TraceResult r = Leaf(x[i], y[i], 0);
+		for (int k = 1; k <= depth; ++k)
+		{
+			r = Intersec(r, Leaf(x[i], y[i], k));
+		}
+		d[i] = r.sdf;
+		m[i] = r.emissive.r;
+	}
+}
+
+void SubtractScalar(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		TraceResult r = Leaf(x[i], y[i], 0);
+		for (int k = 1; k <= depth; ++k)
+		{
+			r = Subtract(r, Leaf(x[i], y[i], k));
+		}
+		d[i] = r.sdf;
+		m[i] = r.emissive.r;
+	}
+}
+
+#ifdef USE_SSE2
+//4һ,״4һ,ֻ㲥һ;״йصǺҲֻһ
+__m128 Abs4(__m128 x)
+{
+	return _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+}
+
+__m128 CircleSDF4(__m128 x, __m128 y, float cx, float cy, float radius)
+{
+	__m128 dx = _mm_sub_ps(x, _mm_set1_ps(cx));
+	__m128 dy = _mm_sub_ps(y, _mm_set1_ps(cy));
+	return _mm_sub_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy))), _mm_set1_ps(radius));
+}
+
+__m128 PlaneSDF4(__m128 x, __m128 y, float px, float py, float nx, float ny)
+{
+	return _mm_add_ps(_mm_mul_ps(_mm_sub_ps(x, _mm_set1_ps(px)), _mm_set1_ps(nx)),
+		_mm_mul_ps(_mm_sub_ps(y, _mm_set1_ps(py)), _mm_set1_ps(ny)));
+}
+
+__m128 SegmentSDF4(__m128 x, __m128 y, float ax, float ay, float bx, float by)
+{
+	float ux = bx - ax, uy = by - ay;
+	__m128 vx = _mm_sub_ps(x, _mm_set1_ps(ax)), vy = _mm_sub_ps(y, _mm_set1_ps(ay));
+	__m128 ux4 = _mm_set1_ps(ux), uy4 = _mm_set1_ps(uy);
+	__m128 dot = _mm_add_ps(_mm_mul_ps(vx, ux4), _mm_mul_ps(vy, uy4));
+	__m128 t = _mm_div_ps(dot, _mm_set1_ps(ux * ux + uy * uy));
+	t = _mm_max_ps(_mm_min_ps(t, _mm_set1_ps(1.0f)), _mm_setzero_ps());
+	__m128 dx = _mm_sub_ps(vx, _mm_mul_ps(ux4, t)), dy = _mm_sub_ps(vy, _mm_mul_ps(uy4, t));
+	return _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+}
+
+__m128 CapsuleSDF4(__m128 x, __m128 y, float ax, float ay, float bx, float by, float radius)
+{
+	return _mm_sub_ps(SegmentSDF4(x, y, ax, ay, bx, by), _mm_set1_ps(radius));
+}
+
+__m128 BoxSDF4(__m128 x, __m128 y, float ox, float oy, float theta, float sx, float sy)
+{
+	__m128 costheta = _mm_set1_ps(cosf(theta));
+	__m128 sintheta = _mm_set1_ps(sinf(theta));
+	__m128 lx = _mm_sub_ps(x, _mm_set1_ps(ox)), ly = _mm_sub_ps(y, _mm_set1_ps(oy));
+
+	__m128 dx = _mm_sub_ps(Abs4(_mm_add_ps(_mm_mul_ps(lx, costheta), _mm_mul_ps(ly, sintheta))), _mm_set1_ps(sx));
+	__m128 dy = _mm_sub_ps(Abs4(_mm_sub_ps(_mm_mul_ps(ly, costheta), _mm_mul_ps(lx, sintheta))), _mm_set1_ps(sy));
+
+	__m128 ax = _mm_max_ps(dx, _mm_setzero_ps());
+	__m128 ay = _mm_max_ps(dy, _mm_setzero_ps());
+
+	return _mm_add_ps(_mm_min_ps(_mm_max_ps(dx, dy), _mm_setzero_ps()), _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(ax, ax), _mm_mul_ps(ay, ay))));
+}
+
+//pabʱȫ1
+__m128 LeftOf4(__m128 x, __m128 y, float ax, float ay, float bx, float by)
+{
+	return _mm_cmpgt_ps(_mm_mul_ps(_mm_set1_ps(bx - ax), _mm_sub_ps(y, _mm_set1_ps(ay))),
+		_mm_mul_ps(_mm_set1_ps(by - ay), _mm_sub_ps(x, _mm_set1_ps(ax))));
+}
+
+__m128 TriangleSDF4(__m128 x, __m128 y, float ax, float ay, float bx, float by, float cx, float cy)
+{
+	__m128 d = _mm_min_ps(_mm_min_ps(SegmentSDF4(x, y, ax, ay, bx, by), SegmentSDF4(x, y, bx, by, cx, cy)),
+		SegmentSDF4(x, y, cx, cy, ax, ay));
+	__m128 inside = _mm_and_ps(_mm_and_ps(LeftOf4(x, y, ax, ay, bx, by), LeftOf4(x, y, bx, by, cx, cy)), LeftOf4(x, y, cx, cy, ax, ay));
+
+	//ĵ㷭תλ
+	return _mm_xor_ps(d, _mm_and_ps(inside, _mm_set1_ps(-0.0f)));
+}
+
+__m128 NgonSDF4(__m128 x, __m128 y, float cx, float cy, float r, float n)
+{
+	//NgonSDFatan2ҵڵߵľ;ǵnֱ߾ֵ,
+	//SSE2ûatan2,ĳɶnȡֵ,n
+	float a = TWO_PI / n;
+	float ca = cosf(a), sa = sinf(a);
+	float nx = cosf(a * 0.5f), ny = sinf(a * 0.5f);
+	__m128 ux = _mm_sub_ps(x, _mm_set1_ps(cx)), uy = _mm_sub_ps(y, _mm_set1_ps(cy));
+	__m128 d = _mm_set1_ps(-1e30f);
+	for (int k = 0; k < (int)n; ++k)
+	{
+		d = _mm_max_ps(d, _mm_add_ps(_mm_mul_ps(ux, _mm_set1_ps(nx)), _mm_mul_ps(uy, _mm_set1_ps(ny))));
+		float t = nx * ca - ny * sa;
+		ny = nx * sa + ny * ca;
+		nx = t;
+	}
+	return _mm_sub_ps(d, _mm_set1_ps(r * cosf(a * 0.5f)));
+}
+
+void CircleSIMD(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		_mm_storeu_ps(d + i, CircleSDF4(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i), CIRCLE));
+	}
+	CircleScalar(x + i, y + i, d + i, m + i, n - i, depth);
+}
+
+void PlaneSIMD(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		_mm_storeu_ps(d + i, PlaneSDF4(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i), PLANE));
+	}
+	PlaneScalar(x + i, y + i, d + i, m + i, n - i, depth);
+}
+
+void SegmentSIMD(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		_mm_storeu_ps(d + i, SegmentSDF4(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i), SEGMENT));
+	}
+	SegmentScalar(x + i, y + i, d + i, m + i, n - i, depth);
+}
+
+void CapsuleSIMD(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		_mm_storeu_ps(d + i, CapsuleSDF4(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i), CAPSULE));
+	}
+	CapsuleScalar(x + i, y + i, d + i, m + i, n - i, depth);
+}
+
+void BoxSIMD(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		_mm_storeu_ps(d + i, BoxSDF4(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i), BOX));
+	}
+	BoxScalar(x + i, y + i, d + i, m + i, n - i, depth);
+}
+
+void TriangleSIMD(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		_mm_storeu_ps(d + i, TriangleSDF4(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i), TRIANGLE));
+	}
+	TriangleScalar(x + i, y + i, d + i, m + i, n - i, depth);
+}
+
+void NgonSIMD(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		_mm_storeu_ps(d + i, NgonSDF4(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i), NGON));
+	}
+	NgonScalar(x + i, y + i, d + i, m + i, n - i, depth);
+}
+
+//SIMDCSGTraceResult,ֻͲʱ(Ҷӱ),ѡ
+#define SELECT4(mask, a, b) _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b))
+
+void UnionSIMD(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 x4 = _mm_loadu_ps(x + i), y4 = _mm_loadu_ps(y + i);
+		__m128 sdf = CircleSDF4(x4, y4, leafX[0], leafY[0], LEAF_RADIUS);
+		__m128 id = _mm_setzero_ps();
+		for (int k = 1; k <= depth; ++k)
+		{
+			__m128 leaf = CircleSDF4(x4, y4, leafX[k], leafY[k], LEAF_RADIUS);
+			__m128 mask = _mm_cmplt_ps(sdf, leaf);
+			id = SELECT4(mask, id, _mm_set1_ps((float)k));
+			sdf = SELECT4(mask, sdf, leaf);
+		}
+		_mm_storeu_ps(d + i, sdf);
+		_mm_storeu_ps(m + i, id);
+	}
+	UnionScalar(x + i, y + i, d + i, m + i, n - i, depth);
+}
+
+void IntersecSIMD(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 x4 = _mm_loadu_ps(x + i), y4 = _mm_loadu_ps(y + i);
+		__m128 sdf = CircleSDF4(x4, y4, leafX[0], leafY[0], LEAF_RADIUS);
+		__m128 id = _mm_setzero_ps();
+		for (int k = 1; k <= depth; ++k)
+		{
+			__m128 leaf = CircleSDF4(x4, y4, leafX[k], leafY[k], LEAF_RADIUS);
+			__m128 mask = _mm_cmpgt_ps(sdf, leaf);
+			id = SELECT4(mask, id, _mm_set1_ps((float)k));
+			sdf = SELECT4(mask, sdf, leaf);
+		}
+		_mm_storeu_ps(d + i, sdf);
+		_mm_storeu_ps(m + i, id);
+	}
+	IntersecScalar(x + i, y + i, d + i, m + i, n - i, depth);
+}
+
+void SubtractSIMD(const float* x, const float* y, float* d, float* m, int n, int depth)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 x4 = _mm_loadu_ps(x + i), y4 = _mm_loadu_ps(y + i);
+		__m128 sdf = CircleSDF4(x4, y4, leafX[0], leafY[0], LEAF_RADIUS);
+		for (int k = 1; k <= depth; ++k)
+		{
+			__m128 leaf = _mm_sub_ps(_mm_setzero_ps(), CircleSDF4(x4, y4, leafX[k], leafY[k], LEAF_RADIUS));
+			sdf = SELECT4(_mm_cmpgt_ps(sdf, leaf), sdf, leaf);
+		}
+		_mm_storeu_ps(d + i, sdf);
+	}
+	SubtractScalar(x + i, y + i, d + i, m + i, n - i, depth);
+}
+#endif
+
+#include "sdf.inc"
+//
+//
+////DOC:
+////SDF׼
+//֡ĺʱ￴ĸ״CSG,򵥶ÿSDFCSG:
+//1.ԵǶCircleSDFPlaneSDF...NgonSDFɵĳ߲ʱֵλ,״ϺͿհ״,
+//  ״ĹҲ߼,jsoninsideǲԵ״ı
+//2.ÿܵMIN_TIMEһ,REPEATȡ,ns/evalevals/sec
+//3.ֱӵø½ڵSDF,CSGø½ڵUnion/Intersec/Subtractdepth+1Բ۵;
+//  SSE2һ4,״ֻ㲥һ,BoxSDFNgonSDFǺÿ4ֻһ,
+//  NgonSDFĳɶnȡֵ,CSGֻͲʱ;max_errorǺͱ
+//4.дjson(Ĭsdf_bench.json),ʽ̶,ֶֻ,ĸʽʱversion:
+//  { "schema", "version", "compiler", "simd", "points", "repeat",
+//    "results": [ { "name", "kind", "depth", "impl", "ns_per_eval", "evals_per_sec", "inside", "max_error" } ] }
+//  ÿһ,kindprimitivecsg,primitivedepth0,implscalarsse2
+//5.SDFBenchMain new.json -compare old.json νǰԱ,REGRESSION_TOLERANCEʱ1
@@ -0,0 +1,645 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define USE_SSE2
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//ײ,λnm
+#define LAMBDA_MIN                (380.0f)
+#define LAMBDA_MAX                (730.0f)
+#define HERO_COUNT                (4)        //һ·ͬʱĲ,һSSEĴ
+
+//,GLASS_NONEʾʲ沨仯,ֱTraceResulteta
+#define GLASS_NONE                (0)
+#define GLASS_FLINT               (1)
+#define GLASS_BK7                 (2)
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+	int glass;
+}  TraceResult;
+
+//ɫɢ:Cauchy n = A + B/^2;Sellmeier n^2 = 1 +  Bi*^2/(^2 - Ci);˵λum,SellmeierBȫΪ0ʱCauchy
+typedef struct
+{
+	float cauchyA, cauchyB;
+	float b[3], c[3];
+} Glass;
+
+//һ·HERO_COUNTֵ,SSE2¾һĴ
+#ifdef USE_SSE2
+typedef __m128 Spectrum;
+#else
+typedef struct { float v[HERO_COUNT]; } Spectrum;
+#endif
+
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+byte image[WIDTH * HEIGHT * RGB];
+
+Color spectral[WIDTH * HEIGHT], rgb[WIDTH * HEIGHT];
+
+//RGBģʽµʺetaһ:flintdԼ1.706,BK7Լ1.5168
+const Glass glasses[] =
+{
+	{ 0.0f, 0.0f, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } },
+	{ 1.62f, 0.03f, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } },  //ػʯ,ɫɢʵĴ󼸱,
+	{ 0.0f, 0.0f, { 1.03961212f, 0.231792344f, 1.01046945f }, { 0.00600069867f, 0.0200179144f, 103.560653f } },
+};
+
+Color whiteBalance;  //ܰ׹⻻㵽RGBĵ,֤ɫĹԴģʽɫһ
+
+TraceResult Scene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, unsigned int* seed);
+
+Color SampleSpectral(float x, float y, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+Spectrum TraceSpectral(float ox, float oy, float dx, float dy, int depth, Spectrum lambda, int single);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+Spectrum GlassEta(const TraceResult* r, Spectrum lambda);
+
+Spectrum Upsample(Color c, Spectrum lambda);
+
+void ColorMatch(float lambda, float* x, float* y, float* z);
+
+Color XYZToRGB(float x, float y, float z);
+
+//SpectrumĻ,SSE2¶һָ
+Spectrum SpecSet1(float v);
+
+Spectrum SpecSet(float a, float b, float c, float d);
+
+float SpecGet(Spectrum s, int i);
+
+Spectrum SpecAdd(Spectrum a, Spectrum b);
+
+Spectrum SpecSub(Spectrum a, Spectrum b);
+
+Spectrum SpecMul(Spectrum a, Spectrum b);
+
+Spectrum SpecDiv(Spectrum a, Spectrum b);
+
+Spectrum SpecSqrt(Spectrum a);
+
+Spectrum SpecMax(Spectrum a, Spectrum b);
+
+Spectrum SpecSelectLess(Spectrum a, Spectrum b, Spectrum x, Spectrum y);
+
+int SpecAnyPositive(Spectrum a);
+
+Spectrum SpecExp(Spectrum a);
+
+void RenderImage(Color* out, Color (*sample)(float, float, unsigned int*));
+
+void WriteImage(const Color* c, const char* path);
+
+int main()
+{
+	//ܹ(ÿ1)ֵRGB,ĵǰƽϵ
+	float wx = 0.0f, wy = 0.0f, wz = 0.0f;
+	for (float lambda = LAMBDA_MIN; lambda < LAMBDA_MAX; lambda += 1.0f)
+	{
+		float x, y, z;
+		ColorMatch(lambda + 0.5f, &x, &y, &z);
+		wx += x;
+		wy += y;
+		wz += z;
+	}
+	Color white = XYZToRGB(wx, wy, wz);
+	whiteBalance.r = 1.0f / white.r;
+	whiteBalance.g = 1.0f / white.g;
+	whiteBalance.b = 1.0f / white.b;
+
+	double start = Now();
+	RenderImage(rgb, Sample);
+	printf("rgb render: %.2fs\n", Now() - start);
+	WriteImage(rgb, "..//..//png//spectral_rgb.png");
+
+	start = Now();
+	RenderImage(spectral, SampleSpectral);
+	printf("spectral render (%d wavelengths per path): %.2fs\n", HERO_COUNT, Now() - start);
+	WriteImage(spectral, "..//..//png//spectral.png");
+
+	printf("Svnpng Success\n");
+	return 0;
+}
+
+void RenderImage(Color* out, Color (*sample)(float, float, unsigned int*))
+{
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			unsigned int seed = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+			out[y * WIDTH + x] = sample((float)x / WIDTH, (float)y / HEIGHT, &seed);
+		}
+	}
+}
+
+Color SampleSpectral(float x, float y, unsigned int* seed)
+{
+	//ÿȡһ,3[LAMBDA_MIN,LAMBDA_MAX)ȼ,4ĸܶȶǾȵ
+	//Χﰴ߷ֲ㶶(ɫɢʱֻʣ,븲в);ֲ˳ÿ,ɫŷ
+	const float range = LAMBDA_MAX - LAMBDA_MIN;
+	int offset = (int)(Random(seed) * LIGHT_COUNT);
+	float sx = 0.0f, sy = 0.0f, sz = 0.0f;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		float hero = range * (((i * 37 + offset) % LIGHT_COUNT) + Random(seed)) / LIGHT_COUNT;
+		float lambdas[HERO_COUNT];
+		for (int j = 0; j < HERO_COUNT; ++j)
+		{
+			lambdas[j] = LAMBDA_MIN + fmodf(hero + j * range / HERO_COUNT, range);
+		}
+		Spectrum lambda = SpecSet(lambdas[0], lambdas[1], lambdas[2], lambdas[3]);
+		Spectrum radiance = TraceSpectral(x, y, cosf(radians), sinf(radians), 0, lambda, 0);
+
+		for (int j = 0; j < HERO_COUNT; ++j)
+		{
+			float cx, cy, cz, l = SpecGet(radiance, j);
+			ColorMatch(lambdas[j], &cx, &cy, &cz);
+			sx += l * cx;
+			sy += l * cy;
+			sz += l * cz;
+		}
+	}
+
+	//Ըܶ1/range,ٶLIGHT_COUNT*HERO_COUNTȡƽ
+	Color c = XYZToRGB(sx, sy, sz);
+	return ColorScale(ColorMultiply(c, whiteBalance), range / (LIGHT_COUNT * HERO_COUNT));
+}
+
+Spectrum TraceSpectral(float ox, float oy, float dx, float dy, int depth, Spectrum lambda, int single)
+{
+	float t = 1e-3f;
+	float sign = Scene(ox, oy).sdf > 0.0f ? 1.0f : -1.0f;
+
+	for (int i = 0; i < RAY_MARCHING_MAX_STEP && t < RAY_MARCHING_MAX_DISTANCE; ++i)
+	{
+		float x = ox + dx * t;
+		float y = oy + dy * t;
+		TraceResult r = Scene(x, y);
+		if (r.sdf * sign < EPSILON)
+		{
+			Spectrum sum = Upsample(r.emissive, lambda);
+			if (depth < RAY_MAX_TRACE_STEP && ((r.reflectivity > 0.0f) || (r.eta > 0.0f)))
+			{
+				const Spectrum one = SpecSet1(1.0f), zero = SpecSet1(0.0f);
+				Spectrum reflect = SpecSet1(r.reflectivity);
+				float nx, ny, rx, ry;
+				Gradient(x, y, &nx, &ny);
+				nx *= sign;
+				ny *= sign;
+				if (r.eta > 0.0f)
+				{
+					//ÿԵʺͷ;k<0Ĳȫ
+					Spectrum n = GlassEta(&r, lambda);
+					Spectrum etai = sign < 0.0f ? n : one, etat = sign < 0.0f ? one : n;
+					Spectrum eta = SpecDiv(etai, etat);
+					float cosi = -(dx * nx + dy * ny);
+					Spectrum k = SpecSub(one, SpecMul(SpecMul(eta, eta), SpecSet1(1.0f - cosi * cosi)));
+					Spectrum cost = SpecSqrt(SpecMax(k, zero));
+					Spectrum ci = SpecSet1(cosi);
+					Spectrum tci = SpecMul(etat, ci), ict = SpecMul(etai, cost);
+					Spectrum ici = SpecMul(etai, ci), tct = SpecMul(etat, cost);
+					Spectrum rs = SpecDiv(SpecSub(tci, ict), SpecAdd(tci, ict));
+					Spectrum rp = SpecDiv(SpecSub(ici, tct), SpecAdd(ici, tct));
+					reflect = SpecMul(SpecAdd(SpecMul(rs, rs), SpecMul(rp, rp)), SpecSet1(0.5f));
+					reflect = SpecSelectLess(k, zero, one, reflect);
+
+					//䷽ֻܸ,ǡ䵽:
+					//ɫɢĲֻ,HERO_COUNT⼸ķݶ(ֻڵһηֲʱ)
+					if (REFRACT == Refract(dx, dy, nx, ny, SpecGet(eta, 0), &rx, &ry))
+					{
+						int dispersive = r.glass != GLASS_NONE;
+						Spectrum weight = SpecSub(one, reflect);
+						if (dispersive && !single)
+						{
+							weight = SpecSet(HERO_COUNT * SpecGet(weight, 0), 0.0f, 0.0f, 0.0f);
+						}
+						Spectrum trace = TraceSpectral(x - nx * RAY_BIAS, y - ny * RAY_BIAS, rx, ry, depth + 1, lambda, single || dispersive);
+						sum = SpecAdd(sum, SpecMul(trace, weight));
+					}
+				}
+				//䷽Ͳ޹,вһ
+				if (SpecAnyPositive(reflect))
+				{
+					Reflect(dx, dy, nx, ny, &rx, &ry);
+					Spectrum trace = TraceSpectral(x + nx * RAY_BIAS, y + ny * RAY_BIAS, rx, ry, depth + 1, lambda, single);
+					sum = SpecAdd(sum, SpecMul(trace, reflect));
+				}
+			}
+			Spectrum absorption = Upsample(r.absorption, lambda);
+			return SpecMul(sum, SpecExp(SpecMul(absorption, SpecSet1(-t))));
+		}
+		t += r.sdf * sign;
+	}
+
+	return SpecSet1(0.0f);
+}
+
+Spectrum GlassEta(const TraceResult* r, Spectrum lambda)
+{
+	const Glass* g = &glasses[r->glass];
+	if (r->glass == GLASS_NONE)
+	{
+		return SpecSet1(r->eta);
+	}
+
+	Spectrum um = SpecMul(lambda, SpecSet1(1e-3f));
+	Spectrum um2 = SpecMul(um, um);
+	if (g->b[0] == 0.0f)
+	{
+		return SpecAdd(SpecSet1(g->cauchyA), SpecDiv(SpecSet1(g->cauchyB), um2));
+	}
+
+	Spectrum n2 = SpecSet1(1.0f);
+	for (int i = 0; i < 3; ++i)
+	{
+		n2 = SpecAdd(n2, SpecDiv(SpecMul(SpecSet1(g->b[i]), um2), SpecSub(um2, SpecSet1(g->c[i]))));
+	}
+	return SpecSqrt(n2);
+}
+
+Spectrum Upsample(Color c, Spectrum lambda)
+{
+	//RGB򵥵İ취:ֳ̡,ÿȡӦֵͨ;ɫԭɵܹ
+	float v[HERO_COUNT];
+	for (int j = 0; j < HERO_COUNT; ++j)
+	{
+		float l = SpecGet(lambda, j);
+		v[j] = l < 490.0f ? c.b : (l < 580.0f ? c.g : c.r);
+	}
+	return SpecSet(v[0], v[1], v[2], v[3]);
+}
+
+float Lobe(float lambda, float mu, float sigma1, float sigma2)
+{
+	float t = (lambda - mu) / (lambda < mu ? sigma1 : sigma2);
+	return expf(-0.5f * t * t);
+}
+
+void ColorMatch(float lambda, float* x, float* y, float* z)
+{
+	//CIE 1931ɫƥ亯Ķ˹(Wyman, Sloan, Shirley 2013)
+	*x = 1.056f * Lobe(lambda, 599.8f, 37.9f, 31.0f) + 0.362f * Lobe(lambda, 442.0f, 16.0f, 26.7f) - 0.065f * Lobe(lambda, 501.1f, 20.4f, 26.2f);
+	*y = 0.821f * Lobe(lambda, 568.8f, 46.9f, 40.5f) + 0.286f * Lobe(lambda, 530.9f, 16.3f, 31.1f);
+	*z = 1.217f * Lobe(lambda, 437.0f, 11.8f, 36.0f) + 0.681f * Lobe(lambda, 459.0f, 26.0f, 13.8f);
+}
+
+Color XYZToRGB(float x, float y, float z)
+{
+	//XYZsRGB
+	Color c = { 3.2406f * x - 1.5372f * y - 0.4986f * z, -0.9689f * x + 1.8758f * y + 0.0415f * z, 0.0557f * x - 0.2040f * y + 1.0570f * z };
+	return c;
+}
+
+#ifdef USE_SSE2
+Spectrum SpecSet1(float v)
+{
+	return _mm_set1_ps(v);
+}
+
+Spectrum SpecSet(float a, float b, float c, float d)
+{
+	return _mm_setr_ps(a, b, c, d);
+}
+
+float SpecGet(Spectrum s, int i)
+{
+	float v[4];
+	_mm_storeu_ps(v, s);
+	return v[i];
+}
+
+Spectrum SpecAdd(Spectrum a, Spectrum b)
+{
+	return _mm_add_ps(a, b);
+}
+
+Spectrum SpecSub(Spectrum a, Spectrum b)
+{
+	return _mm_sub_ps(a, b);
+}
+
+Spectrum SpecMul(Spectrum a, Spectrum b)
+{
+	return _mm_mul_ps(a, b);
+}
+
+Spectrum SpecDiv(Spectrum a, Spectrum b)
+{
+	return _mm_div_ps(a, b);
+}
+
+Spectrum SpecSqrt(Spectrum a)
+{
+	return _mm_sqrt_ps(a);
+}
+
+Spectrum SpecMax(Spectrum a, Spectrum b)
+{
+	return _mm_max_ps(a, b);
+}
+
+Spectrum SpecSelectLess(Spectrum a, Spectrum b, Spectrum x, Spectrum y)
+{
+	__m128 mask = _mm_cmplt_ps(a, b);
+	return _mm_or_ps(_mm_and_ps(mask, x), _mm_andnot_ps(mask, y));
+}
+
+int SpecAnyPositive(Spectrum a)
+{
+	return _mm_movemask_ps(_mm_cmpgt_ps(a, _mm_setzero_ps())) != 0;
+}
+
+Spectrum SpecExp(Spectrum x)
+{
+	//cephesexpf,BatchShadeMainExpSSEһ
+	const __m128 one = _mm_set1_ps(1.0f);
+	x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-87.3365f)), _mm_set1_ps(88.3762f));
+
+	__m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+	__m128 n = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+	n = _mm_sub_ps(n, _mm_and_ps(_mm_cmpgt_ps(n, fx), one));
+
+	x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(0.693359375f)));
+	x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(-2.12194440e-4f)));
+
+	__m128 y = _mm_set1_ps(1.9875691500e-4f);
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+	y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+	y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, _mm_mul_ps(x, x)), x), one);
+
+	__m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n), _mm_set1_epi32(127)), 23));
+	return _mm_mul_ps(y, scale);
+}
+#else
+Spectrum SpecSet1(float v)
+{
+	Spectrum s = { { v, v, v, v } };
+	return s;
+}
+
+Spectrum SpecSet(float a, float b, float c, float d)
+{
+	Spectrum s = { { a, b, c, d } };
+	return s;
+}
+
+float SpecGet(Spectrum s, int i)
+{
+	return s.v[i];
+}
+
+Spectrum SpecAdd(Spectrum a, Spectrum b)
+{
+	for (int i = 0; i < HERO_COUNT; ++i)
+	{
+		a.v[i] += b.v[i];
+	}
+	return a;
+}
+
+Spectrum SpecSub(Spectrum a, Spectrum b)
+{
+	for (int i = 0; i < HERO_COUNT; ++i)
+	{
+		a.v[i] -= b.v[i];
+	}
+	return a;
+}
+
+Spectrum SpecMul(Spectrum a, Spectrum b)
+{
+	for (int i = 0; i < HERO_COUNT; ++i)
+	{
+		a.v[i] *= b.v[i];
+	}
+	return a;
+}
+
+Spectrum SpecDiv(Spectrum a, Spectrum b)
+{
+	for (int i = 0; i < HERO_COUNT; ++i)
+	{
+		a.v[i] /= b.v[i];
+	}
+	return a;
+}
+
+Spectrum SpecSqrt(Spectrum a)
+{
+	for (int i = 0; i < HERO_COUNT; ++i)
+	{
+		a.v[i] = sqrtf(a.v[i]);
+	}
+	return a;
+}
+
+Spectrum SpecMax(Spectrum a, Spectrum b)
+{
+	for (int i = 0; i < HERO_COUNT; ++i)
+	{
+		a.v[i] = fmaxf(a.v[i], b.v[i]);
+	}
+	return a;
+}
+
+Spectrum SpecSelectLess(Spectrum a, Spectrum b, Spectrum x, Spectrum y)
+{
+	for (int i = 0; i < HERO_COUNT; ++i)
+	{
+		x.v[i] = a.v[i] < b.v[i] ? x.v[i] : y.v[i];
+	}
+	return x;
+}
+
+int SpecAnyPositive(Spectrum a)
+{
+	for (int i = 0; i < HERO_COUNT; ++i)
+	{
+		if (a.v[i] > 0.0f)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+Spectrum SpecExp(Spectrum a)
+{
+	for (int i = 0; i < HERO_COUNT; ++i)
+	{
+		a.v[i] = expf(a.v[i]);
+	}
+	return a;
+}
+#endif
+
+void WriteImage(const Color* c, const char* path)
+{
+	byte* p = image;
+	for (int i = 0; i < WIDTH * HEIGHT; ++i)
+	{
+		//׻㵽RGBʱֺܳСĸ
+		p[0] = (int)(fminf(fmaxf(c[i].r, 0.0f) * 255.0f, 255.0f));
+		p[1] = (int)(fminf(fmaxf(c[i].g, 0.0f) * 255.0f, 255.0f));
+		p[2] = (int)(fminf(fmaxf(c[i].b, 0.0f) * 255.0f, 255.0f));
+		p += RGB;
+	}
+
+	FILE* fp = fopen(path, "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / LIGHT_COUNT);
+}
+
+#include "sdf.inc"
+#include "trace.inc"
+
+TraceResult Scene(float x, float y)
+{
+	//һСԴ,м⾵Ѱ׹ֿ,BK7͸,ɫɢСö
+	TraceResult a = { CircleSDF(x, y, 0.12f, 0.42f, 0.03f), 0.0f, 0.0f, { 8.0f, 8.0f, 8.0f }, COLOR_BLACK, GLASS_NONE };
+	TraceResult b = { TriangleSDF(x, y, 0.5f, 0.3f, 0.7f, 0.65f, 0.3f, 0.65f), 0.0f, 1.706f, COLOR_BLACK, COLOR_BLACK, GLASS_FLINT };
+	TraceResult c = { CircleSDF(x, y, 0.78f, 0.82f, 0.1f), 0.0f, 1.5168f, COLOR_BLACK, COLOR_BLACK, GLASS_BK7 };
+	return Union(a, Union(b, c));
+}
+
+//
+//
+////DOC:
+////Ⱦ
+//RGBͨһ,⾵ֻѹ,ֳʺ;
+//Ҫɫɢ,ʱ沨仯(GlassEta):Cauchyʽ n = A + B/^2,߸׼Sellmeierʽ
+//ֱӵÿȡһ׷,ɫ;ͨ׷һĴ
+//(hero wavelength):
+//1.ÿȡһ,HERO_COUNT-1ڿɼⷶΧȼ,4װһSSEĴһ׷
+//2.䷽Ͳ޹,ȡնÿ,4һֱһ
+//3.䷽ʾ;Ĺⲻǡ䵽,
+//  ɫɢĲֻ֮,HERO_COUNTطݶ;ûɫɢĲ4һ
+//4.ÿķȳCIEɫƥ亯õXYZ,ٻRGB,õܰ׹Ľƽ,ɫԴģʽɫһ
+//һ·ĴۺRGBģʽ,ֻɫʱ˼SIMDָ
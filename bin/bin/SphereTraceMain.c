@@ -0,0 +1,498 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//ʽ
+#define MARCH_BASELINE            (0)      //ԭt += sdf,̶EPSILON
+#define MARCH_ENHANCED            (1)      //ɳ + ӦEPSILON + 㶵
+#define MARCH_REFERENCE           (2)      //ͨ,,ֵ
+
+//
+#define MARCH_MISS                (0)      //߳
+#define MARCH_HIT                 (1)
+#define MARCH_EXHAUSTED           (2)      //˻ûн,ԭɺɫ
+
+#define OVER_RELAX                (1.3f)   //ɳϵ,sdfô౶
+#define HIT_EPSILON               (1e-5f)  //ֵ
+#define HIT_CONE                  (5e-4f)  //ֵб,512ֱԼΪÿλ1/4
+#define GRAZE_FACTOR              (4.0f)   //ʱsdfֵô౶ھ͵
+#define REFERENCE_MAX_STEP        (100000)
+#define REFERENCE_EPSILON         (1e-5f)
+
+//Ƶķ,sdfǾȷ,ݶ1+A*K
+#define WAVY_AMPLITUDE            (0.01f)
+#define WAVY_FREQUENCY            (40.0f)
+#define WAVY_LIPSCHITZ            (1.0f + WAVY_AMPLITUDE * WAVY_FREQUENCY)
+
+//ͳ
+#define BENCH_SIZE                (64)     //BENCH_SIZE x BENCH_SIZE
+#define BENCH_DIRECTION           (16)     //ÿķ
+#define BENCH_TOLERANCE           (2.0f / WIDTH) //λúֵ
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+//һߵͳ
+typedef struct
+{
+	int result, steps;
+	float t;
+} MarchStat;
+
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+byte image[WIDTH * HEIGHT * RGB];
+
+int marchMode = MARCH_ENHANCED;
+
+int lipschitzBound = 1;  //0:Ǿȷsdfԭ,ԭ½һ
+
+MarchStat referenceStat[BENCH_SIZE * BENCH_SIZE * BENCH_DIRECTION];
+
+TraceResult Scene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+float WavyCircleSDF(float x, float y, float cx, float cy, float r);
+
+int March(float ox, float oy, float dx, float dy, float sign, int mode, float* t, TraceResult* hit, int* steps);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+void Bench(const char* name, int mode, int bound, MarchStat* stat);
+
+void Render(const char* path);
+
+int main()
+{
+	//ü޲ͨÿߵֵ,ٱȽϸֲʽĲʹ
+	Bench("reference", MARCH_REFERENCE, 1, referenceStat);
+	Bench("baseline, raw sdf", MARCH_BASELINE, 0, NULL);
+	Bench("baseline, bounded", MARCH_BASELINE, 1, NULL);
+	Bench("enhanced, bounded", MARCH_ENHANCED, 1, NULL);
+
+	marchMode = MARCH_BASELINE;
+	lipschitzBound = 0;
+	Render("..//..//png//sphere_trace_baseline.png");
+
+	marchMode = MARCH_ENHANCED;
+	lipschitzBound = 1;
+	Render("..//..//png//sphere_trace.png");
+
+	printf("Svnpng Success\n");
+	return 0;
+}
+
+void Bench(const char* name, int mode, int bound, MarchStat* stat)
+{
+	//ֻͳƴسĵһι,ݹ
+	lipschitzBound = bound;
+	long long steps = 0;
+	int hits = 0, exhausted = 0, wrong = 0, maxSteps = 0;
+	double start = Now();
+
+#pragma omp parallel for schedule(dynamic) reduction(+:steps, hits, exhausted, wrong)
+	for (int y = 0; y < BENCH_SIZE; ++y)
+	{
+		int rowMax = 0;
+		for (int x = 0; x < BENCH_SIZE; ++x)
+		{
+			float ox = (x + 0.5f) / BENCH_SIZE, oy = (y + 0.5f) / BENCH_SIZE;
+			float sign = Scene(ox, oy).sdf > 0.0f ? 1.0f : -1.0f;
+			for (int k = 0; k < BENCH_DIRECTION; ++k)
+			{
+				float radians = TWO_PI * (k + 0.5f) / BENCH_DIRECTION;
+				MarchStat s;
+				TraceResult r;
+				s.result = March(ox, oy, cosf(radians), sinf(radians), sign, mode, &s.t, &r, &s.steps);
+
+				int i = (y * BENCH_SIZE + x) * BENCH_DIRECTION + k;
+				if (stat)
+				{
+					stat[i] = s;
+				}
+				else
+				{
+					//ֵжû(߷),λ̫,
+					const MarchStat* ref = &referenceStat[i];
+					int hit = s.result == MARCH_HIT, refHit = ref->result == MARCH_HIT;
+					wrong += hit != refHit || (hit && fabsf(s.t - ref->t) > BENCH_TOLERANCE);
+				}
+
+				steps += s.steps;
+				hits += s.result == MARCH_HIT;
+				exhausted += s.result == MARCH_EXHAUSTED;
+				rowMax = s.steps > rowMax ? s.steps : rowMax;
+			}
+		}
+#pragma omp critical
+		maxSteps = rowMax > maxSteps ? rowMax : maxSteps;
+	}
+
+	int rays = BENCH_SIZE * BENCH_SIZE * BENCH_DIRECTION;
+	printf("%-18s: %6.2f steps/ray (max %6d), %5d hits, %5d exhausted, %5d wrong, %.1fms\n", name, (double)steps / rays, maxSteps, hits, exhausted, wrong, (Now() - start) * 1000.0);
+}
+
+void Render(const char* path)
+{
+	double start = Now();
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			unsigned int seed = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+			Color c = Sample((float)x / WIDTH, (float)y / HEIGHT, &seed);
+			byte* p = &image[(y * WIDTH + x) * RGB];
+			p[0] = (int)(fminf(c.r * 255.0f, 255.0f));
+			p[1] = (int)(fminf(c.g * 255.0f, 255.0f));
+			p[2] = (int)(fminf(c.b * 255.0f, 255.0f));
+		}
+	}
+	printf("%s: %.2fs\n", path, Now() - start);
+
+	FILE* fp = fopen(path, "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+}
+
+int March(float ox, float oy, float dx, float dy, float sign, int mode, float* t, TraceResult* hit, int* steps)
+{
+	int maxStep = mode == MARCH_REFERENCE ? REFERENCE_MAX_STEP : RAY_MARCHING_MAX_STEP;
+	*t = 1e-3f;
+
+	if (mode != MARCH_ENHANCED)
+	{
+		float epsilon = mode == MARCH_REFERENCE ? REFERENCE_EPSILON : EPSILON;
+		for (*steps = 0; *steps < maxStep && *t < RAY_MARCHING_MAX_DISTANCE; ++*steps)
+		{
+			*hit = Scene(ox + dx * *t, oy + dy * *t);
+			if (hit->sdf * sign < epsilon)
+			{
+				++*steps;
+				return MARCH_HIT;
+			}
+			*t += hit->sdf * sign;
+		}
+		return *steps == maxStep ? MARCH_EXHAUSTED : MARCH_MISS;
+	}
+
+	//ɳ:ŴOVER_RELAX,ǰ޽صʱ˵Խ˱,
+	//˻һ㰴ͨ,֮ٷŴ
+	float omega = OVER_RELAX;
+	float prevT = *t, prevD = 0.0f, step = 0.0f;
+	float bestT = *t, bestError = 1e30f;
+	TraceResult best;
+	memset(&best, 0, sizeof(best));
+
+	for (*steps = 0; *steps < maxStep && *t < RAY_MARCHING_MAX_DISTANCE; ++*steps)
+	{
+		*hit = Scene(ox + dx * *t, oy + dy * *t);
+		float d = hit->sdf * sign;
+
+		if (omega > 1.0f && (d < 0.0f || fabsf(d) + prevD < step))
+		{
+			*t = prevT + prevD;
+			step = prevD;
+			omega = 1.0f;
+			continue;
+		}
+
+		//ֵ,Զı治ؾȷ1e-6
+		float epsilon = fmaxf(HIT_EPSILON, *t * HIT_CONE);
+		if (d < epsilon)
+		{
+			++*steps;
+			return MARCH_HIT;
+		}
+
+		//¼(ֵ)ĵ,ʱ
+		if (d / epsilon < bestError)
+		{
+			bestError = d / epsilon;
+			bestT = *t;
+			best = *hit;
+		}
+
+		prevT = *t;
+		prevD = d;
+		step = d * omega;
+		*t += step;
+	}
+
+	if (*steps == maxStep)
+	{
+		//Ĺű,ԽԽС,ʱѾܽӽ
+		if (bestError < GRAZE_FACTOR)
+		{
+			*t = bestT;
+			*hit = best;
+			return MARCH_HIT;
+		}
+		return MARCH_EXHAUSTED;
+	}
+	return MARCH_MISS;
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / LIGHT_COUNT);
+}
+
+#include "sdf.inc"
+
+float WavyCircleSDF(float x, float y, float cx, float cy, float r)
+{
+	//Բsin*sinĲ,ƵݶA*K,Lipschitz1+A*K
+	return CircleSDF(x, y, cx, cy, r) + WAVY_AMPLITUDE * sinf(WAVY_FREQUENCY * (x - cx)) * sinf(WAVY_FREQUENCY * (y - cy));
+}
+
+Color Trace(float ox, float oy, float dx, float dy, int depth)
+{
+	float t;
+	int steps;
+	TraceResult r;
+	float sign = Scene(ox, oy).sdf > 0.0f ? 1.0f : -1.0f;
+
+	if (March(ox, oy, dx, dy, sign, marchMode, &t, &r, &steps) == MARCH_HIT)
+	{
+		float x = ox + dx * t;
+		float y = oy + dy * t;
+		Color sum = r.emissive;
+		//SDFõǿɷ߿,TraceĵݹҪķΧ
+		if (depth < RAY_MAX_TRACE_STEP && ((r.reflectivity > 0.0f) || (r.eta > 0.0f)))
+		{
+			float reflect = r.reflectivity;
+			float nx, ny, rx, ry;
+			Gradient(x, y, &nx, &ny);//㷨
+			//״ڲǻҪת
+			nx *= sign;
+			ny *= sign;
+			//׷
+			if (r.eta > 0.0f)
+			{
+				float eta = sign < 0.0f ? r.eta : 1.0f / r.eta;
+				//(dx,dy)
+				if (REFRACT == Refract(dx, dy, nx, ny, eta, &rx, &ry))
+				{
+					float cosi = -(dx * nx + dy * ny);
+					float cost = -(rx * nx + ry * ny);
+					reflect = sign < 0.0f ? Fresnel(cosi, cost, r.eta, 1.0f) : Fresnel(cosi, cost, 1.0f, r.eta);
+					Color trace = Trace(x - nx * RAY_BIAS, y - ny * RAY_BIAS, rx, ry, depth + 1);
+					sum = ColorAdd(sum, ColorScale(trace, 1.0f - reflect));
+				}
+				else
+				{
+					//ȫ,
+					reflect = 1.0f;
+				}
+			}
+			//׷ٷ
+			if (reflect > 0.0f)
+			{
+				Reflect(dx, dy, nx, ny, &rx, &ry);
+				Color trace = Trace(x + nx * RAY_BIAS, y + ny * RAY_BIAS, rx, ry, depth + 1);
+				sum = ColorAdd(sum, ColorScale(trace, reflect));
+			}
+		}
+		return ColorMultiply(sum, BeerLambert(r.absorption, t));
+	}
+
+	Color black = COLOR_BLACK;
+	return black;
+}
+
+void Reflect(float ix, float iy, float nx, float ny, float * rx, float * ry)
+{
+	float idotn2 = (ix * nx + iy * ny) * 2.0f;
+	*rx = ix - idotn2 * nx;
+	*ry = iy - idotn2 * ny;
+}
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float * rx, float * ry)
+{
+	//(nx,ny)ǵλ,(rx, ry)ǵλ
+	float idotn = ix * nx + iy * ny;
+	float k = 1.0f - eta * eta * (1.0f - idotn * idotn);
+	if (k < 0.0f)
+	{
+		return TOTAL_REFLECT;//ȫ
+	}
+
+	float a = eta * idotn + sqrtf(k);
+	*rx = eta * ix - a * nx;
+	*ry = eta * iy - a * ny;
+	return REFRACT;//
+}
+
+void Gradient(float x, float y, float * nx, float * ny)
+{
+	//ݶƫ΢,ʹýֵ,xyϷֱ𲽽delta(ȡõEpsilon),Ȼ΢
+	*nx = (Scene(x + EPSILON, y).sdf - Scene(x - EPSILON, y).sdf) * (0.5f / EPSILON);
+	*ny = (Scene(x, y + EPSILON).sdf - Scene(x, y - EPSILON).sdf) * (0.5f / EPSILON);
+}
+
+float Fresnel(float cosi, float cost, float etai, float etat)
+{
+	float rs = (etat * cosi - etai * cost) / (etat * cosi + etai * cost);
+	float rp = (etai * cosi - etat * cost) / (etai * cosi + etat * cost);
+	//ͼѧǿǹƫ,ȡsƫpƫľֵ
+	return (rs * rs + rp * rp) * 0.5f;
+}
+
+Color BeerLambert(Color a, float d)
+{
+	Color c = { expf(-a.r * d), expf(-a.g * d), expf(-a.b * d) };
+	return c;
+}
+
+TraceResult Scene(float x, float y)
+{
+	TraceResult light = { CircleSDF(x, y, 0.5f, -0.2f, 0.1f), 0.0f, 0.0f, { 10.0f, 10.0f, 10.0f }, COLOR_BLACK };
+
+	//εsdfֱߵľ,㸽ƫС,½Ǿȷ
+	TraceResult prism = { NgonSDF(x, y, 0.3f, 0.55f, 0.15f, 5.0f), 0.0f, 1.5f, COLOR_BLACK, { 4.0f, 4.0f, 1.0f } };
+
+	//Բ󽻵õ͹͸,maxҲֻ½
+	TraceResult lensA = { CircleSDF(x, y, 0.62f, 0.5f, 0.2f), 0.0f, 1.5f, COLOR_BLACK, { 1.0f, 4.0f, 4.0f } };
+	TraceResult lensB = { CircleSDF(x, y, 0.88f, 0.5f, 0.2f), 0.0f, 1.5f, COLOR_BLACK, { 1.0f, 4.0f, 4.0f } };
+
+	//ڵһԲľ
+	TraceResult mirror = { BoxSDF(x, y, 0.3f, 0.88f, 0.0f, 0.15f, 0.04f), 0.9f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+	TraceResult hole = { CircleSDF(x, y, 0.3f, 0.84f, 0.06f), 0.0f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+
+	//Lipschitz1sdfԳǰȫĲ
+	TraceResult wavy = { WavyCircleSDF(x, y, 0.75f, 0.85f, 0.08f), 0.0f, 0.0f, { 6.0f, 3.0f, 1.0f }, COLOR_BLACK };
+	if (lipschitzBound)
+	{
+		wavy.sdf /= WAVY_LIPSCHITZ;
+	}
+
+	return Union(Union(light, prism), Union(Union(Intersec(lensA, lensB), Subtract(mirror, hole)), wavy));
+}
+
+//
+//
+////DOC:
+////沽ļ
+//ԭTraceÿt += sdf,RAY_MARCHING_MAX_STEP,EPSILON̶1e-6:
+//1.ӹĹ߲ԽԽС,껹û,ֱӷغɫ,ͼƫ
+//2.ԶıҲҪȷ1e-6,װ׶ߺܶಽ
+//3.sdfǾȷ(ݶȴ1)ʱԽ
+//ĸĽ:
+//1.ɳ(Keinert et al. 2014):OVER_RELAX,ǰ޽صsdfʱ
+//  ˵Խ˱,˻һͨ,֮ٷŴ
+//2.ÿͼԪLipschitzL,sdfLǰȫ,WavyCircleSDF
+//  NgonSDFIntersec/SubtractĽǾ½,L=1,Ͱȫ,ֻǲȷ
+//3.ֵ:max(HIT_EPSILON, t * HIT_CONE)
+//4.ʱ,ȡ(ֵ)ĵ,㹻͵
+//mainü޲ֵͨ,ͳƸַʽƽĹд
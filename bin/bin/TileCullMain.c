@@ -0,0 +1,900 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (2)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//ͼԪ
+#define SHAPE_CIRCLE              (0)
+#define SHAPE_PLANE               (1)
+#define SHAPE_CAPSULE             (2)      //뾶Ϊ0߶
+#define SHAPE_BOX                 (3)
+#define SHAPE_TRIANGLE            (4)      //׼õĲռ
+#define SHAPE_NGON                (5)
+
+//ͼԪǰϷʽ
+#define OP_UNION                  (0)      //ʼһµ״,֮ǰ״
+#define OP_INTERSECT              (1)      //͵ǰ״
+#define OP_SUBTRACT               (2)      //ӵǰ״ȥ
+
+#define MAX_SHAPE                 (128)
+#define CACHE_LINE                (64)
+#define BENCH_POINTS              (1 << 20)
+#define TILE_GRID                 (16)     //[0,1]x[0,1]ֳTILE_GRID*TILE_GRID,ÿһרõtape
+#define CULL_MARGIN               (1e-5f)  //˵㱾,ȵķ֧
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+//:½ڵSDFĲһһӦ
+typedef struct
+{
+	int type, op, material;
+	float p[7];
+} ShapeDesc;
+
+//׼õͼԪ:32ֽ,һ,ֵʱֻ
+//pĺͱ仯,Ǻֵ޹صĲ,PrepareScene
+typedef struct
+{
+	byte type, op, material, count;
+	float p[7];
+} Primitive;
+
+//:һϵȡֵһ[lo, hi]
+typedef struct
+{
+	float lo, hi;
+} Interval;
+
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+byte image[WIDTH * HEIGHT * RGB], reference[WIDTH * HEIGHT * RGB];
+
+ShapeDesc shapes[MAX_SHAPE];
+int shapeCount;
+
+Primitive* primitives;  //ж
+int primitiveCount;
+
+//tapeҪ˳ֵͼԪ±,ֻǵһ
+unsigned short fullTape[MAX_SHAPE];
+int fullTapeLength;
+
+unsigned short tileTapes[TILE_GRID * TILE_GRID * MAX_SHAPE];
+int tileStart[TILE_GRID * TILE_GRID + 1];
+
+//,ֻȡһ
+TraceResult materials[] =
+{
+	{ 0.0f, 0.0f, 0.0f, { 8.0f, 8.0f, 8.0f }, COLOR_BLACK },        //Դ
+	{ 0.0f, 0.0f, 1.5f, COLOR_BLACK, { 4.0f, 4.0f, 1.0f } },        //
+	{ 0.0f, 0.0f, 1.5f, COLOR_BLACK, { 1.0f, 4.0f, 4.0f } },        //첣
+	{ 0.0f, 0.6f, 0.0f, COLOR_BLACK, COLOR_BLACK },                 //
+	{ 0.0f, 0.0f, 0.0f, { 1.0f, 0.6f, 0.3f }, COLOR_BLACK },        //ǽ
+};
+
+TraceResult (*Scene)(float x, float y);
+
+TraceResult ReferenceScene(float x, float y);
+
+TraceResult FullScene(float x, float y);
+
+TraceResult TiledScene(float x, float y);
+
+TraceResult EvalTape(const unsigned short* tape, int length, float x, float y);
+
+float EvalPrimitive(const Primitive* p, float x, float y);
+
+Interval IntervalPrimitive(const Primitive* p, Interval x, Interval y);
+
+void CullTiles();
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+void AddShape(int type, int op, int material, float p0, float p1, float p2, float p3, float p4, float p5, float p6);
+
+void DescribeScene();
+
+void PrepareScene();
+
+void* AlignedAlloc(size_t size, size_t align);
+
+void AlignedFree(void* p);
+
+double BenchScene(const char* name, float* checksum);
+
+double Render(byte* out);
+
+int CountDifference(const byte* a, const byte* b);
+
+int MaxTileTape();
+
+int main()
+{
+	DescribeScene();
+	PrepareScene();
+	CullTiles();
+	printf("%d shapes, full tape %d primitives, tile tapes %.1f primitives on average, %d at most\n",
+		shapeCount, fullTapeLength, (float)tileStart[TILE_GRID * TILE_GRID] / (TILE_GRID * TILE_GRID), MaxTileTape());
+
+	//üķ֧һ,ԽҪtapeȫһ;Χ[0,1],Ļĵtape
+	float maxDiff = 0.0f;
+	int materialDiff = 0;
+	unsigned int seed = 12345u;
+	for (int i = 0; i < BENCH_POINTS; ++i)
+	{
+		float x = Random(&seed) * 1.4f - 0.2f, y = Random(&seed) * 1.4f - 0.2f;
+		TraceResult a = FullScene(x, y), b = TiledScene(x, y);
+		maxDiff = fmaxf(maxDiff, fabsf(a.sdf - b.sdf));
+		materialDiff += memcmp(&a.emissive, &b.emissive, sizeof(Color) * 2) != 0 || a.eta != b.eta || a.reflectivity != b.reflectivity;
+	}
+	printf("max sdf difference %g, %d material mismatches\n", maxDiff, materialDiff);
+
+	float sumA, sumB, sumC;
+	Scene = ReferenceScene;
+	BenchScene("reference", &sumA);
+	Scene = FullScene;
+	double full = BenchScene("full tape", &sumB);
+	Scene = TiledScene;
+	double tiled = BenchScene("tile tape", &sumC);
+	printf("speedup %.2fx\n", full / tiled);
+
+	Scene = FullScene;
+	double fullRender = Render(reference);
+	Scene = TiledScene;
+	double tiledRender = Render(image);
+	printf("render: full tape %.2fs, tile tape %.2fs, %d bytes differ\n", fullRender, tiledRender, CountDifference(reference, image));
+
+	FILE* fp = fopen("..//..//png//tile_cull.png", "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+	AlignedFree(primitives);
+	printf("Svnpng Success\n");
+	return 0;
+}
+
+double Render(byte* out)
+{
+	double start = Now();
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			unsigned int s = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+			Color c = Sample((float)x / WIDTH, (float)y / HEIGHT, &s);
+			byte* p = &out[(y * WIDTH + x) * RGB];
+			p[0] = (int)(fminf(c.r * 255.0f, 255.0f));
+			p[1] = (int)(fminf(c.g * 255.0f, 255.0f));
+			p[2] = (int)(fminf(c.b * 255.0f, 255.0f));
+		}
+	}
+	return Now() - start;
+}
+
+int CountDifference(const byte* a, const byte* b)
+{
+	int count = 0;
+	for (int i = 0; i < WIDTH * HEIGHT * RGB; ++i)
+	{
+		count += a[i] != b[i];
+	}
+	return count;
+}
+
+int MaxTileTape()
+{
+	int m = 0;
+	for (int i = 0; i < TILE_GRID * TILE_GRID; ++i)
+	{
+		m = tileStart[i + 1] - tileStart[i] > m ? tileStart[i + 1] - tileStart[i] : m;
+	}
+	return m;
+}
+
+double BenchScene(const char* name, float* checksum)
+{
+	//ͬһ,ֻȽSceneĿ
+	float sum = 0.0f;
+	unsigned int seed = 777u;
+	double start = Now();
+	for (int i = 0; i < BENCH_POINTS; ++i)
+	{
+		float x = Random(&seed), y = Random(&seed);
+		sum += Scene(x, y).sdf;
+	}
+	double elapsed = Now() - start;
+	*checksum = sum;
+	printf("%-10s: %.1f ns/eval (checksum %g)\n", name, elapsed * 1e9 / BENCH_POINTS, sum);
+	return elapsed;
+}
+
+void AddShape(int type, int op, int material, float p0, float p1, float p2, float p3, float p4, float p5, float p6)
+{
+	ShapeDesc* s = &shapes[shapeCount++];
+	s->type = type;
+	s->op = op;
+	s->material = material;
+	s->p[0] = p0; s->p[1] = p1; s->p[2] = p2; s->p[3] = p3;
+	s->p[4] = p4; s->p[5] = p5; s->p[6] = p6;
+}
+
+void DescribeScene()
+{
+	//˳ͶӦSDFһ
+	AddShape(SHAPE_CIRCLE, OP_UNION, 0, 0.5f, 0.5f, 0.06f, 0, 0, 0, 0);
+	AddShape(SHAPE_PLANE, OP_UNION, 4, 0.0f, 1.1f, 0.0f, -1.0f, 0, 0, 0);
+
+	//һȦתľ,Ԥһһ
+	for (int i = 0; i < 24; ++i)
+	{
+		float a = TWO_PI * i / 24.0f;
+		AddShape(SHAPE_BOX, OP_UNION, 3, 0.5f + 0.38f * cosf(a), 0.5f + 0.38f * sinf(a), a + 0.3f, 0.025f, 0.008f, 0, 0);
+	}
+
+	//С,ó
+	for (int i = 0; i < 8; ++i)
+	{
+		AddShape(SHAPE_CIRCLE, OP_UNION, 1 + (i & 1), 0.3f + 0.05f * i, 0.06f, 0.018f, 0, 0, 0, 0);
+		AddShape(SHAPE_CIRCLE, OP_UNION, 2 - (i & 1), 0.28f + 0.05f * i, 0.9f, 0.018f, 0, 0, 0, 0);
+	}
+
+	AddShape(SHAPE_NGON, OP_UNION, 1, 0.5f, 0.5f, 0.22f, 5.0f, 0, 0, 0);
+	AddShape(SHAPE_CIRCLE, OP_SUBTRACT, 1, 0.5f, 0.5f, 0.16f, 0, 0, 0, 0);  //мڿ,ŹԴ
+
+	AddShape(SHAPE_TRIANGLE, OP_UNION, 2, 0.05f, 0.05f, 0.2f, 0.05f, 0.1f, 0.2f, 0);
+	AddShape(SHAPE_CAPSULE, OP_UNION, 2, 0.8f, 0.05f, 0.95f, 0.2f, 0.03f, 0, 0);
+	AddShape(SHAPE_CAPSULE, OP_UNION, 3, 0.05f, 0.95f, 0.25f, 0.98f, 0.0f, 0, 0);
+
+	//Բ͸
+	AddShape(SHAPE_CIRCLE, OP_UNION, 2, 0.78f, 0.92f, 0.1f, 0, 0, 0, 0);
+	AddShape(SHAPE_CIRCLE, OP_INTERSECT, 2, 0.92f, 0.92f, 0.1f, 0, 0, 0, 0);
+}
+
+void PrepareScene()
+{
+	//ÿͼԪֻһκֵ޹ص:Ǻ
+	primitives = (Primitive*)AlignedAlloc(sizeof(Primitive) * MAX_SHAPE * 2, CACHE_LINE);
+	memset(primitives, 0, sizeof(Primitive) * MAX_SHAPE * 2);
+	primitiveCount = 0;
+
+	for (int i = 0; i < shapeCount; ++i)
+	{
+		const ShapeDesc* s = &shapes[i];
+		Primitive* p = &primitives[primitiveCount++];
+		p->type = (byte)s->type;
+		p->op = (byte)s->op;
+		p->material = (byte)s->material;
+
+		if (s->type == SHAPE_CIRCLE)
+		{
+			//cx, cy, r
+			memcpy(p->p, s->p, sizeof(float) * 3);
+		}
+		else if (s->type == SHAPE_PLANE)
+		{
+			//px, py, nx, ny
+			memcpy(p->p, s->p, sizeof(float) * 4);
+		}
+		else if (s->type == SHAPE_CAPSULE)
+		{
+			//ax, ay, ux, uy, 1/|u|^2, radius
+			float ux = s->p[2] - s->p[0], uy = s->p[3] - s->p[1];
+			p->p[0] = s->p[0];
+			p->p[1] = s->p[1];
+			p->p[2] = ux;
+			p->p[3] = uy;
+			p->p[4] = 1.0f / (ux * ux + uy * uy);
+			p->p[5] = s->p[4];
+		}
+		else if (s->type == SHAPE_BOX)
+		{
+			//ox, oy, cos, sin, sx, sy
+			p->p[0] = s->p[0];
+			p->p[1] = s->p[1];
+			p->p[2] = cosf(s->p[2]);
+			p->p[3] = sinf(s->p[2]);
+			p->p[4] = s->p[3];
+			p->p[5] = s->p[4];
+		}
+		else if (s->type == SHAPE_TRIANGLE)
+		{
+			//һ:a, b-a, c-b;ڶ:a-c, ߳ƽĵ
+			Primitive* q = &primitives[primitiveCount++];
+			float e[6] = { s->p[2] - s->p[0], s->p[3] - s->p[1], s->p[4] - s->p[2], s->p[5] - s->p[3], s->p[0] - s->p[4], s->p[1] - s->p[5] };
+			p->p[0] = s->p[0];
+			p->p[1] = s->p[1];
+			memcpy(&p->p[2], e, sizeof(float) * 4);
+			q->p[0] = e[4];
+			q->p[1] = e[5];
+			for (int k = 0; k < 3; ++k)
+			{
+				q->p[2 + k] = 1.0f / (e[k * 2] * e[k * 2] + e[k * 2 + 1] * e[k * 2 + 1]);
+			}
+		}
+		else if (s->type == SHAPE_NGON)
+		{
+			//cx, cy, r*cos(a/2), 0ߵķ, תһߵcossin
+			//ε㵽ߵľ,ڵ㵽бֱߵֵ,
+			//תֵ,Ҫatan2/fmod/cos/sin
+			float a = TWO_PI / s->p[3];
+			p->count = (byte)s->p[3];
+			p->p[0] = s->p[0];
+			p->p[1] = s->p[1];
+			p->p[2] = s->p[2] * cosf(a * 0.5f);
+			p->p[3] = cosf(a * 0.5f);
+			p->p[4] = sinf(a * 0.5f);
+			p->p[5] = cosf(a);
+			p->p[6] = sinf(a);
+		}
+	}
+}
+
+TraceResult FullScene(float x, float y)
+{
+	return EvalTape(fullTape, fullTapeLength, x, y);
+}
+
+TraceResult TiledScene(float x, float y)
+{
+	//ĻĵûжӦĿ,tape
+	if (x < 0.0f || x >= 1.0f || y < 0.0f || y >= 1.0f)
+	{
+		return FullScene(x, y);
+	}
+	int tile = (int)(y * TILE_GRID) * TILE_GRID + (int)(x * TILE_GRID);
+	return EvalTape(&tileTapes[tileStart[tile]], tileStart[tile + 1] - tileStart[tile], x, y);
+}
+
+TraceResult EvalTape(const unsigned short* tape, int length, float x, float y)
+{
+	float best = 1e30f, current = 1e30f;
+	int bestMaterial = 0, currentMaterial = 0;
+
+	for (int i = 0; i < length; ++i)
+	{
+		const Primitive* p = &primitives[tape[i]];
+		float d = EvalPrimitive(p, x, y);
+
+		if (p->op == OP_UNION)
+		{
+			if (current < best)
+			{
+				best = current;
+				bestMaterial = currentMaterial;
+			}
+			current = d;
+			currentMaterial = p->material;
+		}
+		else if (p->op == OP_INTERSECT)
+		{
+			current = fmaxf(current, d);
+		}
+		else
+		{
+			current = fmaxf(current, -d);
+		}
+	}
+
+	if (current < best)
+	{
+		best = current;
+		bestMaterial = currentMaterial;
+	}
+
+	TraceResult r = materials[bestMaterial];
+	r.sdf = best;
+	return r;
+}
+
+float EvalPrimitive(const Primitive* p, float x, float y)
+{
+	//εĵڶ۽ں
+	const float* q = p->p;
+	float d;
+
+	switch (p->type)
+	{
+	case SHAPE_CIRCLE:
+	{
+		float dx = x - q[0], dy = y - q[1];
+		d = sqrtf(dx * dx + dy * dy) - q[2];
+		break;
+	}
+	case SHAPE_PLANE:
+		d = (x - q[0]) * q[2] + (y - q[1]) * q[3];
+		break;
+	case SHAPE_CAPSULE:
+	{
+		float vx = x - q[0], vy = y - q[1];
+		float t = fmaxf(fminf((vx * q[2] + vy * q[3]) * q[4], 1.0f), 0.0f);
+		float dx = vx - q[2] * t, dy = vy - q[3] * t;
+		d = sqrtf(dx * dx + dy * dy) - q[5];
+		break;
+	}
+	case SHAPE_BOX:
+	{
+		float lx = x - q[0], ly = y - q[1];
+		float dx = fabsf(lx * q[2] + ly * q[3]) - q[4];
+		float dy = fabsf(ly * q[2] - lx * q[3]) - q[5];
+		float ax = fmaxf(dx, 0.0f), ay = fmaxf(dy, 0.0f);
+		d = fminf(fmaxf(dx, dy), 0.0f) + sqrtf(ax * ax + ay * ay);
+		break;
+	}
+	case SHAPE_TRIANGLE:
+	{
+		//a->b, b->c, c->a,ǰһϱõ
+		const float* r = p[1].p;
+		float ex[3] = { q[2], q[4], r[0] }, ey[3] = { q[3], q[5], r[1] };
+		float sx = q[0], sy = q[1];
+		float d2 = 1e30f;
+		int inside = 1;
+		for (int k = 0; k < 3; ++k)
+		{
+			float vx = x - sx, vy = y - sy;
+			float t = fmaxf(fminf((vx * ex[k] + vy * ey[k]) * r[2 + k], 1.0f), 0.0f);
+			float dx = vx - ex[k] * t, dy = vy - ey[k] * t;
+			d2 = fminf(d2, dx * dx + dy * dy);
+			inside &= ex[k] * vy > ey[k] * vx;
+			sx += ex[k];
+			sy += ey[k];
+		}
+		d = inside ? -sqrtf(d2) : sqrtf(d2);
+		break;
+	}
+	case SHAPE_NGON:
+	{
+		float ux = x - q[0], uy = y - q[1];
+		float nx = q[3], ny = q[4], m = -1e30f;
+		for (int k = 0; k < p->count; ++k)
+		{
+			m = fmaxf(m, ux * nx + uy * ny);
+			float t = nx * q[5] - ny * q[6];
+			ny = nx * q[6] + ny * q[5];
+			nx = t;
+		}
+		d = m - q[2];
+		break;
+	}
+	default:
+		d = 1e30f;
+		break;
+	}
+	return d;
+}
+
+Interval MakeInterval(float lo, float hi)
+{
+	Interval r = { lo, hi };
+	return r;
+}
+
+Interval IAdd(Interval a, Interval b)
+{
+	return MakeInterval(a.lo + b.lo, a.hi + b.hi);
+}
+
+Interval ISub(Interval a, Interval b)
+{
+	return MakeInterval(a.lo - b.hi, a.hi - b.lo);
+}
+
+Interval IOffset(Interval a, float k)
+{
+	return MakeInterval(a.lo + k, a.hi + k);
+}
+
+Interval IScale(Interval a, float k)
+{
+	return k >= 0.0f ? MakeInterval(a.lo * k, a.hi * k) : MakeInterval(a.hi * k, a.lo * k);
+}
+
+Interval ISquare(Interval a)
+{
+	//0ʱСֵ0,ֱƽ
+	if (a.lo >= 0.0f)
+	{
+		return MakeInterval(a.lo * a.lo, a.hi * a.hi);
+	}
+	if (a.hi <= 0.0f)
+	{
+		return MakeInterval(a.hi * a.hi, a.lo * a.lo);
+	}
+	return MakeInterval(0.0f, fmaxf(a.lo * a.lo, a.hi * a.hi));
+}
+
+Interval ISqrt(Interval a)
+{
+	return MakeInterval(sqrtf(fmaxf(a.lo, 0.0f)), sqrtf(fmaxf(a.hi, 0.0f)));
+}
+
+Interval IAbs(Interval a)
+{
+	if (a.lo >= 0.0f)
+	{
+		return a;
+	}
+	if (a.hi <= 0.0f)
+	{
+		return MakeInterval(-a.hi, -a.lo);
+	}
+	return MakeInterval(0.0f, fmaxf(-a.lo, a.hi));
+}
+
+Interval INeg(Interval a)
+{
+	return MakeInterval(-a.hi, -a.lo);
+}
+
+Interval IMin(Interval a, Interval b)
+{
+	return MakeInterval(fminf(a.lo, b.lo), fminf(a.hi, b.hi));
+}
+
+Interval IMax(Interval a, Interval b)
+{
+	return MakeInterval(fmaxf(a.lo, b.lo), fmaxf(a.hi, b.hi));
+}
+
+Interval IClamp(Interval a, float lo, float hi)
+{
+	return MakeInterval(fminf(fmaxf(a.lo, lo), hi), fminf(fmaxf(a.hi, lo), hi));
+}
+
+Interval IntervalPrimitive(const Primitive* p, Interval x, Interval y)
+{
+	//EvalPrimitiveһ,ÿһ
+	const float* q = p->p;
+	Interval d;
+
+	switch (p->type)
+	{
+	case SHAPE_CIRCLE:
+		d = IOffset(ISqrt(IAdd(ISquare(IOffset(x, -q[0])), ISquare(IOffset(y, -q[1])))), -q[2]);
+		break;
+	case SHAPE_PLANE:
+		d = IAdd(IScale(IOffset(x, -q[0]), q[2]), IScale(IOffset(y, -q[1]), q[3]));
+		break;
+	case SHAPE_CAPSULE:
+	{
+		Interval vx = IOffset(x, -q[0]), vy = IOffset(y, -q[1]);
+		Interval t = IClamp(IScale(IAdd(IScale(vx, q[2]), IScale(vy, q[3])), q[4]), 0.0f, 1.0f);
+		Interval dx = ISub(vx, IScale(t, q[2])), dy = ISub(vy, IScale(t, q[3]));
+		d = IOffset(ISqrt(IAdd(ISquare(dx), ISquare(dy))), -q[5]);
+		break;
+	}
+	case SHAPE_BOX:
+	{
+		Interval lx = IOffset(x, -q[0]), ly = IOffset(y, -q[1]);
+		Interval dx = IOffset(IAbs(IAdd(IScale(lx, q[2]), IScale(ly, q[3]))), -q[4]);
+		Interval dy = IOffset(IAbs(ISub(IScale(ly, q[2]), IScale(lx, q[3]))), -q[5]);
+		Interval zero = MakeInterval(0.0f, 0.0f);
+		Interval ax = IMax(dx, zero), ay = IMax(dy, zero);
+		d = IAdd(IMin(IMax(dx, dy), zero), ISqrt(IAdd(ISquare(ax), ISquare(ay))));
+		break;
+	}
+	case SHAPE_TRIANGLE:
+	{
+		const float* r = p[1].p;
+		float ex[3] = { q[2], q[4], r[0] }, ey[3] = { q[3], q[5], r[1] };
+		float sx = q[0], sy = q[1];
+		Interval d2 = MakeInterval(1e30f, 1e30f);
+		int inside = 1, outside = 0;
+		for (int k = 0; k < 3; ++k)
+		{
+			Interval vx = IOffset(x, -sx), vy = IOffset(y, -sy);
+			Interval t = IClamp(IScale(IAdd(IScale(vx, ex[k]), IScale(vy, ey[k])), r[2 + k]), 0.0f, 1.0f);
+			Interval dx = ISub(vx, IScale(t, ex[k])), dy = ISub(vy, IScale(t, ey[k]));
+			d2 = IMin(d2, IAdd(ISquare(dx), ISquare(dy)));
+			//鶼ߵ߲һ,鶼߾һ
+			Interval cross = ISub(IScale(vy, ex[k]), IScale(vx, ey[k]));
+			inside &= cross.lo > 0.0f;
+			outside |= cross.hi <= 0.0f;
+			sx += ex[k];
+			sy += ey[k];
+		}
+		Interval dist = ISqrt(d2);
+		d = inside ? INeg(dist) : outside ? dist : MakeInterval(-dist.hi, dist.hi);
+		break;
+	}
+	case SHAPE_NGON:
+	{
+		Interval ux = IOffset(x, -q[0]), uy = IOffset(y, -q[1]);
+		float nx = q[3], ny = q[4];
+		Interval m = MakeInterval(-1e30f, -1e30f);
+		for (int k = 0; k < p->count; ++k)
+		{
+			m = IMax(m, IAdd(IScale(ux, nx), IScale(uy, ny)));
+			float t = nx * q[5] - ny * q[6];
+			ny = nx * q[6] + ny * q[5];
+			nx = t;
+		}
+		d = IOffset(m, -q[2]);
+		break;
+	}
+	default:
+		d = MakeInterval(1e30f, 1e30f);
+		break;
+	}
+
+	//ЩSDFݶȳȶ1,ĵֵӼԽҲһ;
+	//תBoxŴܶ,ȡ
+	float cx = (x.lo + x.hi) * 0.5f, cy = (y.lo + y.hi) * 0.5f;
+	float radius = sqrtf((x.hi - x.lo) * (x.hi - x.lo) + (y.hi - y.lo) * (y.hi - y.lo)) * 0.5f;
+	float center = EvalPrimitive(p, cx, cy);
+	d.lo = fmaxf(d.lo, center - radius);
+	d.hi = fminf(d.hi, center + radius);
+	return d;
+}
+
+void CullTiles()
+{
+	//tape:ͼԪ˳,ֻǵһ
+	fullTapeLength = 0;
+	for (int i = 0; i < primitiveCount; ++i)
+	{
+		fullTape[fullTapeLength++] = (unsigned short)i;
+		i += primitives[i].type == SHAPE_TRIANGLE;
+	}
+
+	Interval d[MAX_SHAPE], before[MAX_SHAPE], shape[MAX_SHAPE];
+	int group[MAX_SHAPE];
+	int count = 0;
+	for (int ty = 0; ty < TILE_GRID; ++ty)
+	{
+		for (int tx = 0; tx < TILE_GRID; ++tx)
+		{
+			Interval x = MakeInterval((float)tx / TILE_GRID, (float)(tx + 1) / TILE_GRID);
+			Interval y = MakeInterval((float)ty / TILE_GRID, (float)(ty + 1) / TILE_GRID);
+
+			//һ:ÿͼԪ,Լÿ״꽻֮
+			int g = -1;
+			for (int i = 0; i < fullTapeLength; ++i)
+			{
+				const Primitive* p = &primitives[fullTape[i]];
+				d[i] = IntervalPrimitive(p, x, y);
+				if (p->op == OP_UNION)
+				{
+					shape[++g] = d[i];
+				}
+				else
+				{
+					before[i] = shape[g];
+					shape[g] = IMax(shape[g], p->op == OP_INTERSECT ? d[i] : INeg(d[i]));
+				}
+				group[i] = g;
+			}
+			float minHi = 1e30f;
+			for (int k = 0; k <= g; ++k)
+			{
+				minHi = fminf(minHi, shape[k].hi);
+			}
+
+			//ڶ:ֻ¿õͼԪ
+			//һ״½һ״Ͻ绹,ﲻ;
+			//һһֱȵǰ״С,ȡmaxʱԶᱻѡ
+			int tile = ty * TILE_GRID + tx;
+			tileStart[tile] = count;
+			for (int i = 0; i < fullTapeLength; ++i)
+			{
+				const Primitive* p = &primitives[fullTape[i]];
+				if (shape[group[i]].lo > minHi + CULL_MARGIN)
+				{
+					continue;
+				}
+				if (p->op == OP_INTERSECT && d[i].hi + CULL_MARGIN < before[i].lo)
+				{
+					continue;
+				}
+				if (p->op == OP_SUBTRACT && -d[i].lo + CULL_MARGIN < before[i].lo)
+				{
+					continue;
+				}
+				tileTapes[count++] = fullTape[i];
+			}
+		}
+	}
+	tileStart[TILE_GRID * TILE_GRID] = count;
+}
+
+TraceResult ReferenceScene(float x, float y)
+{
+	//ԭSDF,½дSceneȼ
+	TraceResult result = { 1e30f, 0.0f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+	TraceResult current = result;
+
+	for (int i = 0; i < shapeCount; ++i)
+	{
+		const ShapeDesc* s = &shapes[i];
+		const float* p = s->p;
+		TraceResult r = materials[s->material];
+
+		if (s->type == SHAPE_CIRCLE)
+		{
+			r.sdf = CircleSDF(x, y, p[0], p[1], p[2]);
+		}
+		else if (s->type == SHAPE_PLANE)
+		{
+			r.sdf = PlaneSDF(x, y, p[0], p[1], p[2], p[3]);
+		}
+		else if (s->type == SHAPE_CAPSULE)
+		{
+			r.sdf = CapsuleSDF(x, y, p[0], p[1], p[2], p[3], p[4]);
+		}
+		else if (s->type == SHAPE_BOX)
+		{
+			r.sdf = BoxSDF(x, y, p[0], p[1], p[2], p[3], p[4]);
+		}
+		else if (s->type == SHAPE_TRIANGLE)
+		{
+			r.sdf = TriangleSDF(x, y, p[0], p[1], p[2], p[3], p[4], p[5]);
+		}
+		else
+		{
+			r.sdf = NgonSDF(x, y, p[0], p[1], p[2], p[3]);
+		}
+
+		if (s->op == OP_UNION)
+		{
+			result = i > 0 ? Union(result, current) : result;
+			current = r;
+		}
+		else
+		{
+			current = s->op == OP_INTERSECT ? Intersec(current, r) : Subtract(current, r);
+		}
+	}
+	return Union(result, current);
+}
+
+void* AlignedAlloc(size_t size, size_t align)
+{
+	//һ,ԭʼָڶַǰ
+	void* raw = malloc(size + align + sizeof(void*));
+	if (!raw)
+	{
+		return NULL;
+	}
+	size_t addr = ((size_t)raw + sizeof(void*) + align - 1) & ~(align - 1);
+	((void**)addr)[-1] = raw;
+	return (void*)addr;
+}
+
+void AlignedFree(void* p)
+{
+	if (p)
+	{
+		free(((void**)p)[-1]);
+	}
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / LIGHT_COUNT);
+}
+
+#include "sdf.inc"
+#include "trace.inc"
+//
+//
+////DOC:
+////ü
+//Ԥ֮,ÿֵҪͼԪһ,Ļϴ󲿷ֵطֻһ״
+//libfive˼·,Ⱦǰÿһ,Ϊÿһ̵tape:
+//1.tapeǰ˳ֵͼԪ±,tapeԤһµͼԪ
+//2.[0,1]x[0,1]ֳTILE_GRID*TILE_GRID,IntervalPrimitiveÿͼԪϵȡֵΧ,
+//  ٺ"ĵֵԽ"ȡ,ЩSDFݶȳȶ1,ǳ
+//3.һ״½һ״Ͻ绹ʱ,ﲻ,ȥ;
+//  һһֱȵǰ״Сʱ,ȡmaxԶѡ,ȥ
+//4.TiledSceneڵĿȡtapeֵ,Ļĵtape;GradientȡڵԲԼĿ
+//õķ֧ڿһᱻѡ,Խtapeλͬ,mainһ,ٱȽֵȾĺʱ
@@ -0,0 +1,523 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define USE_SSE2
+#endif
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (256)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (5)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//ֿۻ
+#define TILE_SHIFT                (3)
+#define TILE_SIZE                 (1 << TILE_SHIFT)              //8x8һ
+#define TILE_PIXELS               (TILE_SIZE * TILE_SIZE)
+#define TILE_X                    (WIDTH / TILE_SIZE)
+#define TILE_Y                    (HEIGHT / TILE_SIZE)
+#define CACHE_LINE                (64)
+#define PASS_COUNT                (4)                            //ۻı,ÿLIGHT_COUNT/PASS_COUNT
+#ifndef HALF_STORAGE
+#define HALF_STORAGE              (0)                            //1:ۻfp16洢,ڴ,ʺϳֱ
+#endif
+#define UNTILE_REPEAT             (20)                           //׶κʱظ
+#ifndef TONEMAP
+#define TONEMAP                   (1)                            //1:ǰReinhardɫӳc/(1+c);0:ֱӽض,½һ
+#endif
+
+typedef unsigned char byte;
+typedef unsigned short half;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+#if HALF_STORAGE
+typedef half Channel;
+#else
+typedef float Channel;
+#endif
+
+//һtileֿͨ(SoA),ذMorton˳
+//floatʱ768ֽ,fp16ʱ384ֽ,ǻе,tile֮䲻Ṳ
+typedef struct
+{
+	Channel r[TILE_PIXELS], g[TILE_PIXELS], b[TILE_PIXELS];
+} Tile;
+
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+byte image[WIDTH * HEIGHT * RGB];
+
+byte reference[WIDTH * HEIGHT * RGB];
+
+Tile* tiles;  //TILE_X * TILE_Ytile,Morton˳
+
+TraceResult Scene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, int count, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+unsigned int MortonEncode(unsigned int x, unsigned int y);
+
+void MortonDecode(unsigned int m, unsigned int* x, unsigned int* y);
+
+half FloatToHalf(float f);
+
+float HalfToFloat(half h);
+
+void* AlignedAlloc(size_t size, size_t align);
+
+void AlignedFree(void* p);
+
+void RenderTile(Tile* tile, int tx, int ty, int pass);
+
+void LoadTile(const Tile* tile, float* r, float* g, float* b);
+
+byte ToneMap(float v);
+
+void UntileScalar(byte* out);
+
+void UntileSIMD(byte* out);
+
+int main()
+{
+	//tile鰴Morton˳,Ҫtile2
+	if (TILE_X != TILE_Y || (TILE_X & (TILE_X - 1)) != 0)
+	{
+		printf("WIDTH/HEIGHT must be equal powers of two times TILE_SIZE\n");
+		return 1;
+	}
+
+	size_t bytes = sizeof(Tile) * TILE_X * TILE_Y;
+	tiles = (Tile*)AlignedAlloc(bytes, CACHE_LINE);
+	memset(tiles, 0, bytes);
+	printf("accumulation buffer: %s, %d bytes per tile, %.2f MB\n", HALF_STORAGE ? "fp16" : "fp32", (int)sizeof(Tile), bytes / (1024.0 * 1024.0));
+
+	double start = Now();
+	for (int pass = 0; pass < PASS_COUNT; ++pass)
+	{
+		//һ߳һδһtile,дڴһж,֮߳ûα
+#pragma omp parallel for schedule(dynamic)
+		for (int i = 0; i < TILE_X * TILE_Y; ++i)
+		{
+			unsigned int tx, ty;
+			MortonDecode((unsigned int)i, &tx, &ty);
+			RenderTile(&tiles[i], (int)tx, (int)ty, pass);
+		}
+	}
+	printf("render: %.2fs\n", Now() - start);
+
+	//׶:⿪tileMorton˳,ɫӳ,ȵ8λRGB;ʵֶtile,ʱֻȽ
+	start = Now();
+	for (int i = 0; i < UNTILE_REPEAT; ++i)
+	{
+		UntileScalar(reference);
+	}
+	double scalar = (Now() - start) / UNTILE_REPEAT;
+
+	start = Now();
+	for (int i = 0; i < UNTILE_REPEAT; ++i)
+	{
+		UntileSIMD(image);
+	}
+	double simd = (Now() - start) / UNTILE_REPEAT;
+
+	int mismatch = 0;
+	for (int i = 0; i < WIDTH * HEIGHT * RGB; ++i)
+	{
+		mismatch += image[i] != reference[i];
+	}
+	printf("untile+tonemap+quantize: scalar %.3fms, simd %.3fms, %d bytes differ\n", scalar * 1000.0, simd * 1000.0, mismatch);
+
+	FILE* fp = fopen("..//..//png//tiled_buffer.png", "wb");
+	svpng(fp, WIDTH, HEIGHT, image, 0);
+	fclose(fp);
+	AlignedFree(tiles);
+	printf("Svnpng Success\n");
+	return mismatch != 0;
+}
+
+void RenderTile(Tile* tile, int tx, int ty, int pass)
+{
+	//tileǾֵ,ÿ鰴,fp16ҲΪ̫󶪾
+	float weight = 1.0f / (pass + 1);
+	for (int i = 0; i < TILE_PIXELS; ++i)
+	{
+		unsigned int px, py;
+		MortonDecode((unsigned int)i, &px, &py);
+		int x = tx * TILE_SIZE + (int)px, y = ty * TILE_SIZE + (int)py;
+
+		unsigned int seed = (unsigned int)(y * WIDTH + x) * 9781u + (unsigned int)pass * 6271u + 1u;
+		Color c = Sample((float)x / WIDTH, (float)y / HEIGHT, LIGHT_COUNT / PASS_COUNT, &seed);
+#if HALF_STORAGE
+		float r = HalfToFloat(tile->r[i]), g = HalfToFloat(tile->g[i]), b = HalfToFloat(tile->b[i]);
+		tile->r[i] = FloatToHalf(r + (c.r - r) * weight);
+		tile->g[i] = FloatToHalf(g + (c.g - g) * weight);
+		tile->b[i] = FloatToHalf(b + (c.b - b) * weight);
+#else
+		tile->r[i] += (c.r - tile->r[i]) * weight;
+		tile->g[i] += (c.g - tile->g[i]) * weight;
+		tile->b[i] += (c.b - tile->b[i]) * weight;
+#endif
+	}
+}
+
+void LoadTile(const Tile* tile, float* r, float* g, float* b)
+{
+	//һtilefloat,fp32ʱֱӿ
+#if HALF_STORAGE
+#if defined(__F16C__)
+	for (int i = 0; i < TILE_PIXELS; i += 4)
+	{
+		_mm_storeu_ps(r + i, _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)(tile->r + i))));
+		_mm_storeu_ps(g + i, _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)(tile->g + i))));
+		_mm_storeu_ps(b + i, _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)(tile->b + i))));
+	}
+#else
+	for (int i = 0; i < TILE_PIXELS; ++i)
+	{
+		r[i] = HalfToFloat(tile->r[i]);
+		g[i] = HalfToFloat(tile->g[i]);
+		b[i] = HalfToFloat(tile->b[i]);
+	}
+#endif
+#else
+	memcpy(r, tile->r, sizeof(tile->r));
+	memcpy(g, tile->g, sizeof(tile->g));
+	memcpy(b, tile->b, sizeof(tile->b));
+#endif
+}
+
+byte ToneMap(float v)
+{
+	v = fmaxf(v, 0.0f);
+#if TONEMAP
+	v = v / (1.0f + v);
+#endif
+	return (byte)(int)fminf(v * 255.0f, 255.0f);
+}
+
+void UntileScalar(byte* out)
+{
+	//صĲοʵ
+#pragma omp parallel for
+	for (int t = 0; t < TILE_X * TILE_Y; ++t)
+	{
+		float r[TILE_PIXELS], g[TILE_PIXELS], b[TILE_PIXELS];
+		unsigned int tx, ty;
+		MortonDecode((unsigned int)t, &tx, &ty);
+		LoadTile(&tiles[t], r, g, b);
+		for (int i = 0; i < TILE_PIXELS; ++i)
+		{
+			unsigned int px, py;
+			MortonDecode((unsigned int)i, &px, &py);
+			byte* p = &out[((ty * TILE_SIZE + py) * WIDTH + tx * TILE_SIZE + px) * RGB];
+			p[0] = ToneMap(r[i]);
+			p[1] = ToneMap(g[i]);
+			p[2] = ToneMap(b[i]);
+		}
+	}
+}
+
+void UntileSIMD(byte* out)
+{
+#ifdef USE_SSE2
+	//Morton˳4һ2x2ķ,һδ4صͨ
+	//ضϸֵ,Reinhard,255,ضϵ[0,255],ת16ֽ:r0..r3 g0..g3 b0..b3,ٷд
+	//_mm_div_psͱһIEEEȷ,UntileScalarֽͬ
+	const __m128 scale = _mm_set1_ps(255.0f), zero = _mm_setzero_ps();
+#if TONEMAP
+	const __m128 one = _mm_set1_ps(1.0f);
+#endif
+#pragma omp parallel for
+	for (int t = 0; t < TILE_X * TILE_Y; ++t)
+	{
+		float r[TILE_PIXELS], g[TILE_PIXELS], b[TILE_PIXELS];
+		unsigned int tx, ty;
+		MortonDecode((unsigned int)t, &tx, &ty);
+		LoadTile(&tiles[t], r, g, b);
+		for (int i = 0; i < TILE_PIXELS; i += 4)
+		{
+			const float* src[RGB] = { r + i, g + i, b + i };
+			__m128i iv[RGB];
+			for (int c = 0; c < RGB; ++c)
+			{
+				__m128 v = _mm_max_ps(_mm_loadu_ps(src[c]), zero);
+#if TONEMAP
+				v = _mm_div_ps(v, _mm_add_ps(one, v));
+#endif
+				iv[c] = _mm_cvttps_epi32(_mm_min_ps(_mm_mul_ps(v, scale), scale));
+			}
+			__m128i packed = _mm_packus_epi16(_mm_packs_epi32(iv[0], iv[1]), _mm_packs_epi32(iv[2], _mm_setzero_si128()));
+
+			byte q[16];
+			_mm_storeu_si128((__m128i*)q, packed);
+
+			unsigned int px, py;
+			MortonDecode((unsigned int)i, &px, &py);
+			byte* p = &out[((ty * TILE_SIZE + py) * WIDTH + tx * TILE_SIZE + px) * RGB];
+			byte* p2 = p + WIDTH * RGB;
+			p[0] = q[0];  p[1] = q[4];  p[2] = q[8];
+			p[3] = q[1];  p[4] = q[5];  p[5] = q[9];
+			p2[0] = q[2]; p2[1] = q[6]; p2[2] = q[10];
+			p2[3] = q[3]; p2[4] = q[7]; p2[5] = q[11];
+		}
+	}
+#else
+	UntileScalar(out);
+#endif
+}
+
+unsigned int MortonEncode(unsigned int x, unsigned int y)
+{
+	//xżλ,yλ,֧16λ
+	x = (x | (x << 8)) & 0x00FF00FFu;
+	x = (x | (x << 4)) & 0x0F0F0F0Fu;
+	x = (x | (x << 2)) & 0x33333333u;
+	x = (x | (x << 1)) & 0x55555555u;
+	y = (y | (y << 8)) & 0x00FF00FFu;
+	y = (y | (y << 4)) & 0x0F0F0F0Fu;
+	y = (y | (y << 2)) & 0x33333333u;
+	y = (y | (y << 1)) & 0x55555555u;
+	return x | (y << 1);
+}
+
+void MortonDecode(unsigned int m, unsigned int* x, unsigned int* y)
+{
+	unsigned int a = m & 0x55555555u, b = (m >> 1) & 0x55555555u;
+	a = (a | (a >> 1)) & 0x33333333u;
+	a = (a | (a >> 2)) & 0x0F0F0F0Fu;
+	a = (a | (a >> 4)) & 0x00FF00FFu;
+	a = (a | (a >> 8)) & 0x0000FFFFu;
+	b = (b | (b >> 1)) & 0x33333333u;
+	b = (b | (b >> 2)) & 0x0F0F0F0Fu;
+	b = (b | (b >> 4)) & 0x00FF00FFu;
+	b = (b | (b >> 8)) & 0x0000FFFFu;
+	*x = a;
+	*y = b;
+}
+
+half FloatToHalf(float f)
+{
+	//IEEE754 binary16,ͽ,Χ,̫Сɷǹ0
+	unsigned int u;
+	memcpy(&u, &f, sizeof(u));
+	unsigned int sign = (u >> 16) & 0x8000u;
+	int e = (int)((u >> 23) & 0xFFu) - 127 + 15;
+	unsigned int m = u & 0x007FFFFFu;
+
+	if (((u >> 23) & 0xFFu) == 0xFFu)
+	{
+		return (half)(sign | 0x7C00u | (m ? 0x200u : 0u));  //NaN
+	}
+	if (e >= 31)
+	{
+		return (half)(sign | 0x7C00u);
+	}
+	if (e <= 0)
+	{
+		if (e < -10)
+		{
+			return (half)sign;
+		}
+		m |= 0x00800000u;
+		int shift = 14 - e;
+		unsigned int h = m >> shift;
+		unsigned int rest = m & ((1u << shift) - 1u), halfway = 1u << (shift - 1);
+		h += rest > halfway || (rest == halfway && (h & 1u));
+		return (half)(sign | h);
+	}
+
+	unsigned int h = ((unsigned int)e << 10) | (m >> 13);
+	unsigned int rest = m & 0x1FFFu;
+	h += rest > 0x1000u || (rest == 0x1000u && (h & 1u));  //λָܽ,õõȷ
+	return (half)(sign | h);
+}
+
+float HalfToFloat(half h)
+{
+	unsigned int sign = (unsigned int)(h & 0x8000u) << 16;
+	unsigned int e = (h >> 10) & 0x1Fu;
+	unsigned int m = h & 0x3FFu;
+	unsigned int u;
+
+	if (e == 0)
+	{
+		//ǹֱӰ
+		float f = m * (1.0f / 16777216.0f);
+		return sign ? -f : f;
+	}
+	if (e == 31)
+	{
+		u = sign | 0x7F800000u | (m << 13);
+	}
+	else
+	{
+		u = sign | ((e - 15 + 127) << 23) | (m << 13);
+	}
+
+	float f;
+	memcpy(&f, &u, sizeof(f));
+	return f;
+}
+
+void* AlignedAlloc(size_t size, size_t align)
+{
+	//һ,ԭʼָڶַǰ
+	void* raw = malloc(size + align + sizeof(void*));
+	if (!raw)
+	{
+		return NULL;
+	}
+	size_t addr = ((size_t)raw + sizeof(void*) + align - 1) & ~(align - 1);
+	((void**)addr)[-1] = raw;
+	return (void*)addr;
+}
+
+void AlignedFree(void* p)
+{
+	if (p)
+	{
+		free(((void**)p)[-1]);
+	}
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, int count, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < count; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / count;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / count);
+}
+
+#include "sdf.inc"
+#include "trace.inc"
+
+TraceResult Scene(float x, float y)
+{
+	TraceResult a = { CircleSDF(x, y, 0.5f, -0.2f, 0.1f), 0.0f, 0.0f,{ 10.0f, 10.0f, 10.0f }, COLOR_BLACK };
+	//babsorptionrgb(4,4,1),ʾrg,ʾɫɫ
+	TraceResult b = { NgonSDF(x, y, 0.5f, 0.5f, 0.25f, 5.0f), 0.0f, 1.5f, COLOR_BLACK,  { 4.0f, 4.0f, 1.0f } };
+
+
+	return Union(a, b);
+}
+
+//
+//
+////DOC:
+////ֿۻ
+//½ڵimageȡRGBֽ,̰߳tileȾʱ:
+//1.߳дͬһ,һб(α)
+//2.һtileطɢںܶ,ʵľֲԺܲ
+//ۻ:
+//1.8x8Ϊһtile,ֿͨ,tileСǻе,鰴ж
+//2.tile֮䡢tileڲضMorton(Z),άڵڴҲ
+//3.HALF_STORAGEΪ1ʱfp16洢,ڴ,ǾֵۼӺ,Ծȹ
+//4.׶һδһ2x2,SSE2Reinhardɫӳ(TONEMAP)ضϡת,дȵ8λRGB
+//  SSE2ʱ˻صʵ,mainȽʵֵĽǷһ
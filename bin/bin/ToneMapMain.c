@@ -0,0 +1,475 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define USE_SSE2
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (256)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (5)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//ɫӳ
+#define TONEMAP_CLIP              (0)  //½һֱӽض
+#define TONEMAP_REINHARD          (1)
+#define TONEMAP_ACES              (2)
+#define TONEMAP_COUNT             (3)
+
+#define RADIANCE_CACHE            "..//..//png//tonemap_radiance.pfm"  //Ⱦĸ㻺,ɫʱ׷
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+//
+typedef struct
+{
+	float exposure;  //ع,λǵ(EV),ʵʳ2^exposure
+	int curve;
+	int dither;
+} ToneMapParam;
+
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+byte image[WIDTH * HEIGHT * RGB];
+
+byte reference[WIDTH * HEIGHT * RGB];
+
+float radiance[RGB][WIDTH * HEIGHT];  //ֿͨĸȾ,SIMDһδ4
+
+const char* curveNames[TONEMAP_COUNT] = { "clip", "reinhard", "aces" };
+
+//8x8 Bayer,򶶶
+const byte bayer[8][8] =
+{
+	{  0, 32,  8, 40,  2, 34, 10, 42 },
+	{ 48, 16, 56, 24, 50, 18, 58, 26 },
+	{ 12, 44,  4, 36, 14, 46,  6, 38 },
+	{ 60, 28, 52, 20, 62, 30, 54, 22 },
+	{  3, 35, 11, 43,  1, 33,  9, 41 },
+	{ 51, 19, 59, 27, 49, 17, 57, 25 },
+	{ 15, 47,  7, 39, 13, 45,  5, 37 },
+	{ 63, 31, 55, 23, 61, 29, 53, 21 },
+};
+
+TraceResult Scene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+void Render();
+
+int SaveRadiance(const char* path);
+
+int LoadRadiance(const char* path);
+
+float ToneCurve(float x, int curve);
+
+float LinearToSRGB(float x);
+
+float Dither(int x, int y);
+
+void ToneMapScalar(ToneMapParam param, byte* out);
+
+void ToneMapSIMD(ToneMapParam param, byte* out);
+
+int main(int argc, char* argv[])
+{
+	//ToneMapMain [عEV] [clip|reinhard|aces] [-nodither] [-rerender]
+	//ָʱ߸һ,Աȵɫĺʱ
+	ToneMapParam param = { 0.0f, -1, 1 };
+	int rerender = 0;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-nodither") == 0)
+		{
+			param.dither = 0;
+		}
+		else if (strcmp(argv[i], "-rerender") == 0)
+		{
+			rerender = 1;
+		}
+		else if (argv[i][0] == '-' || (argv[i][0] >= '0' && argv[i][0] <= '9'))
+		{
+			param.exposure = (float)atof(argv[i]);
+		}
+		else
+		{
+			for (int c = 0; c < TONEMAP_COUNT; ++c)
+			{
+				if (strcmp(argv[i], curveNames[c]) == 0)
+				{
+					param.curve = c;
+				}
+			}
+		}
+	}
+
+	//ȾPFM,ֻعʱֱӶ
+	if (rerender || !LoadRadiance(RADIANCE_CACHE))
+	{
+		double start = Now();
+		Render();
+		printf("render: %.2fs\n", Now() - start);
+		if (!SaveRadiance(RADIANCE_CACHE))
+		{
+			printf("can not write %s\n", RADIANCE_CACHE);
+		}
+	}
+	else
+	{
+		printf("loaded %s\n", RADIANCE_CACHE);
+	}
+
+	for (int c = 0; c < TONEMAP_COUNT; ++c)
+	{
+		if (param.curve >= 0 && param.curve != c)
+		{
+			continue;
+		}
+
+		ToneMapParam p = param;
+		p.curve = c;
+
+		double start = Now();
+		ToneMapScalar(p, reference);
+		double scalar = Now() - start;
+
+		start = Now();
+		ToneMapSIMD(p, image);
+		double simd = Now() - start;
+
+		//SIMD汾sRGBǽƵ,1Ĳ
+		int differ = 0, maxDiff = 0;
+		for (int i = 0; i < WIDTH * HEIGHT * RGB; ++i)
+		{
+			int d = abs((int)image[i] - (int)reference[i]);
+			differ += d != 0;
+			maxDiff = d > maxDiff ? d : maxDiff;
+		}
+		printf("%-8s exposure %+.1f: scalar %.2fms, simd %.2fms, %d bytes differ (max %d)\n", curveNames[c], p.exposure, scalar * 1000.0, simd * 1000.0, differ, maxDiff);
+
+		char path[64];
+		sprintf(path, "..//..//png//tonemap_%s.png", curveNames[c]);
+		FILE* fp = fopen(path, "wb");
+		svpng(fp, WIDTH, HEIGHT, image, 0);
+		fclose(fp);
+	}
+	printf("Svnpng Success\n");
+	return 0;
+}
+
+void Render()
+{
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			unsigned int seed = (unsigned int)(y * WIDTH + x) * 9781u + 1u;
+			Color c = Sample((float)x / WIDTH, (float)y / HEIGHT, &seed);
+			radiance[0][y * WIDTH + x] = c.r;
+			radiance[1][y * WIDTH + x] = c.g;
+			radiance[2][y * WIDTH + x] = c.b;
+		}
+	}
+}
+
+int SaveRadiance(const char* path)
+{
+	//PFM:ıͷС˵float RGB,дϴ
+	FILE* fp = fopen(path, "wb");
+	if (!fp)
+	{
+		return 0;
+	}
+	fprintf(fp, "PF\n%d %d\n-1.0\n", WIDTH, HEIGHT);
+	for (int y = HEIGHT - 1; y >= 0; --y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			float p[RGB] = { radiance[0][y * WIDTH + x], radiance[1][y * WIDTH + x], radiance[2][y * WIDTH + x] };
+			fwrite(p, sizeof(float), RGB, fp);
+		}
+	}
+	fclose(fp);
+	return 1;
+}
+
+int LoadRadiance(const char* path)
+{
+	FILE* fp = fopen(path, "rb");
+	if (!fp)
+	{
+		return 0;
+	}
+
+	int w = 0, h = 0;
+	float scale = 0.0f;
+	if (fscanf(fp, "PF %d %d %f", &w, &h, &scale) != 3 || w != WIDTH || h != HEIGHT || scale >= 0.0f || fgetc(fp) != '\n')
+	{
+		fclose(fp);
+		return 0;
+	}
+
+	int ok = 1;
+	for (int y = HEIGHT - 1; y >= 0 && ok; --y)
+	{
+		for (int x = 0; x < WIDTH && ok; ++x)
+		{
+			float p[RGB];
+			ok = fread(p, sizeof(float), RGB, fp) == RGB;
+			radiance[0][y * WIDTH + x] = p[0];
+			radiance[1][y * WIDTH + x] = p[1];
+			radiance[2][y * WIDTH + x] = p[2];
+		}
+	}
+	fclose(fp);
+	return ok;
+}
+
+float ToneCurve(float x, int curve)
+{
+	if (curve == TONEMAP_REINHARD)
+	{
+		return x / (1.0f + x);
+	}
+	if (curve == TONEMAP_ACES)
+	{
+		//NarkowiczACES RRT+ODT
+		return fminf(x * (2.51f * x + 0.03f) / (x * (2.43f * x + 0.59f) + 0.14f), 1.0f);
+	}
+	return fminf(x, 1.0f);
+}
+
+float LinearToSRGB(float x)
+{
+	return x <= 0.0031308f ? x * 12.92f : 1.055f * powf(x, 1.0f / 2.4f) - 0.055f;
+}
+
+float Dither(int x, int y)
+{
+	//ǰ[-0.5,0.5)򶶶,ƽİ䲻ɫ
+	return (bayer[y & 7][x & 7] + 0.5f) / 64.0f - 0.5f;
+}
+
+void ToneMapScalar(ToneMapParam param, byte* out)
+{
+	//صĲοʵ
+	float exposure = powf(2.0f, param.exposure);
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		for (int x = 0; x < WIDTH; ++x)
+		{
+			float d = param.dither ? Dither(x, y) : 0.0f;
+			byte* p = &out[(y * WIDTH + x) * RGB];
+			for (int c = 0; c < RGB; ++c)
+			{
+				float v = ToneCurve(fmaxf(radiance[c][y * WIDTH + x], 0.0f) * exposure, param.curve);
+				v = LinearToSRGB(v) * 255.0f + 0.5f + d;
+				p[c] = (byte)fminf(fmaxf(v, 0.0f), 255.0f);
+			}
+		}
+	}
+}
+
+void ToneMapSIMD(ToneMapParam param, byte* out)
+{
+#ifdef USE_SSE2
+	//ÿδͬһе4,ͨһ__m128
+	//sRGBοĶʽx^(1/2.4),powf
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+	const __m128 exposure = _mm_set1_ps(powf(2.0f, param.exposure));
+	const __m128 half = _mm_set1_ps(0.5f), scale = _mm_set1_ps(255.0f);
+
+#pragma omp parallel for
+	for (int y = 0; y < HEIGHT; ++y)
+	{
+		__m128 dither[2];
+		for (int k = 0; k < 2; ++k)
+		{
+			dither[k] = param.dither ? _mm_setr_ps(Dither(k * 4, y), Dither(k * 4 + 1, y), Dither(k * 4 + 2, y), Dither(k * 4 + 3, y)) : zero;
+		}
+
+		for (int x = 0; x < WIDTH; x += 4)
+		{
+			__m128i q[RGB];
+			for (int c = 0; c < RGB; ++c)
+			{
+				__m128 v = _mm_mul_ps(_mm_max_ps(_mm_loadu_ps(&radiance[c][y * WIDTH + x]), zero), exposure);
+				if (param.curve == TONEMAP_REINHARD)
+				{
+					v = _mm_div_ps(v, _mm_add_ps(one, v));
+				}
+				else if (param.curve == TONEMAP_ACES)
+				{
+					__m128 n = _mm_mul_ps(v, _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(2.51f)), _mm_set1_ps(0.03f)));
+					__m128 d = _mm_add_ps(_mm_mul_ps(v, _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(2.43f)), _mm_set1_ps(0.59f))), _mm_set1_ps(0.14f));
+					v = _mm_div_ps(n, d);
+				}
+				v = _mm_min_ps(v, one);
+
+				__m128 s1 = _mm_sqrt_ps(v), s2 = _mm_sqrt_ps(s1), s3 = _mm_sqrt_ps(s2);
+				__m128 curve = _mm_add_ps(_mm_add_ps(_mm_mul_ps(s1, _mm_set1_ps(0.662002687f)), _mm_mul_ps(s2, _mm_set1_ps(0.684122060f))),
+					_mm_sub_ps(_mm_mul_ps(s3, _mm_set1_ps(-0.323583601f)), _mm_mul_ps(v, _mm_set1_ps(0.0225411470f))));
+				__m128 linear = _mm_mul_ps(v, _mm_set1_ps(12.92f));
+				__m128 mask = _mm_cmple_ps(v, _mm_set1_ps(0.0031308f));
+				v = _mm_or_ps(_mm_and_ps(mask, linear), _mm_andnot_ps(mask, curve));
+
+				v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v, scale), half), dither[(x >> 2) & 1]);
+				q[c] = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(v, zero), scale));
+			}
+
+			byte b[16];
+			_mm_storeu_si128((__m128i*)b, _mm_packus_epi16(_mm_packs_epi32(q[0], q[1]), _mm_packs_epi32(q[2], _mm_setzero_si128())));
+			byte* p = &out[(y * WIDTH + x) * RGB];
+			for (int i = 0; i < 4; ++i)
+			{
+				p[i * RGB + 0] = b[i];
+				p[i * RGB + 1] = b[4 + i];
+				p[i * RGB + 2] = b[8 + i];
+			}
+		}
+	}
+#else
+	ToneMapScalar(param, out);
+#endif
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / LIGHT_COUNT);
+}
+
+#include "sdf.inc"
+#include "trace.inc"
+
+TraceResult Scene(float x, float y)
+{
+	TraceResult a = { CircleSDF(x, y, 0.5f, -0.2f, 0.1f), 0.0f, 0.0f,{ 10.0f, 10.0f, 10.0f }, COLOR_BLACK };
+	//babsorptionrgb(4,4,1),ʾrg,ʾɫɫ
+	TraceResult b = { NgonSDF(x, y, 0.5f, 0.5f, 0.25f, 5.0f), 0.0f, 1.5f, COLOR_BLACK,  { 4.0f, 4.0f, 1.0f } };
+
+
+	return Union(a, b);
+}
+
+//
+//
+////DOC:
+////ɫӳ
+//½ֱӰѷȳ255ض,10.0͸ĸ߹ȫ255,Ĳζ,
+//뻻ع͵׷һ
+//Ⱦʾֿ:
+//1.ȾԸPFM(tonemap_radiance.pfm),ֻ֮ĲʱֱӶ,׷
+//2.ع:2^EV
+//3.:clipԭĽض,reinhardx/(1+x),acesNarkowicz,߹ɸȻ
+//4.sRGB:ʾҪgammaֵ,ֱֵʾƫ
+//5.:ǰ8x8 Bayer򶶶,ƽ䴦ɫ
+//SIMD汾һδ4,sRGBsqrtʽ,صpowf汾1
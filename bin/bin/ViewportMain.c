@@ -0,0 +1,433 @@
+#include "svpng.inc"
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define EPSILON                   (1e-6f)
+#define WIDTH                     (512)
+#define HEIGHT                    (512)
+#define RGB	                      (3)
+#define TWO_PI                    (6.28318530718f)
+#define LIGHT_COUNT               (64)
+
+
+#define RAY_MARCHING_MAX_STEP     (64)
+#define RAY_MARCHING_MAX_DISTANCE (5.0f)
+#define RAY_MAX_TRACE_STEP    (3)
+#define RAY_BIAS (1e-4f)
+
+#define REFRACT (1)  //
+#define TOTAL_REFLECT (0) //ȫ
+
+#define COLOR_BLACK {0.0f, 0.0f, 0.0f}
+
+//ӿ
+#define RAY_START                 (1e-3f)  //ߴǰôԶſʼҽ,һͣڵı
+#define MIN_EPSILON               (2.5e-7f) //[0,1]floatԼֱܷľ,ֵ
+#define ZOOM                      (50.0f)  //ĬʾķŴ
+#define ZOOM_X                    (0.74f)  //ĬϷŴλ:⾵ұߵĽ
+#define ZOOM_Y                    (0.62f)
+
+typedef unsigned char byte;
+typedef struct { float r, g, b; } Color;
+typedef struct
+{
+	float sdf, reflectivity, eta;
+	Color emissive, absorption;
+}  TraceResult;
+
+//ͼwidth * height,Ķ׼(cx, cy),ȶӦscaleô,ʱתrotation;
+//ֻȾ[cropX, cropX + cropWidth) * [cropY, cropY + cropHeight),Ĭӿھԭ(x / WIDTH, y / HEIGHT)
+typedef struct
+{
+	float cx, cy, scale, rotation;
+	int width, height;
+	int cropX, cropY, cropWidth, cropHeight;
+} Viewport;
+
+Color ColorAdd(Color lhs, Color rhs)
+{
+	Color c = { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b };
+	return c;
+}
+
+Color ColorMultiply(Color lhs, Color rhs)
+{
+	Color c = { lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b };
+	return c;
+}
+
+Color ColorScale(Color c, float scale)
+{
+	c.r *= scale;
+	c.g *= scale;
+	c.b *= scale;
+
+	return c;
+}
+
+//Traceõĳ,ӿڵشС,ԭĳӦĬӿ
+float marchEpsilon = EPSILON, marchStart = RAY_START, marchBias = RAY_BIAS;
+
+TraceResult Scene(float x, float y);
+
+TraceResult Union(TraceResult lhs, TraceResult rhs);
+
+TraceResult Intersec(TraceResult lhs, TraceResult rhs);
+
+TraceResult Subtract(TraceResult lhs, TraceResult rhs);
+
+Color Sample(float x, float y, unsigned int* seed);
+
+float Random(unsigned int* seed);
+
+double Now();
+
+float CircleSDF(float x, float y, float cx, float cy, float radius);
+
+float PlaneSDF(float x, float y, float px, float py, float nx, float ny);
+
+float SegmentSDF(float x, float y, float ax, float ay, float bx, float by);
+
+float CapsuleSDF(float x, float y, float ax, float ay, float bx, float by, float radius);
+
+float BoxSDF(float x, float y, float ox, float oy, float theta, float sx, float sy);
+
+float TriangleSDF(float x, float y, float ax, float ay, float bx, float by, float cx, float cy);
+
+float NgonSDF(float x, float y, float cx, float cy, float r, float n);
+
+Color Trace(float ox, float oy, float dx, float dy, int depth);
+
+void Reflect(float ix, float iy, float nx, float ny, float* rx, float* ry);
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float *rx, float *ry);
+
+void Gradient(float x, float y, float* nx, float* ny);
+
+float Fresnel(float cosi, float cost, float etai, float etat);//䷽,㷴
+
+Color BeerLambert(Color a, float d);
+
+Viewport DefaultViewport(int width, int height);
+
+void ViewportToScene(const Viewport* v, int px, int py, float* x, float* y);
+
+void SetMarchScale(const Viewport* v);
+
+void RenderViewport(const Viewport* v, Color* out);
+
+double WriteViewport(const Viewport* v, const char* path);
+
+int main(int argc, char* argv[])
+{
+	//ViewportMain [-view cx cy scale ת] [-size  ] [-crop x y  ]
+	//ʱȾĳ,(ZOOM_X, ZOOM_Y)ŴZOOMȾͬСһ,Ƚʱ
+	if (argc == 1)
+	{
+		Viewport full = DefaultViewport(WIDTH, HEIGHT);
+		double fullTime = WriteViewport(&full, "..//..//png//viewport.png");
+
+		Viewport zoom = full;
+		zoom.cx = ZOOM_X;
+		zoom.cy = ZOOM_Y;
+		zoom.scale = 1.0f / ZOOM;
+		double zoomTime = WriteViewport(&zoom, "..//..//png//viewport_zoom.png");
+		printf("full %dx%d: %.2fs, %gx zoom %dx%d: %.2fs\n", WIDTH, HEIGHT, fullTime, ZOOM, WIDTH, HEIGHT, zoomTime);
+		return 0;
+	}
+
+	Viewport v = DefaultViewport(WIDTH, HEIGHT);
+	int crop = 0;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-view") == 0 && i + 4 < argc)
+		{
+			v.cx = (float)atof(argv[++i]);
+			v.cy = (float)atof(argv[++i]);
+			v.scale = (float)atof(argv[++i]);
+			v.rotation = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-size") == 0 && i + 2 < argc)
+		{
+			v.width = atoi(argv[++i]);
+			v.height = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-crop") == 0 && i + 4 < argc)
+		{
+			v.cropX = atoi(argv[++i]);
+			v.cropY = atoi(argv[++i]);
+			v.cropWidth = atoi(argv[++i]);
+			v.cropHeight = atoi(argv[++i]);
+			crop = 1;
+		}
+	}
+	if (!crop)
+	{
+		v.cropX = v.cropY = 0;
+		v.cropWidth = v.width;
+		v.cropHeight = v.height;
+	}
+
+	//üͼ
+	v.cropX = v.cropX < 0 ? 0 : v.cropX;
+	v.cropY = v.cropY < 0 ? 0 : v.cropY;
+	v.cropWidth = v.cropX + v.cropWidth > v.width ? v.width - v.cropX : v.cropWidth;
+	v.cropHeight = v.cropY + v.cropHeight > v.height ? v.height - v.cropY : v.cropHeight;
+	if (v.width <= 0 || v.height <= 0 || v.scale <= 0.0f || v.cropWidth <= 0 || v.cropHeight <= 0)
+	{
+		printf("bad viewport\n");
+		return 1;
+	}
+
+	double time = WriteViewport(&v, "..//..//png//viewport.png");
+	printf("%dx%d of %dx%d, pixel %g: %.2fs\n", v.cropWidth, v.cropHeight, v.width, v.height, v.scale / v.width, time);
+	return 0;
+}
+
+Viewport DefaultViewport(int width, int height)
+{
+	//ȷǳ[0, 1],,߶ȷ򰴱
+	Viewport v;
+	v.cx = 0.5f;
+	v.cy = 0.5f * height / width;
+	v.scale = 1.0f;
+	v.rotation = 0.0f;
+	v.width = width;
+	v.height = height;
+	v.cropX = v.cropY = 0;
+	v.cropWidth = width;
+	v.cropHeight = height;
+	return v;
+}
+
+void ViewportToScene(const Viewport* v, int px, int py, float* x, float* y)
+{
+	float pixel = v->scale / v->width;
+	float u = (px - v->width * 0.5f) * pixel, w = (py - v->height * 0.5f) * pixel;
+	float c = cosf(v->rotation), s = sinf(v->rotation);
+	*x = v->cx + u * c - w * s;
+	*y = v->cy + u * s + w * c;
+}
+
+void SetMarchScale(const Viewport* v)
+{
+	//ԭĳǰһ1/512;ŴԺرС,𲽾ƫС,Ŵ50ʱ𲽵1e-325,
+	//ϸֱӱȥ;ֵҲС,ܵfloat[0,1]ķֱ,򲽽ͣ
+	//󲽽벻,ӿĹԴҲҪս
+	float s = v->scale / v->width * WIDTH;
+	marchEpsilon = fmaxf(EPSILON * s, MIN_EPSILON);
+	marchStart = fmaxf(RAY_START * s, marchEpsilon * 8.0f);
+	marchBias = fmaxf(RAY_BIAS * s, marchEpsilon * 8.0f);
+}
+
+void RenderViewport(const Viewport* v, Color* out)
+{
+	//Ӱͼر,üĲֺȾĶӦȫһ
+	SetMarchScale(v);
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < v->cropHeight; ++y)
+	{
+		for (int x = 0; x < v->cropWidth; ++x)
+		{
+			int px = v->cropX + x, py = v->cropY + y;
+			unsigned int s = (unsigned int)(py * v->width + px) * 9781u + 1u;
+			float sx, sy;
+			ViewportToScene(v, px, py, &sx, &sy);
+			out[y * v->cropWidth + x] = Sample(sx, sy, &s);
+		}
+	}
+}
+
+double WriteViewport(const Viewport* v, const char* path)
+{
+	//ֻвüô,ͼķֱ޹
+	size_t count = (size_t)v->cropWidth * v->cropHeight;
+	Color* colors = (Color*)malloc(count * sizeof(Color));
+	byte* image = (byte*)malloc(count * RGB);
+
+	double start = Now();
+	RenderViewport(v, colors);
+	double time = Now() - start;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		byte* p = &image[i * RGB];
+		p[0] = (int)(fminf(colors[i].r * 255.0f, 255.0f));
+		p[1] = (int)(fminf(colors[i].g * 255.0f, 255.0f));
+		p[2] = (int)(fminf(colors[i].b * 255.0f, 255.0f));
+	}
+	FILE* fp = fopen(path, "wb");
+	svpng(fp, v->cropWidth, v->cropHeight, image, 0);
+	fclose(fp);
+
+	free(colors);
+	free(image);
+	return time;
+}
+
+TraceResult Scene(float x, float y)
+{
+	TraceResult light = { CircleSDF(x, y, 0.2f, 0.2f, 0.08f), 0.0f, 0.0f, { 6.0f, 5.0f, 4.0f }, COLOR_BLACK };
+	TraceResult prism = { NgonSDF(x, y, 0.62f, 0.62f, 0.12f, 3.0f), 0.0f, 1.5f, COLOR_BLACK, { 1.0f, 3.0f, 4.0f } };
+	TraceResult pillar = { CapsuleSDF(x, y, 0.12f, 0.6f, 0.3f, 0.72f, 0.02f), 0.0f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+	TraceResult mirror = { BoxSDF(x, y, 0.85f, 0.3f, 0.5f, 0.1f, 0.01f), 0.9f, 0.0f, COLOR_BLACK, COLOR_BLACK };
+	return Union(Union(light, prism), Union(pillar, mirror));
+}
+
+float Random(unsigned int* seed)
+{
+	//xorshift,ÿظԵ,߳²rand()ȫ״̬
+	unsigned int s = *seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	*seed = s;
+	return (s >> 8) * (1.0f / 16777216.0f);
+}
+
+double Now()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+Color Sample(float x, float y, unsigned int* seed)
+{
+	Color sum = COLOR_BLACK;
+	for (int i = 0; i < LIGHT_COUNT; ++i)
+	{
+		float radians = TWO_PI * (i + Random(seed)) / LIGHT_COUNT;   // 
+		sum = ColorAdd(sum, Trace(x, y, cosf(radians), sinf(radians), 0));
+	}
+	return ColorScale(sum, 1.0f / LIGHT_COUNT);
+}
+
+#include "sdf.inc"
+
+Color Trace(float ox, float oy, float dx, float dy, int depth)
+{
+	float t = marchStart;
+	float sign = Scene(ox, oy).sdf > 0.0f ? 1.0f : -1.0f;
+
+	for (int i = 0; i < RAY_MARCHING_MAX_STEP && t < RAY_MARCHING_MAX_DISTANCE; ++i)
+	{
+		float x = ox + dx * t;
+		float y = oy + dy * t;
+		TraceResult r = Scene(x, y);
+		if (r.sdf * sign  < marchEpsilon) //Ϊǹⲿп,ڹ߲ʱҪǷ
+		{
+			Color sum = r.emissive;
+			//SDFõǿɷ߿,TraceĵݹҪķΧ
+			if (depth < RAY_MAX_TRACE_STEP && ((r.reflectivity > 0.0f) || (r.eta > 0.0f)))
+			{
+				float reflect = r.reflectivity;
+				float nx, ny, rx, ry;
+				Gradient(x, y, &nx, &ny);//㷨
+				//״ڲǻҪת
+				nx *= sign;
+				ny *= sign;
+				//׷
+				if (r.eta > 0.0f)
+				{
+					float eta = sign < 0.0f ? r.eta : 1.0f / r.eta;
+					//(dx,dy)
+					if (REFRACT == Refract(dx, dy, nx, ny, eta, &rx, &ry))
+					{
+						float cosi = -(dx * nx + dy * ny);
+						float cost = -(rx * nx + ry * ny);
+						reflect = sign < 0.0f ? Fresnel(cosi, cost, r.eta, 1.0f) : Fresnel(cosi, cost, 1.0f, r.eta);
+						Color trace = Trace(x - nx * marchBias, y - ny * marchBias, rx, ry, depth + 1);
+						sum = ColorAdd(sum, ColorScale(trace, 1.0f - reflect));
+					}
+					else
+					{
+						//ȫ,
+						reflect = 1.0f;
+					}
+				}
+				//׷ٷ
+				if (reflect > 0.0f)
+				{
+					Reflect(dx, dy, nx, ny, &rx, &ry);
+					Color trace = Trace(x + nx * marchBias, y + ny * marchBias, rx, ry, depth + 1);
+					sum = ColorAdd(sum, ColorScale(trace, reflect));
+				}
+			}
+			return ColorMultiply(sum, BeerLambert(r.absorption, t));
+		}
+
+		//߲ǹ״ڻ״
+		t += r.sdf * sign;
+	}
+
+	Color black = COLOR_BLACK;
+	return black;
+}
+
+void Reflect(float ix, float iy, float nx, float ny, float * rx, float * ry)
+{
+	float idotn2 = (ix * nx + iy * ny) * 2.0f;
+	*rx = ix - idotn2 * nx;
+	*ry = iy - idotn2 * ny;
+}
+
+int Refract(float ix, float iy, float nx, float ny, float eta, float * rx, float * ry)
+{
+	//(nx,ny)ǵλ,(rx, ry)ǵλ
+	float idotn = ix * nx + iy * ny;
+	float k = 1.0f - eta * eta * (1.0f - idotn * idotn);
+	if (k < 0.0f)
+	{
+		return TOTAL_REFLECT;//ȫ
+	}
+
+	float a = eta * idotn + sqrtf(k);
+	*rx = eta * ix - a * nx;
+	*ry = eta * iy - a * ny;
+	return REFRACT;//
+}
+
+void Gradient(float x, float y, float * nx, float * ny)
+{
+	//ݶƫ΢,ʹýֵ,xyϷֱ𲽽delta(ȡõEpsilon),Ȼ΢
+	*nx = (Scene(x + EPSILON, y).sdf - Scene(x - EPSILON, y).sdf) * (0.5f / EPSILON);
+	*ny = (Scene(x, y + EPSILON).sdf - Scene(x, y - EPSILON).sdf) * (0.5f / EPSILON);
+}
+
+float Fresnel(float cosi, float cost, float etai, float etat)
+{
+	float rs = (etat * cosi - etai * cost) / (etat * cosi + etai * cost);
+	float rp = (etai * cosi - etat * cost) / (etai * cosi + etat * cost);
+	//ͼѧǿǹƫ,ȡsƫpƫľֵ
+	return (rs * rs + rp * rp) * 0.5f;
+}
+
+Color BeerLambert(Color a, float d)
+{
+	Color c = { expf(-a.r * d), expf(-a.g * d), expf(-a.b * d) };
+	return c;
+}
+
+//
+//
+////DOC:
+////ӿ:ֻȾҪ
+//ԭصӳд(x / WIDTH, y / HEIGHT),뿴ɢǵϸֻܰͼȾúܴ
+//1.Viewportͼ:(cx, cy)ȶӦĳscaleתrotationֱwidth * height,
+//  ټһü,RenderViewportֻȾ;Ĭӿںԭӳȫһ
+//2.Ӱͼر,-size 25600 25600 -crop ...óĺȾĶӦȫһ
+//3.ŴԺһֻscale / widthô,Trace𲽾롢ƫͬıС,
+//  Ŵ50ʱ1e-3𲽾25,ϸڱֱ;ֵҲС,MIN_EPSILON
+//4.󲽽Ͳ,ӿĹԴս;ֻ￴й,
+//  Ŵ50512x512512x512Ŀ,Ⱦ25600x25600ٲü
+//  (ĬϷŴǲ⾵Ľ,ÿضҪ,ͼƽÿعһЩ)
+//ViewportMain -view 0.74 0.62 0.02 0.5 -size 1024 512 : ⾵ĽϷŴ50,ת0.5,1024x512